@@ -0,0 +1,83 @@
+#include "alias_analysis.h"
+#include "map_runtime.h"
+
+using namespace std;
+
+// Memory a function allocates itself, which no parameter or global can point to: local arrays and mapped files.
+static bool isAllocation(const Instruction *base)
+{
+    return base->op == Opcode::ARRAY || (base->op == Opcode::CALL && isMapBuiltin(base->text));
+}
+
+static bool isIdentifiedObject(const Instruction *base)
+{
+    return isAllocation(base) || base->op == Opcode::GLOBAL;
+}
+
+static shared_ptr<Type> elementType(const Instruction *base)
+{
+    return static_pointer_cast<ArrayType>(base->type)->elementType;
+}
+
+AliasResult aliasArrays(const Instruction *base, const Instruction *otherBase)
+{
+    if (base == otherBase)
+        return AliasResult::MUST_ALIAS;
+    if (!elementType(base)->equals(elementType(otherBase).get()))
+        return AliasResult::NO_ALIAS;
+    if (isIdentifiedObject(base) && isIdentifiedObject(otherBase))
+        return AliasResult::NO_ALIAS;
+    if ((isAllocation(base) && otherBase->op == Opcode::PARAM) ||
+        (base->op == Opcode::PARAM && isAllocation(otherBase)))
+        return AliasResult::NO_ALIAS;
+    return AliasResult::MAY_ALIAS;
+}
+
+AliasResult aliasAccesses(const Instruction *access, const Instruction *other)
+{
+    AliasResult result = aliasArrays(access->operands[0], other->operands[0]);
+    if (result != AliasResult::MUST_ALIAS)
+        return result;
+
+    const Instruction *index = access->operands[1];
+    const Instruction *otherIndex = other->operands[1];
+    if (index == otherIndex)
+        return AliasResult::MUST_ALIAS;
+    if (index->isConstant() && otherIndex->isConstant())
+        return index->intValue == otherIndex->intValue ? AliasResult::MUST_ALIAS : AliasResult::NO_ALIAS;
+    return AliasResult::MAY_ALIAS;
+}
+
+bool mayClobber(const Instruction *writer, const Instruction *access, const PurityAnalysis &purity)
+{
+    switch (writer->op)
+    {
+    case Opcode::STORE:
+        if (access->op == Opcode::LOAD_GLOBAL)
+            return false;
+        return aliasAccesses(access, writer) != AliasResult::NO_ALIAS;
+    case Opcode::STORE_GLOBAL:
+        return access->op == Opcode::LOAD_GLOBAL && access->text == writer->text;
+    case Opcode::CALL:
+    {
+        IRFunction *callee = writer->function->module->getFunction(writer->text);
+        if (callee && !purity.effectsOf(callee).writesMemory)
+            return false;
+        if (access->op == Opcode::LOAD && isAllocation(access->operands[0]))
+        {
+            for (auto arg : writer->operands)
+            {
+                if (arg == access->operands[0])
+                    return true;
+            }
+            return false;
+        }
+        return true;
+    }
+    case Opcode::AWAIT:
+        // The task's writes become visible here, and it may have been handed any array.
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef ALIAS_ANALYSIS_H
+#define ALIAS_ANALYSIS_H
+
+#include "ir.h"
+#include "purity.h"
+
+using namespace std;
+
+enum class AliasResult
+{
+    NO_ALIAS,
+    MAY_ALIAS,
+    MUST_ALIAS
+};
+
+AliasResult aliasArrays(const Instruction *base, const Instruction *otherBase);
+AliasResult aliasAccesses(const Instruction *access, const Instruction *other);
+bool mayClobber(const Instruction *writer, const Instruction *access, const PurityAnalysis &purity);
+
+#endif
@@ -19,4 +19,8 @@ void Variable::accept(ASTVisitor *visitor) { visitor->visitVariable(this); }
 void ArrayAccess::accept(ASTVisitor *visitor) { visitor->visitArrayAccess(this); }
 void BinaryOp::accept(ASTVisitor *visitor) { visitor->visitBinaryOp(this); }
 void UnaryOp::accept(ASTVisitor *visitor) { visitor->visitUnaryOp(this); }
-void FunctionCall::accept(ASTVisitor *visitor) { visitor->visitFunctionCall(this); }
\ No newline at end of file
+void FunctionCall::accept(ASTVisitor *visitor) { visitor->visitFunctionCall(this); }
+void SpawnExpression::accept(ASTVisitor *visitor) { visitor->visitSpawnExpression(this); }
+void AwaitExpression::accept(ASTVisitor *visitor) { visitor->visitAwaitExpression(this); }
+void ChannelExpression::accept(ASTVisitor *visitor) { visitor->visitChannelExpression(this); }
+void VectorExpression::accept(ASTVisitor *visitor) { visitor->visitVectorExpression(this); }
\ No newline at end of file
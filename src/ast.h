@@ -112,10 +112,56 @@ class FunctionCall : public Expression
 public:
     string name;
     vector<shared_ptr<Expression>> args;
+    bool builtin;
+    // Set by semantic analysis for atomic builtins, which take the order out of the argument list.
+    string memoryOrder;
 
     FunctionCall(const string &name,
                  const vector<shared_ptr<Expression>> &args)
-        : name(name), args(args) {}
+        : name(name), args(args), builtin(false), memoryOrder("seq_cst") {}
+    void accept(ASTVisitor *visitor) override;
+};
+
+class SpawnExpression : public Expression
+{
+public:
+    shared_ptr<FunctionCall> call;
+
+    SpawnExpression(shared_ptr<FunctionCall> call) : call(call) {}
+    void accept(ASTVisitor *visitor) override;
+};
+
+class ChannelExpression : public Expression
+{
+public:
+    shared_ptr<Expression> capacity;
+
+    ChannelExpression(shared_ptr<Type> channelType, shared_ptr<Expression> capacity) : capacity(capacity)
+    {
+        type = channelType;
+    }
+    void accept(ASTVisitor *visitor) override;
+};
+
+// vecNf(x) splats x, vecNf(a, b, ...) sets each lane, and vecNf(array, i) loads lanes from array[i].
+class VectorExpression : public Expression
+{
+public:
+    vector<shared_ptr<Expression>> args;
+
+    VectorExpression(shared_ptr<Type> vectorType, const vector<shared_ptr<Expression>> &args) : args(args)
+    {
+        type = vectorType;
+    }
+    void accept(ASTVisitor *visitor) override;
+};
+
+class AwaitExpression : public Expression
+{
+public:
+    shared_ptr<Expression> task;
+
+    AwaitExpression(shared_ptr<Expression> task) : task(task) {}
     void accept(ASTVisitor *visitor) override;
 };
 
@@ -179,6 +225,18 @@ public:
     void accept(ASTVisitor *visitor) override;
 };
 
+class Annotation
+{
+public:
+    string name;
+    vector<int> args;
+    int line;
+    int column;
+
+    Annotation(const string &name, int line, int column)
+        : name(name), line(line), column(column) {}
+};
+
 class ForStatement : public Statement
 {
 public:
@@ -186,12 +244,14 @@ public:
     shared_ptr<Expression> condition;
     shared_ptr<Statement> update;
     shared_ptr<Statement> body;
+    vector<Annotation> annotations;
+    bool parallel;
 
     ForStatement(shared_ptr<Statement> init,
                  shared_ptr<Expression> condition,
                  shared_ptr<Statement> update,
                  shared_ptr<Statement> body)
-        : init(init), condition(condition), update(update), body(body) {}
+        : init(init), condition(condition), update(update), body(body), parallel(false) {}
     void accept(ASTVisitor *visitor) override;
 };
 
@@ -228,9 +288,11 @@ class Parameter
 public:
     shared_ptr<Type> type;
     string name;
+    // The caller promises that no other array reachable from the call refers to this one.
+    bool noalias;
 
-    Parameter(shared_ptr<Type> type, const string &name)
-        : type(type), name(name) {}
+    Parameter(shared_ptr<Type> type, const string &name, bool noalias = false)
+        : type(type), name(name), noalias(noalias) {}
 };
 
 class Function : public ASTNode
@@ -240,6 +302,7 @@ public:
     string name;
     vector<Parameter> parameters;
     shared_ptr<Block> body;
+    vector<Annotation> annotations;
 
     Function(shared_ptr<Type> returnType, const string &name,
              const vector<Parameter> &parameters,
@@ -283,6 +346,10 @@ public:
     virtual void visitBinaryOp(BinaryOp *node) = 0;
     virtual void visitUnaryOp(UnaryOp *node) = 0;
     virtual void visitFunctionCall(FunctionCall *node) = 0;
+    virtual void visitSpawnExpression(SpawnExpression *node) = 0;
+    virtual void visitAwaitExpression(AwaitExpression *node) = 0;
+    virtual void visitChannelExpression(ChannelExpression *node) = 0;
+    virtual void visitVectorExpression(VectorExpression *node) = 0;
 };
 
 #endif 
\ No newline at end of file
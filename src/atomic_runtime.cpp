@@ -0,0 +1,38 @@
+#include "atomic_runtime.h"
+
+using namespace std;
+
+const char *const atomicRuntimeSource = R"(#include <stdatomic.h>
+
+static int nova_compare_exchange(atomic_int *cell, int expected, int desired, memory_order success,
+                                 memory_order failure)
+{
+    return atomic_compare_exchange_strong_explicit(cell, &expected, desired, success, failure);
+}
+)";
+
+bool isAtomicBuiltin(const string &name)
+{
+    return name == "atomic_load" || name == "atomic_store" || name == "fetch_add" || name == "compare_exchange";
+}
+
+bool isMemoryOrder(const string &name)
+{
+    return name == "relaxed" || name == "acquire" || name == "release" || name == "acq_rel" || name == "seq_cst";
+}
+
+string atomicCall(const string &name, const vector<string> &args, const string &order)
+{
+    string memoryOrder = "memory_order_" + order;
+    if (name == "atomic_load")
+        return "atomic_load_explicit(" + args[0] + ", " + memoryOrder + ")";
+    if (name == "atomic_store")
+        return "atomic_store_explicit(" + args[0] + ", " + args[1] + ", " + memoryOrder + ")";
+    if (name == "fetch_add")
+        return "atomic_fetch_add_explicit(" + args[0] + ", " + args[1] + ", " + memoryOrder + ")";
+
+    // A failed exchange only loads, so it cannot have release semantics.
+    string failure = order == "release" ? "relaxed" : order == "acq_rel" ? "acquire" : order;
+    return "nova_compare_exchange(" + args[0] + ", " + args[1] + ", " + args[2] + ", " + memoryOrder +
+           ", memory_order_" + failure + ")";
+}
@@ -0,0 +1,21 @@
+#ifndef ATOMIC_RUNTIME_H
+#define ATOMIC_RUNTIME_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// C source of the helpers behind the atomic builtins, emitted into programs that use `atomic int`.
+extern const char *const atomicRuntimeSource;
+
+// atomic_load, atomic_store, fetch_add and compare_exchange.
+bool isAtomicBuiltin(const string &name);
+// relaxed, acquire, release, acq_rel and seq_cst.
+bool isMemoryOrder(const string &name);
+
+// C expression for the atomic builtin `name` applied to the C expressions `args`, the first of which
+// points to the atomic cell.
+string atomicCall(const string &name, const vector<string> &args, const string &order);
+
+#endif
@@ -0,0 +1,104 @@
+#include "bounds_check.h"
+
+using namespace std;
+
+static bool isArrayAccess(const Instruction *instr)
+{
+    return instr->op == Opcode::LOAD || instr->op == Opcode::STORE;
+}
+
+static int arraySize(const Instruction *access)
+{
+    return static_pointer_cast<ArrayType>(access->operands[0]->type)->size;
+}
+
+void BoundsCheckElimination::removeRedundant(BasicBlock *block, const DominatorTree &dominators,
+                                             CoveredAccesses &covered)
+{
+    vector<pair<Instruction *, int>> added;
+    for (auto &instr : block->instructions)
+    {
+        if (!isArrayAccess(instr.get()) || instr->speculative)
+            continue;
+
+        pair<Instruction *, int> key{instr->operands[1], arraySize(instr.get())};
+        if (covered.insert(key).second)
+        {
+            added.push_back(key);
+        }
+        else if (instr->checked)
+        {
+            instr->checked = false;
+            ++redundant;
+        }
+    }
+
+    for (auto child : dominators.childrenOf(block))
+    {
+        removeRedundant(child, dominators, covered);
+    }
+
+    for (auto &key : added)
+    {
+        covered.erase(key);
+    }
+}
+
+bool BoundsCheckElimination::runOnFunction(IRFunction &function)
+{
+    vector<Instruction *> checks;
+    for (auto &block : function.blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (instr->checked)
+                checks.push_back(instr.get());
+        }
+    }
+    if (checks.empty())
+        return false;
+
+    bool changed = insertPreheaders(function);
+    DominatorTree dominators(function);
+    LoopInfo loops(dominators);
+    RangeAnalysis ranges(dominators, loops);
+
+    int proven = 0;
+    for (auto access : checks)
+    {
+        if (ranges.rangeAt(access->operands[1], access->parent).within(0, arraySize(access) - 1))
+        {
+            access->checked = false;
+            ++proven;
+        }
+    }
+
+    redundant = 0;
+    CoveredAccesses covered;
+    removeRedundant(function.entry(), dominators, covered);
+
+    int remaining = static_cast<int>(checks.size()) - proven - redundant;
+    statistics.push_back({function.name, proven, redundant, remaining});
+    return changed || proven > 0 || redundant > 0;
+}
+
+bool BoundsCheckElimination::runOnModule(IRModule &module)
+{
+    statistics.clear();
+
+    bool changed = false;
+    for (auto &function : module.functions)
+    {
+        changed = runOnFunction(*function) || changed;
+    }
+    return changed;
+}
+
+void BoundsCheckElimination::printStatistics(ostream &out) const
+{
+    for (auto &entry : statistics)
+    {
+        out << "bounds-check-elim: " << entry.function << ": " << entry.proven << " proven in range, "
+            << entry.redundant << " redundant, " << entry.remaining << " kept" << endl;
+    }
+}
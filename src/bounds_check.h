@@ -0,0 +1,46 @@
+#ifndef BOUNDS_CHECK_H
+#define BOUNDS_CHECK_H
+
+#include <unordered_set>
+#include "pass_manager.h"
+#include "range_analysis.h"
+
+using namespace std;
+
+struct BoundsCheckStatistics
+{
+    string function;
+    int proven;
+    int redundant;
+    int remaining;
+};
+
+// Index values already checked against an array size on the path from the entry.
+struct CoveredAccessHash
+{
+    size_t operator()(const pair<Instruction *, int> &key) const
+    {
+        return hash<Instruction *>()(key.first) * 31 + hash<int>()(key.second);
+    }
+};
+
+using CoveredAccesses = unordered_set<pair<Instruction *, int>, CoveredAccessHash>;
+
+class BoundsCheckElimination : public Pass
+{
+private:
+    vector<BoundsCheckStatistics> statistics;
+    int redundant;
+
+    void removeRedundant(BasicBlock *block, const DominatorTree &dominators, CoveredAccesses &covered);
+    bool runOnFunction(IRFunction &function);
+
+public:
+    BoundsCheckElimination() : redundant(0) {}
+
+    string name() const override { return "bounds-check-elim"; }
+    bool runOnModule(IRModule &module) override;
+    void printStatistics(ostream &out) const override;
+};
+
+#endif
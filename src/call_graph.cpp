@@ -0,0 +1,102 @@
+#include "call_graph.h"
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+CallGraph::CallGraph(const IRModule &module) : module(module)
+{
+    for (auto &function : module.functions)
+    {
+        IRFunction *caller = function.get();
+        calleeMap[caller];
+        callerMap[caller];
+
+        for (auto &block : function->blocks)
+        {
+            for (auto &instr : block->instructions)
+            {
+                if (instr->op != Opcode::CALL)
+                    continue;
+
+                callSiteMap[caller].push_back(instr.get());
+                IRFunction *callee = module.getFunction(instr->text);
+                if (!callee)
+                    continue;
+
+                auto &targets = calleeMap[caller];
+                if (find(targets.begin(), targets.end(), callee) == targets.end())
+                {
+                    targets.push_back(callee);
+                    callerMap[callee].push_back(caller);
+                }
+            }
+        }
+    }
+
+    computeComponents();
+}
+
+void CallGraph::computeComponents()
+{
+    unordered_map<IRFunction *, int> index;
+    unordered_map<IRFunction *, int> lowlink;
+    unordered_set<IRFunction *> onStack;
+    vector<IRFunction *> stack;
+    int nextIndex = 0;
+    int nextComponent = 0;
+
+    function<void(IRFunction *)> connect = [&](IRFunction *node)
+    {
+        index[node] = lowlink[node] = nextIndex++;
+        stack.push_back(node);
+        onStack.insert(node);
+
+        for (auto callee : calleeMap[node])
+        {
+            if (!index.count(callee))
+            {
+                connect(callee);
+                lowlink[node] = min(lowlink[node], lowlink[callee]);
+            }
+            else if (onStack.count(callee))
+            {
+                lowlink[node] = min(lowlink[node], index[callee]);
+            }
+        }
+
+        if (lowlink[node] != index[node])
+            return;
+
+        vector<IRFunction *> members;
+        IRFunction *member;
+        do
+        {
+            member = stack.back();
+            stack.pop_back();
+            onStack.erase(member);
+            componentOf[member] = nextComponent;
+            members.push_back(member);
+        } while (member != node);
+
+        auto &selfCalls = calleeMap[node];
+        if (members.size() > 1 || find(selfCalls.begin(), selfCalls.end(), node) != selfCalls.end())
+        {
+            recursiveComponents.insert(nextComponent);
+        }
+        order.insert(order.end(), members.rbegin(), members.rend());
+        ++nextComponent;
+    };
+
+    for (auto &function : module.functions)
+    {
+        if (!index.count(function.get()))
+            connect(function.get());
+    }
+}
+
+bool CallGraph::isRecursive(IRFunction *function) const
+{
+    auto it = componentOf.find(function);
+    return it != componentOf.end() && recursiveComponents.count(it->second) > 0;
+}
@@ -0,0 +1,34 @@
+#ifndef CALL_GRAPH_H
+#define CALL_GRAPH_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "ir.h"
+
+using namespace std;
+
+class CallGraph
+{
+private:
+    const IRModule &module;
+    unordered_map<IRFunction *, vector<IRFunction *>> calleeMap;
+    unordered_map<IRFunction *, vector<IRFunction *>> callerMap;
+    unordered_map<IRFunction *, vector<Instruction *>> callSiteMap;
+    unordered_map<IRFunction *, int> componentOf;
+    unordered_set<int> recursiveComponents;
+    vector<IRFunction *> order;
+
+    void computeComponents();
+
+public:
+    CallGraph(const IRModule &module);
+
+    const vector<IRFunction *> &callees(IRFunction *function) { return calleeMap[function]; }
+    const vector<IRFunction *> &callers(IRFunction *function) { return callerMap[function]; }
+    const vector<Instruction *> &callSites(IRFunction *function) { return callSiteMap[function]; }
+    bool isRecursive(IRFunction *function) const;
+    const vector<IRFunction *> &bottomUpOrder() const { return order; }
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "cfg.h"
+#include <algorithm>
+
+using namespace std;
+
+vector<BasicBlock *> reversePostOrder(const IRFunction &function)
+{
+    vector<BasicBlock *> postOrder;
+    if (function.blocks.empty())
+        return postOrder;
+
+    unordered_set<BasicBlock *> visited;
+    vector<pair<BasicBlock *, size_t>> stack;
+    BasicBlock *entry = function.entry();
+    visited.insert(entry);
+    stack.push_back({entry, 0});
+
+    while (!stack.empty())
+    {
+        BasicBlock *block = stack.back().first;
+        vector<BasicBlock *> succs = block->successors();
+        size_t &next = stack.back().second;
+
+        if (next < succs.size())
+        {
+            BasicBlock *succ = succs[succs.size() - 1 - next++];
+            if (visited.insert(succ).second)
+            {
+                stack.push_back({succ, 0});
+            }
+        }
+        else
+        {
+            postOrder.push_back(block);
+            stack.pop_back();
+        }
+    }
+
+    reverse(postOrder.begin(), postOrder.end());
+    return postOrder;
+}
+
+unordered_set<BasicBlock *> reachableBlocks(const IRFunction &function)
+{
+    vector<BasicBlock *> order = reversePostOrder(function);
+    return unordered_set<BasicBlock *>(order.begin(), order.end());
+}
+
+DominatorTree::DominatorTree(const IRFunction &function)
+{
+    order = ::reversePostOrder(function);
+    if (order.empty())
+        return;
+
+    unordered_map<BasicBlock *, int> rpoIndex;
+    unordered_map<BasicBlock *, vector<BasicBlock *>> preds;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        rpoIndex[order[i]] = static_cast<int>(i);
+        for (auto succ : order[i]->successors())
+        {
+            preds[succ].push_back(order[i]);
+        }
+    }
+
+    BasicBlock *entry = order[0];
+    idom[entry] = entry;
+
+    auto intersect = [&](BasicBlock *a, BasicBlock *b)
+    {
+        while (a != b)
+        {
+            while (rpoIndex[a] > rpoIndex[b])
+                a = idom[a];
+            while (rpoIndex[b] > rpoIndex[a])
+                b = idom[b];
+        }
+        return a;
+    };
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 1; i < order.size(); ++i)
+        {
+            BasicBlock *block = order[i];
+            BasicBlock *newIdom = nullptr;
+            for (auto pred : preds[block])
+            {
+                if (!idom.count(pred))
+                    continue;
+                newIdom = newIdom ? intersect(pred, newIdom) : pred;
+            }
+            if (newIdom && idom[block] != newIdom)
+            {
+                idom[block] = newIdom;
+                changed = true;
+            }
+        }
+    }
+
+    for (size_t i = 1; i < order.size(); ++i)
+    {
+        children[idom[order[i]]].push_back(order[i]);
+    }
+
+    int counter = 0;
+    vector<pair<BasicBlock *, size_t>> stack;
+    stack.push_back({entry, 0});
+    preorder[entry] = counter++;
+    while (!stack.empty())
+    {
+        BasicBlock *block = stack.back().first;
+        size_t &next = stack.back().second;
+        const vector<BasicBlock *> &kids = childrenOf(block);
+        if (next < kids.size())
+        {
+            BasicBlock *child = kids[next++];
+            preorder[child] = counter++;
+            stack.push_back({child, 0});
+        }
+        else
+        {
+            postorder[block] = counter++;
+            stack.pop_back();
+        }
+    }
+}
+
+bool DominatorTree::isReachable(BasicBlock *block) const
+{
+    return idom.count(block) > 0;
+}
+
+BasicBlock *DominatorTree::immediateDominator(BasicBlock *block) const
+{
+    auto it = idom.find(block);
+    if (it == idom.end() || it->second == block)
+        return nullptr;
+    return it->second;
+}
+
+const vector<BasicBlock *> &DominatorTree::childrenOf(BasicBlock *block) const
+{
+    static const vector<BasicBlock *> empty;
+    auto it = children.find(block);
+    return it == children.end() ? empty : it->second;
+}
+
+bool DominatorTree::dominates(BasicBlock *a, BasicBlock *b) const
+{
+    if (!isReachable(a) || !isReachable(b))
+        return false;
+    return preorder.at(a) <= preorder.at(b) && postorder.at(b) <= postorder.at(a);
+}
+
+bool DominatorTree::dominates(const Instruction *def, const Instruction *use) const
+{
+    if (!def->parent)
+        return true;
+    if (def->parent != use->parent)
+        return dominates(def->parent, use->parent);
+
+    for (auto &instr : def->parent->instructions)
+    {
+        if (instr.get() == def)
+            return true;
+        if (instr.get() == use)
+            return false;
+    }
+    return false;
+}
@@ -0,0 +1,34 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "ir.h"
+
+using namespace std;
+
+vector<BasicBlock *> reversePostOrder(const IRFunction &function);
+unordered_set<BasicBlock *> reachableBlocks(const IRFunction &function);
+
+class DominatorTree
+{
+private:
+    unordered_map<BasicBlock *, BasicBlock *> idom;
+    unordered_map<BasicBlock *, vector<BasicBlock *>> children;
+    unordered_map<BasicBlock *, int> preorder;
+    unordered_map<BasicBlock *, int> postorder;
+    vector<BasicBlock *> order;
+
+public:
+    DominatorTree(const IRFunction &function);
+
+    bool isReachable(BasicBlock *block) const;
+    BasicBlock *immediateDominator(BasicBlock *block) const;
+    const vector<BasicBlock *> &childrenOf(BasicBlock *block) const;
+    const vector<BasicBlock *> &reversePostOrder() const { return order; }
+    bool dominates(BasicBlock *a, BasicBlock *b) const;
+    bool dominates(const Instruction *def, const Instruction *use) const;
+};
+
+#endif
@@ -0,0 +1,402 @@
+#include "channel_runtime.h"
+
+using namespace std;
+
+// A bounded multi-producer multi-consumer ring (Vyukov). Each cell's sequence number says whose turn it
+// is, so an operation costs one CAS on the tail or head; a batch claims a run of ready cells with that
+// single CAS. Blocked threads yield, and ask the scheduler for another worker if they stay blocked
+// while tasks are queued, so a producer queued behind its consumer still gets to run.
+const char *const channelRuntimeSource = R"(typedef struct
+{
+    atomic_long sequence;
+    long long data;
+} nova_cell;
+
+typedef struct
+{
+    _Alignas(64) atomic_long head;
+    _Alignas(64) atomic_long tail;
+    _Alignas(64) long mask;
+    int size;
+    atomic_int closed;
+    nova_cell *cells;
+} nova_chan;
+
+typedef nova_chan *nova_channel;
+
+static nova_channel nova_chan_new(int capacity, int size)
+{
+    if (capacity <= 0 || capacity > (1 << 26))
+    {
+        fprintf(stderr, "Runtime error: invalid channel capacity %d\n", capacity);
+        exit(1);
+    }
+    long count = 2;
+    while (count < capacity)
+        count <<= 1;
+
+    nova_chan *chan = aligned_alloc(64, sizeof(nova_chan));
+    nova_cell *cells = malloc(count * sizeof(nova_cell));
+    if (!chan || !cells)
+    {
+        fprintf(stderr, "Runtime error: out of memory\n");
+        exit(1);
+    }
+    for (long i = 0; i < count; ++i)
+        atomic_init(&cells[i].sequence, i);
+    atomic_init(&chan->head, 0);
+    atomic_init(&chan->tail, 0);
+    atomic_init(&chan->closed, 0);
+    chan->mask = count - 1;
+    chan->size = size;
+    chan->cells = cells;
+    return chan;
+}
+
+static nova_chan *nova_chan_check(nova_channel chan)
+{
+    if (!chan)
+    {
+        fprintf(stderr, "Runtime error: use of an uninitialized channel\n");
+        exit(1);
+    }
+    return chan;
+}
+
+static int nova_batch_size(int count, int size)
+{
+    if (count < 0 || count > size)
+    {
+        fprintf(stderr, "Runtime error: batch of %d items does not fit an array of size %d\n", count, size);
+        exit(1);
+    }
+    return count;
+}
+
+// Claims up to count consecutive cells at *index whose sequence is their position plus offset: free
+// cells for producers (offset 0) and filled cells for consumers (offset 1).
+static int nova_chan_claim(nova_chan *chan, atomic_long *index, long offset, int count, long *start)
+{
+    long pos = atomic_load_explicit(index, memory_order_relaxed);
+    for (;;)
+    {
+        int ready = 0;
+        while (ready < count && atomic_load_explicit(&chan->cells[(pos + ready) & chan->mask].sequence,
+                                                     memory_order_acquire) == pos + ready + offset)
+            ready++;
+        if (ready == 0)
+        {
+            long sequence = atomic_load_explicit(&chan->cells[pos & chan->mask].sequence, memory_order_acquire);
+            if (sequence < pos + offset)
+                return 0;
+            pos = atomic_load_explicit(index, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(index, &pos, pos + ready, memory_order_relaxed,
+                                                  memory_order_relaxed))
+        {
+            *start = pos;
+            return ready;
+        }
+    }
+}
+
+static int nova_chan_push(nova_chan *chan, const char *items, int count)
+{
+    long start;
+    int claimed = nova_chan_claim(chan, &chan->tail, 0, count, &start);
+    for (int i = 0; i < claimed; ++i)
+    {
+        nova_cell *cell = &chan->cells[(start + i) & chan->mask];
+        memcpy(&cell->data, items + (long)i * chan->size, chan->size);
+        atomic_store_explicit(&cell->sequence, start + i + 1, memory_order_release);
+    }
+    return claimed;
+}
+
+static int nova_chan_pop(nova_chan *chan, char *items, int count)
+{
+    long start;
+    int claimed = nova_chan_claim(chan, &chan->head, 1, count, &start);
+    for (int i = 0; i < claimed; ++i)
+    {
+        nova_cell *cell = &chan->cells[(start + i) & chan->mask];
+        memcpy(items + (long)i * chan->size, &cell->data, chan->size);
+        atomic_store_explicit(&cell->sequence, start + i + chan->mask + 1, memory_order_release);
+    }
+    return claimed;
+}
+
+static void nova_chan_wait(int *spins)
+{
+    if (++*spins % 4096 == 0)
+        nova_tasks_compensate();
+    sched_yield();
+}
+
+static void nova_chan_check_open(nova_chan *chan)
+{
+    if (atomic_load_explicit(&chan->closed, memory_order_relaxed))
+    {
+        fprintf(stderr, "Runtime error: send on a closed channel\n");
+        exit(1);
+    }
+}
+
+static void nova_chan_send_batch(nova_channel chan, const void *items, int count)
+{
+    nova_chan_check(chan);
+    int spins = 0;
+    while (count > 0)
+    {
+        nova_chan_check_open(chan);
+        int pushed = nova_chan_push(chan, items, count);
+        items = (const char *)items + (long)pushed * chan->size;
+        count -= pushed;
+        if (pushed == 0)
+            nova_chan_wait(&spins);
+    }
+}
+
+static void nova_chan_send(nova_channel chan, const void *item)
+{
+    nova_chan_send_batch(chan, item, 1);
+}
+
+static int nova_chan_try_send(nova_channel chan, const void *item)
+{
+    nova_chan_check_open(nova_chan_check(chan));
+    return nova_chan_push(chan, item, 1);
+}
+
+static int nova_chan_try_receive(nova_channel chan, void *items, int count)
+{
+    return count > 0 ? nova_chan_pop(nova_chan_check(chan), items, count) : 0;
+}
+
+// Blocks until at least one item arrives; returns 0 once the channel is closed and drained.
+static int nova_chan_receive_batch(nova_channel chan, void *items, int count)
+{
+    nova_chan_check(chan);
+    if (count == 0)
+        return 0;
+    int spins = 0;
+    for (;;)
+    {
+        int popped = nova_chan_pop(chan, items, count);
+        if (popped > 0)
+            return popped;
+        if (atomic_load_explicit(&chan->closed, memory_order_acquire))
+            return nova_chan_pop(chan, items, count);
+        nova_chan_wait(&spins);
+    }
+}
+
+static int nova_chan_receive_int(nova_channel chan)
+{
+    int item = 0;
+    nova_chan_receive_batch(chan, &item, 1);
+    return item;
+}
+
+static float nova_chan_receive_float(nova_channel chan)
+{
+    float item = 0.0f;
+    nova_chan_receive_batch(chan, &item, 1);
+    return item;
+}
+
+static char *nova_chan_receive_string(nova_channel chan)
+{
+    char *item = NULL;
+    nova_chan_receive_batch(chan, &item, 1);
+    return item;
+}
+
+static void nova_chan_close(nova_channel chan)
+{
+    atomic_store_explicit(&nova_chan_check(chan)->closed, 1, memory_order_release);
+}
+)";
+
+// Spawned calls run to completion when they are created here, so a producer always finishes before
+// its consumer starts: the queue grows instead of blocking, and a receive that would wait is an error.
+const char *const sequentialChannelRuntimeSource = R"(typedef struct
+{
+    long head;
+    long tail;
+    long capacity;
+    long limit;
+    int size;
+    int closed;
+    char *items;
+} nova_chan;
+
+typedef nova_chan *nova_channel;
+
+static nova_channel nova_chan_new(int capacity, int size)
+{
+    if (capacity <= 0)
+    {
+        fprintf(stderr, "Runtime error: invalid channel capacity %d\n", capacity);
+        exit(1);
+    }
+    nova_chan *chan = calloc(1, sizeof(nova_chan));
+    if (!chan)
+    {
+        fprintf(stderr, "Runtime error: out of memory\n");
+        exit(1);
+    }
+    // Only try_send observes the capacity; it is rounded up as the threaded ring rounds it.
+    chan->limit = 2;
+    while (chan->limit < capacity)
+        chan->limit <<= 1;
+    chan->size = size;
+    return chan;
+}
+
+static nova_chan *nova_chan_check(nova_channel chan)
+{
+    if (!chan)
+    {
+        fprintf(stderr, "Runtime error: use of an uninitialized channel\n");
+        exit(1);
+    }
+    return chan;
+}
+
+static int nova_batch_size(int count, int size)
+{
+    if (count < 0 || count > size)
+    {
+        fprintf(stderr, "Runtime error: batch of %d items does not fit an array of size %d\n", count, size);
+        exit(1);
+    }
+    return count;
+}
+
+static void nova_chan_send_batch(nova_channel chan, const void *items, int count)
+{
+    nova_chan_check(chan);
+    if (chan->closed)
+    {
+        fprintf(stderr, "Runtime error: send on a closed channel\n");
+        exit(1);
+    }
+    if (chan->tail + count > chan->capacity)
+    {
+        long capacity = chan->capacity < 16 ? 16 : chan->capacity;
+        while (chan->tail + count > capacity)
+            capacity *= 2;
+        chan->items = realloc(chan->items, capacity * chan->size);
+        if (!chan->items)
+        {
+            fprintf(stderr, "Runtime error: out of memory\n");
+            exit(1);
+        }
+        chan->capacity = capacity;
+    }
+    memcpy(chan->items + chan->tail * chan->size, items, (long)count * chan->size);
+    chan->tail += count;
+}
+
+static void nova_chan_send(nova_channel chan, const void *item)
+{
+    nova_chan_send_batch(chan, item, 1);
+}
+
+static int nova_chan_try_send(nova_channel chan, const void *item)
+{
+    nova_chan_check(chan);
+    if (!chan->closed && chan->tail - chan->head >= chan->limit)
+        return 0;
+    nova_chan_send_batch(chan, item, 1);
+    return 1;
+}
+
+static int nova_chan_try_receive(nova_channel chan, void *items, int count)
+{
+    nova_chan_check(chan);
+    long available = chan->tail - chan->head;
+    int popped = available < count ? (int)available : count;
+    if (popped > 0)
+        memcpy(items, chan->items + chan->head * chan->size, (long)popped * chan->size);
+    chan->head += popped;
+    return popped;
+}
+
+static int nova_chan_receive_batch(nova_channel chan, void *items, int count)
+{
+    int popped = nova_chan_try_receive(chan, items, count);
+    if (popped == 0 && count > 0 && !chan->closed)
+    {
+        fprintf(stderr, "Runtime error: receive on an empty channel would block forever\n");
+        exit(1);
+    }
+    return popped;
+}
+
+static int nova_chan_receive_int(nova_channel chan)
+{
+    int item = 0;
+    nova_chan_receive_batch(chan, &item, 1);
+    return item;
+}
+
+static float nova_chan_receive_float(nova_channel chan)
+{
+    float item = 0.0f;
+    nova_chan_receive_batch(chan, &item, 1);
+    return item;
+}
+
+static char *nova_chan_receive_string(nova_channel chan)
+{
+    char *item = NULL;
+    nova_chan_receive_batch(chan, &item, 1);
+    return item;
+}
+
+static void nova_chan_close(nova_channel chan)
+{
+    nova_chan_check(chan)->closed = 1;
+}
+)";
+
+bool isChannelBuiltin(const string &name)
+{
+    return name == "send" || name == "try_send" || name == "receive" || name == "try_receive" ||
+           name == "send_batch" || name == "receive_batch" || name == "close";
+}
+
+static string elementCType(const shared_ptr<Type> &element)
+{
+    switch (element->kind)
+    {
+    case TypeKind::FLOAT:
+        return "float";
+    case TypeKind::STRING:
+        return "char*";
+    default:
+        return "int";
+    }
+}
+
+string channelCall(const string &name, const vector<string> &args, const shared_ptr<Type> &channel, int arraySize)
+{
+    auto element = static_pointer_cast<ChannelType>(channel)->elementType;
+    string type = elementCType(element);
+    if (name == "channel")
+        return "nova_chan_new(" + args[0] + ", sizeof(" + type + "))";
+    if (name == "send" || name == "try_send")
+        return "nova_chan_" + name + "(" + args[0] + ", &(" + type + "){" + args[1] + "})";
+    if (name == "receive")
+    {
+        string suffix = type == "float" ? "float" : type == "char*" ? "string" : "int";
+        return "nova_chan_receive_" + suffix + "(" + args[0] + ")";
+    }
+    if (name == "close")
+        return "nova_chan_close(" + args[0] + ")";
+    return "nova_chan_" + name + "(" + args[0] + ", " + args[1] + ", nova_batch_size(" + args[2] + ", " +
+           to_string(arraySize) + "))";
+}
@@ -0,0 +1,22 @@
+#ifndef CHANNEL_RUNTIME_H
+#define CHANNEL_RUNTIME_H
+
+#include <string>
+#include <vector>
+#include "types.h"
+
+using namespace std;
+
+// C source of the lock-free channels, emitted after the task scheduler into programs that use them.
+extern const char *const channelRuntimeSource;
+// Unbounded single-threaded channels for the AST backend, where spawned calls run to completion.
+extern const char *const sequentialChannelRuntimeSource;
+
+// send, try_send, receive, try_receive, send_batch, receive_batch and close.
+bool isChannelBuiltin(const string &name);
+
+// C expression for the builtin `name` (or "channel" to create one) applied to the C expressions `args`.
+// Batch operations check their count against arraySize, the size of the array argument.
+string channelCall(const string &name, const vector<string> &args, const shared_ptr<Type> &channel, int arraySize);
+
+#endif
@@ -0,0 +1,75 @@
+#include "cloning.h"
+
+using namespace std;
+
+Instruction *mapConstant(IRFunction &target, const Instruction *constant)
+{
+    if (constant->op == Opcode::GLOBAL)
+        return target.globalRef(constant->text, constant->type);
+
+    switch (constant->type->kind)
+    {
+    case TypeKind::FLOAT:
+        return target.constFloat(constant->floatValue);
+    case TypeKind::BOOL:
+        return target.constBool(constant->intValue != 0);
+    case TypeKind::STRING:
+        return constant->intValue ? target.nullString() : target.constString(constant->text);
+    case TypeKind::INT:
+        return target.constInt(constant->intValue);
+    default:
+        return target.zeroValue(constant->type);
+    }
+}
+
+unique_ptr<Instruction> cloneInstruction(IRFunction &target, const Instruction *instr)
+{
+    auto clone = target.createInstruction(instr->op, instr->type);
+    clone->name = instr->name;
+    clone->intValue = instr->intValue;
+    clone->floatValue = instr->floatValue;
+    clone->text = instr->text;
+    clone->speculative = instr->speculative;
+    clone->checked = instr->checked;
+    clone->parallel = instr->parallel;
+    clone->spawn = instr->spawn;
+    return clone;
+}
+
+void cloneBlocks(const IRFunction &source, IRFunction &target, ValueMap &values, BlockMap &blockMap)
+{
+    for (auto &block : source.blocks)
+    {
+        BasicBlock *copy = target.createBlock();
+        copy->unrollFactor = block->unrollFactor;
+        blockMap[block.get()] = copy;
+
+        for (auto &instr : block->instructions)
+        {
+            values[instr.get()] = copy->insertBefore(nullptr, cloneInstruction(target, instr.get()));
+        }
+    }
+
+    for (auto &block : source.blocks)
+    {
+        BasicBlock *copy = blockMap[block.get()];
+        auto it = copy->instructions.begin();
+
+        for (auto &instr : block->instructions)
+        {
+            Instruction *clone = (it++)->get();
+            for (auto operand : instr->operands)
+            {
+                auto mapped = values.find(operand);
+                if (mapped != values.end())
+                    clone->addOperand(mapped->second);
+                else
+                    clone->addOperand(mapConstant(target, operand));
+            }
+            for (auto successor : instr->blocks)
+            {
+                clone->blocks.push_back(blockMap[successor]);
+            }
+        }
+    }
+}
@@ -0,0 +1,16 @@
+#ifndef CLONING_H
+#define CLONING_H
+
+#include <unordered_map>
+#include "ir.h"
+
+using namespace std;
+
+typedef unordered_map<Instruction *, Instruction *> ValueMap;
+typedef unordered_map<BasicBlock *, BasicBlock *> BlockMap;
+
+Instruction *mapConstant(IRFunction &target, const Instruction *constant);
+unique_ptr<Instruction> cloneInstruction(IRFunction &target, const Instruction *instr);
+void cloneBlocks(const IRFunction &source, IRFunction &target, ValueMap &values, BlockMap &blockMap);
+
+#endif
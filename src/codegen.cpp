@@ -1,27 +1,36 @@
 #include "codegen.h"
+#include "atomic_runtime.h"
+#include "channel_runtime.h"
+#include "input_runtime.h"
+#include "ir_emitter.h"
+#include "map_runtime.h"
+#include "print_runtime.h"
+#include "reduction.h"
+#include "vector_runtime.h"
 
 using namespace std;
 
-CodeGenerator::CodeGenerator(ostream &output)
-    : output(output), indent(0) {}
+CodeGenerator::CodeGenerator(ostream &output, bool boundsCheck)
+    : output(output), current(&body), indent(0), boundsCheck(boundsCheck), channels(false), atomics(false),
+      vectors(false), prints(false), inputs(false), maps(false) {}
 
 void CodeGenerator::writeIndent()
 {
     for (int i = 0; i < indent; ++i)
     {
-        output << "    ";
+        *current << "    ";
     }
 }
 
 void CodeGenerator::write(const string &text)
 {
-    output << text;
+    *current << text;
 }
 
 void CodeGenerator::writeLine(const string &text)
 {
     writeIndent();
-    output << text << endl;
+    *current << text << endl;
 }
 
 string CodeGenerator::getCType(shared_ptr<Type> type)
@@ -43,19 +52,92 @@ string CodeGenerator::getCType(shared_ptr<Type> type)
         auto arrayType = static_pointer_cast<ArrayType>(type);
         return getCType(arrayType->elementType) + "*";
     }
+    case TypeKind::TASK:
+    {
+        // Spawned calls run eagerly here, so a task holds its result; void tasks hold a dummy int.
+        auto taskType = static_pointer_cast<TaskType>(type);
+        return taskType->resultType->kind == TypeKind::VOID ? "int" : getCType(taskType->resultType);
+    }
+    case TypeKind::CHANNEL:
+        channels = true;
+        return "nova_channel";
+    case TypeKind::ATOMIC:
+        // Atomic variables are one-element arrays, so they are passed around by reference.
+        atomics = true;
+        return "atomic_int*";
+    case TypeKind::VECTOR:
+        vectors = true;
+        return type->toString();
     default:
         return "void*";
     }
 }
 
+string CodeGenerator::expression(Expression *expr)
+{
+    ostringstream text;
+    ostream *saved = current;
+    current = &text;
+    expr->accept(this);
+    current = saved;
+    return text.str();
+}
+
+// A vector access of several lanes must fit in the array as a whole.
+string CodeGenerator::checkedIndex(const string &index, int size, int lanes)
+{
+    if (!boundsCheck)
+        return index;
+    if (lanes > 1)
+        return "nova_vector_check(" + index + ", " + to_string(size) + ", " + to_string(lanes) + ")";
+    return "nova_bounds_check(" + index + ", " + to_string(size) + ")";
+}
+
+// Operands of vector arithmetic; scalars are broadcast to every lane.
+string CodeGenerator::vectorOperand(Expression *expr, shared_ptr<Type> type)
+{
+    if (expr->type->kind == TypeKind::VECTOR)
+        return expression(expr);
+    return vectorCall(type->toString(), {expression(expr)}, type);
+}
+
 void CodeGenerator::generate(shared_ptr<Program> program)
 {
-    writeLine("#include <stdio.h>");
-    writeLine("#include <stdlib.h>");
-    writeLine("#include <string.h>");
-    writeLine("");
+    output << "#include <stdio.h>" << endl;
+    output << "#include <stdlib.h>" << endl;
+    output << "#include <string.h>" << endl;
+    output << endl;
+
+    if (boundsCheck)
+    {
+        writeLine("static int nova_bounds_check(int index, int size)");
+        writeLine("{");
+        writeLine("    if ((unsigned)index >= (unsigned)size)");
+        writeLine("    {");
+        writeLine("        fprintf(stderr, \"Runtime error: array index %d out of bounds for size %d\\n\", index, size);");
+        writeLine("        exit(1);");
+        writeLine("    }");
+        writeLine("    return index;");
+        writeLine("}");
+        writeLine("");
+    }
 
     program->accept(this);
+
+    // Channel types are only known once the program has been generated, so the helpers go in front of it.
+    if (prints)
+        output << printRuntimeSource << endl;
+    if (inputs)
+        output << inputRuntimeSource << endl;
+    if (maps)
+        output << mapRuntimeSource << endl;
+    if (vectors)
+        output << vectorRuntimeSource << endl;
+    if (atomics)
+        output << atomicRuntimeSource << endl;
+    if (channels)
+        output << sequentialChannelRuntimeSource << endl;
+    output << body.str();
 }
 
 void CodeGenerator::visitProgram(Program *node)
@@ -76,19 +158,21 @@ void CodeGenerator::visitFunction(Function *node)
     }
     else
     {
-        write(getCType(node->returnType) + " " + node->name + "(");
+        write(getCType(node->returnType) + " " + symbolName(node->name) + "(");
     }
 
     for (size_t i = 0; i < node->parameters.size(); ++i)
     {
         if (i > 0)
             write(", ");
-        write(getCType(node->parameters[i].type) + " " + node->parameters[i].name);
+        write(getCType(node->parameters[i].type) + (node->parameters[i].noalias ? " restrict " : " ") +
+              symbolName(node->parameters[i].name));
     }
 
     writeLine(") {");
     indent++;
 
+    returnType = node->returnType;
     node->body->accept(this);
 
     if (node->name == "main" && node->returnType->kind == TypeKind::VOID)
@@ -104,15 +188,33 @@ void CodeGenerator::visitVarDeclaration(VarDeclaration *node)
 {
     writeIndent();
 
-    if (node->type->kind == TypeKind::ARRAY)
+    if (node->type->kind == TypeKind::ARRAY && node->initializer)
+    {
+        // Only mapped arrays have initializers; they point into the mapping.
+        write(getCType(node->type) + " " + symbolName(node->name));
+        if (!mappedArrays.empty())
+            mappedArrays.back().push_back({symbolName(node->name), node->type});
+    }
+    else if (node->type->kind == TypeKind::ARRAY)
     {
         auto arrayType = static_pointer_cast<ArrayType>(node->type);
-        write(getCType(arrayType->elementType) + " " + node->name);
-        write("[" + to_string(arrayType->size) + "]");
+        write(getCType(arrayType->elementType) + " " + symbolName(node->name));
+        write("[" + to_string(arrayType->size) + "] __attribute__((aligned(64)))");
+    }
+    else if (node->type->kind == TypeKind::ATOMIC)
+    {
+        getCType(node->type);
+        write("atomic_int " + symbolName(node->name) + "[1] = {");
+        if (node->initializer)
+            node->initializer->accept(this);
+        else
+            write("0");
+        writeLine("};");
+        return;
     }
     else
     {
-        write(getCType(node->type) + " " + node->name);
+        write(getCType(node->type) + " " + symbolName(node->name));
     }
 
     if (node->initializer)
@@ -124,6 +226,10 @@ void CodeGenerator::visitVarDeclaration(VarDeclaration *node)
     {
         write(" = NULL");
     }
+    else if (node->type->kind == TypeKind::VECTOR)
+    {
+        write(" = {0}");
+    }
 
     writeLine(";");
 }
@@ -135,12 +241,25 @@ void CodeGenerator::visitAssignment(Assignment *node)
     node->value->accept(this);
 }
 
+void CodeGenerator::writeUnmaps(const vector<pair<string, shared_ptr<Type>>> &arrays)
+{
+    for (auto it = arrays.rbegin(); it != arrays.rend(); ++it)
+    {
+        writeLine(unmapCall(it->first, it->second) + ";");
+    }
+}
+
+// Mapped arrays are released at the end of their block and before every return that leaves it.
 void CodeGenerator::visitBlock(Block *node)
 {
+    mappedArrays.push_back({});
     for (auto &stmt : node->statements)
     {
         stmt->accept(this);
     }
+    if (node->statements.empty() || !dynamic_cast<ReturnStatement *>(node->statements.back().get()))
+        writeUnmaps(mappedArrays.back());
+    mappedArrays.pop_back();
 }
 
 void CodeGenerator::visitIfStatement(IfStatement *node)
@@ -181,6 +300,10 @@ void CodeGenerator::visitWhileStatement(WhileStatement *node)
 
 void CodeGenerator::visitForStatement(ForStatement *node)
 {
+    // Iterations that touch disjoint elements have no dependences for GCC to assume through possibly aliasing
+    // array parameters.
+    if (hasIndependentIterations(node))
+        writeLine("#pragma GCC ivdep");
     writeIndent();
     write("for (");
 
@@ -188,7 +311,7 @@ void CodeGenerator::visitForStatement(ForStatement *node)
     {
         if (auto varDecl = dynamic_cast<VarDeclaration *>(node->init.get()))
         {
-            write(getCType(varDecl->type) + " " + varDecl->name);
+            write(getCType(varDecl->type) + " " + symbolName(varDecl->name));
             if (varDecl->initializer)
             {
                 write(" = ");
@@ -227,6 +350,27 @@ void CodeGenerator::visitForStatement(ForStatement *node)
 
 void CodeGenerator::visitReturnStatement(ReturnStatement *node)
 {
+    bool mapped = false;
+    for (auto &arrays : mappedArrays)
+    {
+        mapped = mapped || !arrays.empty();
+    }
+    if (mapped)
+    {
+        writeLine("{");
+        indent++;
+        if (node->value)
+            writeLine(getCType(returnType) + " nova_result = " + expression(node->value.get()) + ";");
+        for (auto it = mappedArrays.rbegin(); it != mappedArrays.rend(); ++it)
+        {
+            writeUnmaps(*it);
+        }
+        writeLine(node->value ? "return nova_result;" : "return;");
+        indent--;
+        writeLine("}");
+        return;
+    }
+
     writeIndent();
     write("return");
 
@@ -241,32 +385,10 @@ void CodeGenerator::visitReturnStatement(ReturnStatement *node)
 
 void CodeGenerator::visitPrintStatement(PrintStatement *node)
 {
+    prints = true;
     writeIndent();
-
-    if (node->expr->type->kind == TypeKind::INT)
-    {
-        write("printf(\"%d\\n\", ");
-    }
-    else if (node->expr->type->kind == TypeKind::FLOAT)
-    {
-        write("printf(\"%f\\n\", ");
-    }
-    else if (node->expr->type->kind == TypeKind::STRING)
-    {
-        write("printf(\"%s\\n\", ");
-    }
-    else if (node->expr->type->kind == TypeKind::BOOL)
-    {
-        write("printf(\"%s\\n\", ");
-        write("(");
-        node->expr->accept(this);
-        write(") ? \"true\" : \"false\"");
-        writeLine(");");
-        return;
-    }
-
-    node->expr->accept(this);
-    writeLine(");");
+    write(printCall(node->expr->type, "(" + expression(node->expr.get()) + ")"));
+    writeLine(";");
 }
 
 void CodeGenerator::visitExpressionStatement(ExpressionStatement *node)
@@ -283,7 +405,7 @@ void CodeGenerator::visitIntLiteral(IntLiteral *node)
 
 void CodeGenerator::visitFloatLiteral(FloatLiteral *node)
 {
-    write(to_string(node->value));
+    write(formatFloatLiteral(node->value));
 }
 
 void CodeGenerator::visitStringLiteral(StringLiteral *node)
@@ -298,19 +420,45 @@ void CodeGenerator::visitBoolLiteral(BoolLiteral *node)
 
 void CodeGenerator::visitVariable(Variable *node)
 {
-    write(node->name);
+    write(symbolName(node->name));
 }
 
 void CodeGenerator::visitArrayAccess(ArrayAccess *node)
 {
+    if (node->array->type->kind == TypeKind::VECTOR)
+    {
+        auto vectorType = static_pointer_cast<VectorType>(node->array->type);
+        string index = checkedIndex(expression(node->index.get()), vectorType->lanes);
+        write(vectorCall("nova_lane", {expression(node->array.get()), index}, vectorType));
+        return;
+    }
+
     node->array->accept(this);
     write("[");
-    node->index->accept(this);
+    if (boundsCheck)
+    {
+        auto arrayType = static_pointer_cast<ArrayType>(node->array->type);
+        write("nova_bounds_check(");
+        node->index->accept(this);
+        write(", " + to_string(arrayType->size) + ")");
+    }
+    else
+    {
+        node->index->accept(this);
+    }
     write("]");
 }
 
 void CodeGenerator::visitBinaryOp(BinaryOp *node)
 {
+    if (node->op != "=" && (node->left->type->kind == TypeKind::VECTOR || node->right->type->kind == TypeKind::VECTOR))
+    {
+        auto type = node->left->type->kind == TypeKind::VECTOR ? node->left->type : node->right->type;
+        write("(" + vectorOperand(node->left.get(), type) + " " + node->op + " " +
+              vectorOperand(node->right.get(), type) + ")");
+        return;
+    }
+
     write("(");
     node->left->accept(this);
     write(" " + node->op + " ");
@@ -328,7 +476,44 @@ void CodeGenerator::visitUnaryOp(UnaryOp *node)
 
 void CodeGenerator::visitFunctionCall(FunctionCall *node)
 {
-    write(node->name + "(");
+    if (node->builtin)
+    {
+        vector<string> args;
+        for (auto &arg : node->args)
+        {
+            args.push_back(expression(arg.get()));
+        }
+        if (isVectorBuiltin(node->name))
+        {
+            auto type = node->args[node->name == "select" ? 1 : 0]->type;
+            if (node->name == "store")
+                args[2] = checkedIndex(args[2], static_pointer_cast<ArrayType>(node->args[1]->type)->size,
+                                       static_pointer_cast<VectorType>(type)->lanes);
+            write(vectorCall(node->name, args, type));
+            return;
+        }
+        if (isMapBuiltin(node->name))
+        {
+            maps = true;
+            write(mapCall(node->name, args, node->type));
+            return;
+        }
+        if (isInputBuiltin(node->name))
+        {
+            inputs = true;
+            int size = args.empty() ? 0 : static_pointer_cast<ArrayType>(node->args[0]->type)->size;
+            write(inputCall(node->name, args, size));
+            return;
+        }
+        int size = args.size() > 2 ? static_pointer_cast<ArrayType>(node->args[1]->type)->size : 0;
+        if (isAtomicBuiltin(node->name))
+            write(atomicCall(node->name, args, node->memoryOrder));
+        else
+            write(channelCall(node->name, args, node->args[0]->type, size));
+        return;
+    }
+
+    write(symbolName(node->name) + "(");
 
     for (size_t i = 0; i < node->args.size(); ++i)
     {
@@ -338,4 +523,44 @@ void CodeGenerator::visitFunctionCall(FunctionCall *node)
     }
 
     write(")");
-}
\ No newline at end of file
+}
+
+void CodeGenerator::visitSpawnExpression(SpawnExpression *node)
+{
+    if (node->call->type->kind == TypeKind::VOID)
+    {
+        write("(");
+        node->call->accept(this);
+        write(", 0)");
+        return;
+    }
+    node->call->accept(this);
+}
+
+void CodeGenerator::visitAwaitExpression(AwaitExpression *node)
+{
+    if (node->type->kind == TypeKind::VOID)
+        write("(void)");
+    write("(");
+    node->task->accept(this);
+    write(")");
+}
+
+void CodeGenerator::visitChannelExpression(ChannelExpression *node)
+{
+    channels = true;
+    write(channelCall("channel", {expression(node->capacity.get())}, node->type, 0));
+}
+
+void CodeGenerator::visitVectorExpression(VectorExpression *node)
+{
+    vector<string> args;
+    for (auto &arg : node->args)
+    {
+        args.push_back(expression(arg.get()));
+    }
+    if (args.size() == 2)
+        args[1] = checkedIndex(args[1], static_pointer_cast<ArrayType>(node->args[0]->type)->size,
+                               static_pointer_cast<VectorType>(node->type)->lanes);
+    write(vectorCall(getCType(node->type), args, node->type));
+}
@@ -3,7 +3,9 @@
 
 #include "ast.h"
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -11,15 +13,30 @@ class CodeGenerator : public ASTVisitor
 {
 private:
     ostream &output;
+    ostringstream body;
+    ostream *current;
     int indent;
+    bool boundsCheck;
+    bool channels;
+    bool atomics;
+    bool vectors;
+    bool prints;
+    bool inputs;
+    bool maps;
+    shared_ptr<Type> returnType;
+    vector<vector<pair<string, shared_ptr<Type>>>> mappedArrays;
 
     void writeIndent();
     void write(const string &text);
     void writeLine(const string &text);
     string getCType(shared_ptr<Type> type);
+    string expression(Expression *expr);
+    string checkedIndex(const string &index, int size, int lanes = 1);
+    string vectorOperand(Expression *expr, shared_ptr<Type> type);
+    void writeUnmaps(const vector<pair<string, shared_ptr<Type>>> &arrays);
 
 public:
-    CodeGenerator(ostream &output);
+    CodeGenerator(ostream &output, bool boundsCheck = false);
 
     void generate(shared_ptr<Program> program);
 
@@ -43,6 +60,10 @@ public:
     void visitBinaryOp(BinaryOp *node) override;
     void visitUnaryOp(UnaryOp *node) override;
     void visitFunctionCall(FunctionCall *node) override;
+    void visitSpawnExpression(SpawnExpression *node) override;
+    void visitAwaitExpression(AwaitExpression *node) override;
+    void visitChannelExpression(ChannelExpression *node) override;
+    void visitVectorExpression(VectorExpression *node) override;
 };
 
 #endif 
\ No newline at end of file
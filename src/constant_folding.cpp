@@ -0,0 +1,133 @@
+#include "constant_folding.h"
+#include <climits>
+#include <cmath>
+
+using namespace std;
+
+static Instruction *foldInt(IRFunction &function, Opcode op, int a, int b)
+{
+    long long x = a;
+    long long y = b;
+    long long result;
+
+    switch (op)
+    {
+    case Opcode::ADD:
+        result = x + y;
+        break;
+    case Opcode::SUB:
+        result = x - y;
+        break;
+    case Opcode::MUL:
+        result = x * y;
+        break;
+    case Opcode::DIV:
+    case Opcode::REM:
+        if (y == 0 || (x == INT_MIN && y == -1))
+            return nullptr;
+        result = op == Opcode::DIV ? x / y : x % y;
+        break;
+    case Opcode::EQ:
+        return function.constBool(a == b);
+    case Opcode::NE:
+        return function.constBool(a != b);
+    case Opcode::LT:
+        return function.constBool(a < b);
+    case Opcode::LE:
+        return function.constBool(a <= b);
+    case Opcode::GT:
+        return function.constBool(a > b);
+    case Opcode::GE:
+        return function.constBool(a >= b);
+    default:
+        return nullptr;
+    }
+
+    if (result < INT_MIN || result > INT_MAX)
+        return nullptr;
+    return function.constInt(static_cast<int>(result));
+}
+
+static Instruction *foldFloat(IRFunction &function, Opcode op, float a, float b)
+{
+    float result;
+
+    switch (op)
+    {
+    case Opcode::ADD:
+        result = a + b;
+        break;
+    case Opcode::SUB:
+        result = a - b;
+        break;
+    case Opcode::MUL:
+        result = a * b;
+        break;
+    case Opcode::DIV:
+        if (b == 0.0f)
+            return nullptr;
+        result = a / b;
+        break;
+    case Opcode::EQ:
+        return function.constBool(a == b);
+    case Opcode::NE:
+        return function.constBool(a != b);
+    case Opcode::LT:
+        return function.constBool(a < b);
+    case Opcode::LE:
+        return function.constBool(a <= b);
+    case Opcode::GT:
+        return function.constBool(a > b);
+    case Opcode::GE:
+        return function.constBool(a >= b);
+    default:
+        return nullptr;
+    }
+
+    if (!std::isfinite(result))
+        return nullptr;
+    return function.constFloat(result);
+}
+
+Instruction *foldConstant(IRFunction &function, Opcode op, shared_ptr<Type> type,
+                          const vector<Instruction *> &operands)
+{
+    for (auto operand : operands)
+    {
+        if (!operand || !operand->isConstant())
+            return nullptr;
+    }
+
+    switch (op)
+    {
+    case Opcode::NEG:
+        if (type->kind == TypeKind::INT)
+            return operands[0]->intValue == INT_MIN ? nullptr : function.constInt(-operands[0]->intValue);
+        if (type->kind == TypeKind::FLOAT)
+            return function.constFloat(-operands[0]->floatValue);
+        return nullptr;
+    case Opcode::NOT:
+        return function.constBool(!operands[0]->intValue);
+    case Opcode::ITOF:
+        return function.constFloat(static_cast<float>(operands[0]->intValue));
+    default:
+        break;
+    }
+
+    if (operands.size() != 2)
+        return nullptr;
+
+    switch (operands[0]->type->kind)
+    {
+    case TypeKind::INT:
+        return foldInt(function, op, operands[0]->intValue, operands[1]->intValue);
+    case TypeKind::FLOAT:
+        return foldFloat(function, op, operands[0]->floatValue, operands[1]->floatValue);
+    case TypeKind::BOOL:
+        if (op == Opcode::EQ || op == Opcode::NE)
+            return foldInt(function, op, operands[0]->intValue, operands[1]->intValue);
+        return nullptr;
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,12 @@
+#ifndef CONSTANT_FOLDING_H
+#define CONSTANT_FOLDING_H
+
+#include <vector>
+#include "ir.h"
+
+using namespace std;
+
+Instruction *foldConstant(IRFunction &function, Opcode op, shared_ptr<Type> type,
+                          const vector<Instruction *> &operands);
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include "cfg.h"
+
+using namespace std;
+
+enum class DataflowDirection
+{
+    FORWARD,
+    BACKWARD
+};
+
+template <typename T>
+class DataflowAnalysis
+{
+public:
+    unordered_map<BasicBlock *, T> in;
+    unordered_map<BasicBlock *, T> out;
+
+    virtual ~DataflowAnalysis() = default;
+
+    virtual DataflowDirection direction() const = 0;
+    virtual T boundary(BasicBlock *block) = 0;
+    virtual T initial(BasicBlock *block) = 0;
+    virtual T meet(const T &a, const T &b) = 0;
+    virtual T transfer(BasicBlock *block, const T &input) = 0;
+
+    void run(IRFunction &function)
+    {
+        in.clear();
+        out.clear();
+
+        vector<BasicBlock *> order = reversePostOrder(function);
+        bool forward = direction() == DataflowDirection::FORWARD;
+        if (!forward)
+        {
+            reverse(order.begin(), order.end());
+        }
+
+        unordered_map<BasicBlock *, vector<BasicBlock *>> preds;
+        for (auto block : order)
+        {
+            for (auto succ : block->successors())
+            {
+                preds[succ].push_back(block);
+            }
+        }
+
+        for (auto block : order)
+        {
+            in[block] = initial(block);
+            out[block] = initial(block);
+        }
+
+        deque<BasicBlock *> worklist(order.begin(), order.end());
+        unordered_set<BasicBlock *> queued(order.begin(), order.end());
+
+        while (!worklist.empty())
+        {
+            BasicBlock *block = worklist.front();
+            worklist.pop_front();
+            queued.erase(block);
+
+            vector<BasicBlock *> sources = forward ? preds[block] : block->successors();
+            T input = sources.empty() ? boundary(block) : (forward ? out[sources[0]] : in[sources[0]]);
+            for (size_t i = 1; i < sources.size(); ++i)
+            {
+                input = meet(input, forward ? out[sources[i]] : in[sources[i]]);
+            }
+
+            T output = transfer(block, input);
+            if (forward)
+            {
+                in[block] = input;
+            }
+            else
+            {
+                out[block] = input;
+            }
+
+            T &stored = forward ? out[block] : in[block];
+            if (output == stored)
+                continue;
+            stored = output;
+
+            vector<BasicBlock *> targets = forward ? block->successors() : preds[block];
+            for (auto target : targets)
+            {
+                if (queued.insert(target).second)
+                {
+                    worklist.push_back(target);
+                }
+            }
+        }
+    }
+};
+
+#endif
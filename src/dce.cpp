@@ -0,0 +1,267 @@
+#include "dce.h"
+#include "call_graph.h"
+#include "simplify_cfg.h"
+
+using namespace std;
+
+LiveMemoryAnalysis::LiveMemoryAnalysis(const IRFunction &function, const PurityAnalysis &purity)
+    : function(function), purity(purity)
+{
+    for (auto &global : function.module->globals)
+    {
+        allGlobals.insert(global->name);
+    }
+}
+
+LiveMemory LiveMemoryAnalysis::boundary(BasicBlock *)
+{
+    LiveMemory live;
+    if (!function.isMain())
+        live.globals = allGlobals;
+    return live;
+}
+
+LiveMemory LiveMemoryAnalysis::initial(BasicBlock *)
+{
+    return LiveMemory();
+}
+
+LiveMemory LiveMemoryAnalysis::meet(const LiveMemory &a, const LiveMemory &b)
+{
+    LiveMemory result = a;
+    result.arrays.insert(b.arrays.begin(), b.arrays.end());
+    result.globals.insert(b.globals.begin(), b.globals.end());
+    return result;
+}
+
+LiveMemory LiveMemoryAnalysis::transfer(BasicBlock *block, const LiveMemory &input)
+{
+    LiveMemory live = input;
+    for (auto it = block->instructions.rbegin(); it != block->instructions.rend(); ++it)
+    {
+        step(it->get(), live);
+    }
+    return live;
+}
+
+// A checked store still has to fail on a bad index, so it is never dead.
+bool LiveMemoryAnalysis::isDeadStore(const Instruction *instr, const LiveMemory &live) const
+{
+    if (instr->checked)
+        return false;
+    if (instr->op == Opcode::STORE_GLOBAL)
+        return !live.globals.count(instr->text);
+    if (instr->op != Opcode::STORE)
+        return false;
+
+    Instruction *base = instr->operands[0];
+    if (isLocalArray(base))
+        return !live.arrays.count(base);
+    if (base->op == Opcode::GLOBAL)
+        return !live.globals.count(base->text);
+    return false;
+}
+
+void LiveMemoryAnalysis::step(const Instruction *instr, LiveMemory &live)
+{
+    switch (instr->op)
+    {
+    case Opcode::LOAD:
+    {
+        Instruction *base = instr->operands[0];
+        if (isLocalArray(base))
+            live.arrays.insert(base);
+        else if (base->op == Opcode::GLOBAL)
+            live.globals.insert(base->text);
+        else
+            live.globals.insert(allGlobals.begin(), allGlobals.end());
+        break;
+    }
+    case Opcode::LOAD_GLOBAL:
+        live.globals.insert(instr->text);
+        break;
+    case Opcode::STORE_GLOBAL:
+        live.globals.erase(instr->text);
+        break;
+    case Opcode::CALL:
+    {
+        IRFunction *callee = function.module->getFunction(instr->text);
+        if (!callee || purity.effectsOf(callee).readsMemory)
+            live.globals.insert(allGlobals.begin(), allGlobals.end());
+        for (auto operand : instr->operands)
+        {
+            if (isLocalArray(operand))
+                live.arrays.insert(operand);
+            else if (operand->op == Opcode::GLOBAL)
+                live.globals.insert(operand->text);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+bool DeadCodeElimination::isRemovableCall(const Instruction *call)
+{
+    IRFunction *callee = call->function->module->getFunction(call->text);
+    if (!callee)
+        return false;
+    FunctionEffects effects = purity->effectsOf(callee);
+    return !effects.writesMemory && !effects.performsIO;
+}
+
+int DeadCodeElimination::removeDeadStores(IRFunction &function)
+{
+    LiveMemoryAnalysis analysis(function, *purity);
+    analysis.run(function);
+
+    vector<Instruction *> dead;
+    for (auto &block : function.blocks)
+    {
+        LiveMemory live = analysis.out[block.get()];
+        for (auto it = block->instructions.rbegin(); it != block->instructions.rend(); ++it)
+        {
+            Instruction *instr = it->get();
+            if (analysis.isDeadStore(instr, live))
+                dead.push_back(instr);
+            analysis.step(instr, live);
+        }
+    }
+
+    for (auto instr : dead)
+    {
+        instr->parent->erase(instr);
+    }
+    return dead.size();
+}
+
+int DeadCodeElimination::removeDeadInstructions(IRFunction &function)
+{
+    unordered_set<Instruction *> live;
+    vector<Instruction *> worklist;
+    for (auto &block : function.blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (!instr->checked &&
+                (!instr->hasSideEffects() || (instr->op == Opcode::CALL && isRemovableCall(instr.get()))))
+                continue;
+            live.insert(instr.get());
+            worklist.push_back(instr.get());
+        }
+    }
+
+    while (!worklist.empty())
+    {
+        Instruction *instr = worklist.back();
+        worklist.pop_back();
+        for (auto operand : instr->operands)
+        {
+            if (operand->parent && live.insert(operand).second)
+                worklist.push_back(operand);
+        }
+    }
+
+    vector<Instruction *> dead;
+    for (auto &block : function.blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (!live.count(instr.get()))
+                dead.push_back(instr.get());
+        }
+    }
+
+    for (auto instr : dead)
+    {
+        instr->dropOperands();
+    }
+    for (auto instr : dead)
+    {
+        instr->parent->erase(instr);
+    }
+    return dead.size();
+}
+
+bool DeadCodeElimination::runOnFunction(IRFunction &function)
+{
+    function.recomputePredecessors();
+    bool changed = removeUnreachableBlocks(function);
+
+    int removed = removeDeadStores(function);
+    removed += removeDeadInstructions(function);
+
+    if (removed > 0)
+        statistics.push_back({function.name, removed});
+    return changed || removed > 0;
+}
+
+bool DeadCodeElimination::runOnModule(IRModule &module)
+{
+    PurityAnalysis analysis(module);
+    purity = &analysis;
+    statistics.clear();
+
+    bool changed = false;
+    for (auto &function : module.functions)
+    {
+        changed = runOnFunction(*function) || changed;
+    }
+
+    purity = nullptr;
+    return changed;
+}
+
+void DeadCodeElimination::printStatistics(ostream &out) const
+{
+    for (auto &entry : statistics)
+    {
+        out << "dce: " << entry.first << ": " << entry.second << " dead instruction"
+            << (entry.second == 1 ? "" : "s") << " removed" << endl;
+    }
+}
+
+bool GlobalDCE::runOnModule(IRModule &module)
+{
+    removed.clear();
+    IRFunction *main = module.getFunction("main");
+    if (!main)
+        return false;
+
+    CallGraph graph(module);
+    unordered_set<IRFunction *> reachable{main};
+    vector<IRFunction *> worklist{main};
+    while (!worklist.empty())
+    {
+        IRFunction *function = worklist.back();
+        worklist.pop_back();
+        for (auto callee : graph.callees(function))
+        {
+            if (reachable.insert(callee).second)
+                worklist.push_back(callee);
+        }
+    }
+
+    vector<IRFunction *> dead;
+    for (auto &function : module.functions)
+    {
+        if (!reachable.count(function.get()))
+            dead.push_back(function.get());
+    }
+
+    for (auto function : dead)
+    {
+        removed.push_back(function->name);
+        module.removeFunction(function);
+    }
+    return !dead.empty();
+}
+
+void GlobalDCE::printStatistics(ostream &out) const
+{
+    for (auto &name : removed)
+    {
+        out << "globaldce: removed unreachable function '" << name << "'" << endl;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef DCE_H
+#define DCE_H
+
+#include "dataflow.h"
+#include "pass_manager.h"
+#include "purity.h"
+
+using namespace std;
+
+struct LiveMemory
+{
+    set<Instruction *> arrays;
+    set<string> globals;
+
+    bool operator==(const LiveMemory &other) const
+    {
+        return arrays == other.arrays && globals == other.globals;
+    }
+};
+
+class LiveMemoryAnalysis : public DataflowAnalysis<LiveMemory>
+{
+private:
+    const IRFunction &function;
+    const PurityAnalysis &purity;
+    set<string> allGlobals;
+
+public:
+    LiveMemoryAnalysis(const IRFunction &function, const PurityAnalysis &purity);
+
+    DataflowDirection direction() const override { return DataflowDirection::BACKWARD; }
+    LiveMemory boundary(BasicBlock *block) override;
+    LiveMemory initial(BasicBlock *block) override;
+    LiveMemory meet(const LiveMemory &a, const LiveMemory &b) override;
+    LiveMemory transfer(BasicBlock *block, const LiveMemory &input) override;
+
+    bool isDeadStore(const Instruction *instr, const LiveMemory &live) const;
+    void step(const Instruction *instr, LiveMemory &live);
+};
+
+class DeadCodeElimination : public Pass
+{
+private:
+    PurityAnalysis *purity;
+    vector<pair<string, int>> statistics;
+
+    bool isRemovableCall(const Instruction *call);
+    int removeDeadStores(IRFunction &function);
+    int removeDeadInstructions(IRFunction &function);
+    bool runOnFunction(IRFunction &function);
+
+public:
+    DeadCodeElimination() : purity(nullptr) {}
+
+    string name() const override { return "dce"; }
+    bool runOnModule(IRModule &module) override;
+    void printStatistics(ostream &out) const override;
+};
+
+class GlobalDCE : public Pass
+{
+private:
+    vector<string> removed;
+
+public:
+    string name() const override { return "globaldce"; }
+    bool runOnModule(IRModule &module) override;
+    void printStatistics(ostream &out) const override;
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "function_attrs.h"
+#include <set>
+#include <unordered_map>
+#include "map_runtime.h"
+#include "purity.h"
+
+using namespace std;
+
+bool FunctionAttrs::runOnModule(IRModule &module)
+{
+    PurityAnalysis analysis(module);
+    bool changed = false;
+
+    for (auto &function : module.functions)
+    {
+        Purity purity = Purity::IMPURE;
+        FunctionEffects effects = analysis.effectsOf(function.get());
+        if (!function->isMain() && !function->memoize && function->returnType->kind != TypeKind::VOID &&
+            !effects.writesMemory && !effects.performsIO)
+        {
+            purity = effects.readsMemory ? Purity::PURE : Purity::CONST;
+        }
+
+        changed = changed || function->purity != purity;
+        function->purity = purity;
+    }
+    return inferNoalias(module) || changed;
+}
+
+// The arrays an array value may be: locals and globals stand for themselves and a parameter for whatever its
+// callers pass. A null entry is an array that cannot be identified.
+typedef set<const void *> ArraySet;
+
+static bool disjoint(const ArraySet &a, const ArraySet &b)
+{
+    for (auto array : a)
+    {
+        if (!array || b.count(array) || b.count(nullptr))
+            return false;
+    }
+    return true;
+}
+
+// An array parameter is noalias when, at every call, no other array argument is the same array and the array is
+// not a global that the function or its callees access by name. The emitter declares such parameters restrict.
+bool FunctionAttrs::inferNoalias(IRModule &module)
+{
+    unordered_map<const IRFunction *, vector<Instruction *>> callSites;
+    unordered_map<const IRFunction *, set<IRFunction *>> callees;
+    unordered_map<const IRFunction *, ArraySet> globals;
+    for (auto &function : module.functions)
+    {
+        for (auto &block : function->blocks)
+        {
+            for (auto &instr : block->instructions)
+            {
+                for (auto operand : instr->operands)
+                {
+                    if (operand->op == Opcode::GLOBAL)
+                        globals[function.get()].insert(module.getGlobal(operand->text));
+                }
+                IRFunction *callee = instr->op == Opcode::CALL ? module.getFunction(instr->text) : nullptr;
+                if (callee)
+                {
+                    callSites[callee].push_back(instr.get());
+                    callees[function.get()].insert(callee);
+                }
+            }
+        }
+    }
+
+    unordered_map<const Instruction *, ArraySet> params;
+    auto arraysOf = [&](const Instruction *value) -> ArraySet
+    {
+        if (value->op == Opcode::ARRAY || (value->op == Opcode::CALL && isMapBuiltin(value->text)))
+            return {value};
+        if (value->op == Opcode::GLOBAL)
+            return {module.getGlobal(value->text)};
+        auto it = params.find(value);
+        return it != params.end() ? it->second : ArraySet{nullptr};
+    };
+    for (auto &function : module.functions)
+    {
+        for (auto &param : function->params)
+        {
+            if (param->type->kind == TypeKind::ARRAY && callSites[function.get()].empty())
+                params[param.get()] = {nullptr};
+            else if (param->type->kind == TypeKind::ARRAY)
+                params[param.get()] = {};
+        }
+    }
+
+    bool progress = true;
+    while (progress)
+    {
+        progress = false;
+        for (auto &function : module.functions)
+        {
+            for (auto call : callSites[function.get()])
+            {
+                for (size_t i = 0; i < function->params.size(); ++i)
+                {
+                    auto it = params.find(function->params[i].get());
+                    if (it == params.end())
+                        continue;
+                    for (auto array : arraysOf(call->operands[i]))
+                    {
+                        progress = it->second.insert(array).second || progress;
+                    }
+                }
+            }
+            for (auto callee : callees[function.get()])
+            {
+                for (auto global : globals[callee])
+                {
+                    progress = globals[function.get()].insert(global).second || progress;
+                }
+            }
+        }
+    }
+
+    bool changed = false;
+    for (auto &function : module.functions)
+    {
+        for (size_t i = 0; i < function->params.size(); ++i)
+        {
+            Instruction *param = function->params[i].get();
+            if (param->noalias || !params.count(param) ||
+                static_pointer_cast<ArrayType>(param->type)->elementType->kind == TypeKind::ATOMIC ||
+                !disjoint(params[param], globals[function.get()]))
+                continue;
+
+            bool noalias = true;
+            for (auto call : callSites[function.get()])
+            {
+                for (size_t j = 0; j < function->params.size() && noalias; ++j)
+                {
+                    if (j != i && params.count(function->params[j].get()))
+                        noalias = disjoint(arraysOf(call->operands[i]), arraysOf(call->operands[j]));
+                }
+            }
+            param->noalias = noalias;
+            changed = changed || noalias;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,18 @@
+#ifndef FUNCTION_ATTRS_H
+#define FUNCTION_ATTRS_H
+
+#include "pass_manager.h"
+
+using namespace std;
+
+class FunctionAttrs : public Pass
+{
+private:
+    bool inferNoalias(IRModule &module);
+
+public:
+    string name() const override { return "function-attrs"; }
+    bool runOnModule(IRModule &module) override;
+};
+
+#endif
@@ -0,0 +1,279 @@
+#include "gvn.h"
+#include "alias_analysis.h"
+
+using namespace std;
+
+bool ExpressionKey::operator<(const ExpressionKey &other) const
+{
+    if (op != other.op)
+        return op < other.op;
+    if (kind != other.kind)
+        return kind < other.kind;
+    if (operands != other.operands)
+        return operands < other.operands;
+    if (blocks != other.blocks)
+        return blocks < other.blocks;
+    return text < other.text;
+}
+
+static bool isCommutative(Opcode op)
+{
+    return op == Opcode::ADD || op == Opcode::MUL || op == Opcode::EQ || op == Opcode::NE;
+}
+
+bool GVN::isPureCall(const Instruction *call)
+{
+    IRFunction *callee = call->function->module->getFunction(call->text);
+    return callee && !call->spawn && purity->isPure(callee);
+}
+
+bool GVN::isReadOnlyCall(const Instruction *call)
+{
+    IRFunction *callee = call->function->module->getFunction(call->text);
+    if (!callee || call->spawn)
+        return false;
+    FunctionEffects effects = purity->effectsOf(callee);
+    return !effects.writesMemory && !effects.performsIO;
+}
+
+bool GVN::canNumber(const Instruction *instr)
+{
+    switch (instr->op)
+    {
+    case Opcode::NEG:
+    case Opcode::NOT:
+    case Opcode::ITOF:
+    case Opcode::PHI:
+        return true;
+    case Opcode::CALL:
+        return instr->type->kind != TypeKind::VOID && isPureCall(instr);
+    default:
+        return instr->isBinary();
+    }
+}
+
+ExpressionKey GVN::keyFor(const Instruction *instr)
+{
+    ExpressionKey key{instr->op, instr->type->kind, instr->operands, {}, instr->text};
+    if (instr->op == Opcode::PHI)
+        key.blocks = instr->blocks;
+    if (isCommutative(instr->op) && key.operands[1] < key.operands[0])
+        swap(key.operands[0], key.operands[1]);
+    return key;
+}
+
+Instruction *GVN::availableMemory(const vector<Instruction *> &memory, const Instruction *access)
+{
+    for (auto it = memory.rbegin(); it != memory.rend(); ++it)
+    {
+        Instruction *entry = *it;
+        switch (access->op)
+        {
+        case Opcode::LOAD:
+            if ((entry->op == Opcode::LOAD || entry->op == Opcode::STORE) &&
+                aliasAccesses(entry, access) == AliasResult::MUST_ALIAS)
+                return entry->op == Opcode::STORE ? entry->operands[2] : entry;
+            break;
+        case Opcode::LOAD_GLOBAL:
+            if ((entry->op == Opcode::LOAD_GLOBAL || entry->op == Opcode::STORE_GLOBAL) && entry->text == access->text)
+                return entry->op == Opcode::STORE_GLOBAL ? entry->operands[0] : entry;
+            break;
+        case Opcode::CALL:
+            if (entry->op == Opcode::CALL && entry->text == access->text && entry->operands == access->operands)
+                return entry;
+            break;
+        default:
+            break;
+        }
+    }
+    return nullptr;
+}
+
+void GVN::clobber(vector<Instruction *> &memory, const Instruction *writer)
+{
+    vector<Instruction *> kept;
+    for (auto entry : memory)
+    {
+        bool killed;
+        if (entry->op == Opcode::CALL)
+            killed = true;
+        else if (writer->op == Opcode::STORE)
+            killed = (entry->op == Opcode::LOAD || entry->op == Opcode::STORE) &&
+                     aliasAccesses(entry, writer) != AliasResult::NO_ALIAS;
+        else if (writer->op == Opcode::STORE_GLOBAL)
+            killed = (entry->op == Opcode::LOAD_GLOBAL || entry->op == Opcode::STORE_GLOBAL) &&
+                     entry->text == writer->text;
+        else
+            killed = entry->op == Opcode::STORE || mayClobber(writer, entry, *purity);
+
+        if (!killed)
+            kept.push_back(entry);
+    }
+    memory = kept;
+}
+
+void GVN::replace(Instruction *instr, Instruction *value)
+{
+    instr->replaceAllUsesWith(value);
+    instr->parent->erase(instr);
+    ++eliminated;
+}
+
+void GVN::numberBlock(BasicBlock *block, vector<Instruction *> &memory)
+{
+    vector<Instruction *> instrs;
+    for (auto &instr : block->instructions)
+    {
+        instrs.push_back(instr.get());
+    }
+
+    for (auto instr : instrs)
+    {
+        if (canNumber(instr))
+        {
+            ExpressionKey key = keyFor(instr);
+            auto it = expressions.find(key);
+            if (it != expressions.end())
+            {
+                replace(instr, it->second);
+                continue;
+            }
+            expressions[key] = instr;
+            undoLog.push_back({key, instr});
+            continue;
+        }
+
+        switch (instr->op)
+        {
+        case Opcode::LOAD:
+        case Opcode::LOAD_GLOBAL:
+            if (Instruction *value = availableMemory(memory, instr))
+            {
+                if (value->type->kind == instr->type->kind)
+                {
+                    replace(instr, value);
+                    continue;
+                }
+            }
+            memory.push_back(instr);
+            break;
+        case Opcode::CALL:
+            if (isReadOnlyCall(instr))
+            {
+                if (instr->type->kind != TypeKind::VOID)
+                {
+                    if (Instruction *value = availableMemory(memory, instr))
+                    {
+                        replace(instr, value);
+                        continue;
+                    }
+                    memory.push_back(instr);
+                }
+                break;
+            }
+            clobber(memory, instr);
+            break;
+        case Opcode::AWAIT:
+            clobber(memory, instr);
+            break;
+        case Opcode::STORE:
+        case Opcode::STORE_GLOBAL:
+            clobber(memory, instr);
+            memory.push_back(instr);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Walks the dominator tree with an explicit stack, since its depth grows with the number of blocks. An entry
+// without a block marks where its block's subtree ends and the expressions it numbered go out of scope.
+void GVN::visit(BasicBlock *entry)
+{
+    struct Frame
+    {
+        BasicBlock *block;
+        vector<Instruction *> memory;
+        size_t scope;
+    };
+    vector<Frame> stack;
+    stack.push_back({entry, {}, 0});
+    while (!stack.empty())
+    {
+        Frame frame = move(stack.back());
+        stack.pop_back();
+        if (!frame.block)
+        {
+            while (undoLog.size() > frame.scope)
+            {
+                expressions.erase(undoLog.back().first);
+                undoLog.pop_back();
+            }
+            continue;
+        }
+
+        stack.push_back({nullptr, {}, undoLog.size()});
+        numberBlock(frame.block, frame.memory);
+
+        // Children entered only from this block start from its memory state; the last of them takes it over.
+        const auto &children = dominators->childrenOf(frame.block);
+        int inheriting = 0;
+        for (auto child : children)
+        {
+            inheriting += child->preds.size() == 1 && child->preds[0] == frame.block;
+        }
+        for (auto child : children)
+        {
+            if (child->preds.size() != 1 || child->preds[0] != frame.block)
+                stack.push_back({child, {}, 0});
+            else if (--inheriting > 0)
+                stack.push_back({child, frame.memory, 0});
+            else
+                stack.push_back({child, move(frame.memory), 0});
+        }
+    }
+}
+
+
+bool GVN::runOnFunction(IRFunction &function)
+{
+    function.recomputePredecessors();
+    DominatorTree tree(function);
+    dominators = &tree;
+    expressions.clear();
+    undoLog.clear();
+    eliminated = 0;
+
+    visit(function.entry());
+
+    dominators = nullptr;
+    if (eliminated > 0)
+        statistics.push_back({function.name, eliminated});
+    return eliminated > 0;
+}
+
+bool GVN::runOnModule(IRModule &module)
+{
+    PurityAnalysis analysis(module);
+    purity = &analysis;
+    statistics.clear();
+
+    bool changed = false;
+    for (auto &function : module.functions)
+    {
+        changed = runOnFunction(*function) || changed;
+    }
+
+    purity = nullptr;
+    return changed;
+}
+
+void GVN::printStatistics(ostream &out) const
+{
+    for (auto &entry : statistics)
+    {
+        out << "gvn: " << entry.first << ": " << entry.second << " redundant expression"
+            << (entry.second == 1 ? "" : "s") << " eliminated" << endl;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef GVN_H
+#define GVN_H
+
+#include <map>
+#include "cfg.h"
+#include "pass_manager.h"
+#include "purity.h"
+
+using namespace std;
+
+struct ExpressionKey
+{
+    Opcode op;
+    TypeKind kind;
+    vector<Instruction *> operands;
+    vector<BasicBlock *> blocks;
+    string text;
+
+    bool operator<(const ExpressionKey &other) const;
+};
+
+class GVN : public Pass
+{
+private:
+    PurityAnalysis *purity;
+    DominatorTree *dominators;
+    map<ExpressionKey, Instruction *> expressions;
+    vector<pair<ExpressionKey, Instruction *>> undoLog;
+    vector<pair<string, int>> statistics;
+    int eliminated;
+
+    bool isPureCall(const Instruction *call);
+    bool isReadOnlyCall(const Instruction *call);
+    bool canNumber(const Instruction *instr);
+    ExpressionKey keyFor(const Instruction *instr);
+    Instruction *availableMemory(const vector<Instruction *> &memory, const Instruction *access);
+    void clobber(vector<Instruction *> &memory, const Instruction *writer);
+    void replace(Instruction *instr, Instruction *value);
+    void numberBlock(BasicBlock *block, vector<Instruction *> &memory);
+    void visit(BasicBlock *entry);
+    bool runOnFunction(IRFunction &function);
+
+public:
+    GVN() : purity(nullptr), dominators(nullptr), eliminated(0) {}
+
+    string name() const override { return "gvn"; }
+    bool runOnModule(IRModule &module) override;
+    void printStatistics(ostream &out) const override;
+};
+
+#endif
@@ -0,0 +1,176 @@
+#include "induction.h"
+#include <climits>
+
+using namespace std;
+
+InductionAnalysis::InductionAnalysis(Loop *loop) : loop(loop)
+{
+    BasicBlock *preheader = loop->preheader();
+    if (!preheader || loop->latches.size() != 1)
+        return;
+    BasicBlock *latch = loop->latches[0];
+
+    for (auto phi : loop->header->phis())
+    {
+        if (phi->type->kind != TypeKind::INT || phi->operands.size() != 2)
+            continue;
+
+        Instruction *start = phi->incomingFor(preheader);
+        Instruction *next = phi->incomingFor(latch);
+        if (!start || !next || next->operands.size() != 2)
+            continue;
+
+        Instruction *lhs = next->operands[0];
+        Instruction *rhs = next->operands[1];
+        int step = 0;
+        if (next->op == Opcode::ADD && lhs == phi && rhs->isConstant())
+            step = rhs->intValue;
+        else if (next->op == Opcode::ADD && rhs == phi && lhs->isConstant())
+            step = lhs->intValue;
+        else if (next->op == Opcode::SUB && lhs == phi && rhs->isConstant() && rhs->intValue != INT_MIN)
+            step = -rhs->intValue;
+
+        if (step != 0)
+            variables.push_back({phi, start, next, step});
+    }
+}
+
+const InductionVariable *InductionAnalysis::variableFor(const Instruction *phi) const
+{
+    for (auto &variable : variables)
+    {
+        if (variable.phi == phi)
+            return &variable;
+    }
+    return nullptr;
+}
+
+const InductionVariable *InductionAnalysis::affineOffset(const Instruction *value, int &offset) const
+{
+    offset = 0;
+    if (auto variable = variableFor(value))
+        return variable;
+    if (value->operands.size() != 2)
+        return nullptr;
+
+    const Instruction *lhs = value->operands[0];
+    const Instruction *rhs = value->operands[1];
+    if (value->op == Opcode::ADD && rhs->isConstant())
+        offset = rhs->intValue;
+    else if (value->op == Opcode::ADD && lhs->isConstant())
+    {
+        offset = lhs->intValue;
+        swap(lhs, rhs);
+    }
+    else if (value->op == Opcode::SUB && rhs->isConstant() && rhs->intValue != INT_MIN)
+        offset = -rhs->intValue;
+    else
+        return nullptr;
+
+    return variableFor(lhs);
+}
+
+Opcode swapPredicate(Opcode op)
+{
+    switch (op)
+    {
+    case Opcode::LT:
+        return Opcode::GT;
+    case Opcode::LE:
+        return Opcode::GE;
+    case Opcode::GT:
+        return Opcode::LT;
+    case Opcode::GE:
+        return Opcode::LE;
+    default:
+        return op;
+    }
+}
+
+Opcode invertPredicate(Opcode op)
+{
+    switch (op)
+    {
+    case Opcode::LT:
+        return Opcode::GE;
+    case Opcode::LE:
+        return Opcode::GT;
+    case Opcode::GT:
+        return Opcode::LE;
+    case Opcode::GE:
+        return Opcode::LT;
+    case Opcode::EQ:
+        return Opcode::NE;
+    default:
+        return Opcode::EQ;
+    }
+}
+
+ExitCondition InductionAnalysis::exitCondition() const
+{
+    ExitCondition result;
+    if (!loop->headerExit())
+        return result;
+
+    Instruction *term = loop->header->terminator();
+    if (term->op != Opcode::CONDBR || !term->operands[0]->isComparison())
+        return result;
+
+    Instruction *cond = term->operands[0];
+    Opcode predicate = cond->op;
+    const InductionVariable *variable = variableFor(cond->operands[0]);
+    Instruction *bound = cond->operands[1];
+    if (!variable)
+    {
+        variable = variableFor(cond->operands[1]);
+        bound = cond->operands[0];
+        predicate = swapPredicate(predicate);
+    }
+    if (!loop->contains(term->blocks[0]))
+        predicate = invertPredicate(predicate);
+
+    if (variable)
+    {
+        result.variable = variable;
+        result.predicate = predicate;
+        result.bound = bound;
+    }
+    return result;
+}
+
+TripCount InductionAnalysis::tripCount() const
+{
+    TripCount result;
+    ExitCondition condition = exitCondition();
+    const InductionVariable *variable = condition.variable;
+    if (!variable || !variable->start->isConstant() || !condition.bound->isConstant())
+        return result;
+
+    Opcode predicate = condition.predicate;
+    long long start = variable->start->intValue;
+    long long limit = condition.bound->intValue;
+    long long step = variable->step;
+    long long count;
+
+    if (step > 0 && predicate == Opcode::LT)
+        count = start < limit ? (limit - start + step - 1) / step : 0;
+    else if (step > 0 && predicate == Opcode::LE)
+        count = start <= limit ? (limit - start) / step + 1 : 0;
+    else if (step < 0 && predicate == Opcode::GT)
+        count = start > limit ? (start - limit - step - 1) / -step : 0;
+    else if (step < 0 && predicate == Opcode::GE)
+        count = start >= limit ? (start - limit) / -step + 1 : 0;
+    else if (predicate == Opcode::NE && (limit - start) % step == 0 && (limit - start) / step >= 0)
+        count = (limit - start) / step;
+    else
+        return result;
+
+    long long last = start + count * step;
+    if (last < INT_MIN || last > INT_MAX)
+        return result;
+
+    result.known = true;
+    result.count = count;
+    result.variable = variable;
+    return result;
+}
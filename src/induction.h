@@ -0,0 +1,49 @@
+#ifndef INDUCTION_H
+#define INDUCTION_H
+
+#include "loop_info.h"
+
+using namespace std;
+
+struct InductionVariable
+{
+    Instruction *phi;
+    Instruction *start;
+    Instruction *next;
+    int step;
+};
+
+struct ExitCondition
+{
+    const InductionVariable *variable = nullptr;
+    Opcode predicate = Opcode::LT;
+    Instruction *bound = nullptr;
+};
+
+struct TripCount
+{
+    bool known = false;
+    long long count = 0;
+    const InductionVariable *variable = nullptr;
+};
+
+class InductionAnalysis
+{
+private:
+    Loop *loop;
+    vector<InductionVariable> variables;
+
+public:
+    InductionAnalysis(Loop *loop);
+
+    const vector<InductionVariable> &inductionVariables() const { return variables; }
+    const InductionVariable *variableFor(const Instruction *phi) const;
+    const InductionVariable *affineOffset(const Instruction *value, int &offset) const;
+    ExitCondition exitCondition() const;
+    TripCount tripCount() const;
+};
+
+Opcode swapPredicate(Opcode op);
+Opcode invertPredicate(Opcode op);
+
+#endif
@@ -0,0 +1,160 @@
+#include "inliner.h"
+#include "cloning.h"
+
+using namespace std;
+
+int functionSize(const IRFunction &function)
+{
+    int size = 0;
+    for (auto &block : function.blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (instr->op != Opcode::PHI && instr->op != Opcode::BR)
+                ++size;
+        }
+    }
+    return size;
+}
+
+bool Inliner::shouldInline(CallGraph &graph, IRFunction *caller, IRFunction *callee)
+{
+    if (!callee || callee == caller || callee->isMain() || callee->memoize || graph.isRecursive(callee))
+        return false;
+    if (depth[callee] + 1 > maxDepth)
+        return false;
+    return functionSize(*callee) <= threshold;
+}
+
+void Inliner::inlineCall(Instruction *call, IRFunction *callee)
+{
+    BasicBlock *block = call->parent;
+    IRFunction &caller = *block->parent;
+
+    BasicBlock *cont = caller.createBlock();
+    auto position = block->instructions.begin();
+    while (position->get() != call)
+    {
+        ++position;
+    }
+    cont->instructions.splice(cont->instructions.end(), block->instructions, next(position),
+                              block->instructions.end());
+    for (auto &instr : cont->instructions)
+    {
+        instr->parent = cont;
+    }
+    for (auto succ : cont->successors())
+    {
+        for (auto phi : succ->phis())
+        {
+            for (auto &incoming : phi->blocks)
+            {
+                if (incoming == block)
+                    incoming = cont;
+            }
+        }
+    }
+
+    ValueMap values;
+    BlockMap blockMap;
+    for (size_t i = 0; i < callee->params.size(); ++i)
+    {
+        values[callee->params[i].get()] = call->operands[i];
+    }
+    cloneBlocks(*callee, caller, values, blockMap);
+
+    BasicBlock *entry = caller.entry();
+    Instruction *arrayPosition = nullptr;
+    for (auto &instr : entry->instructions)
+    {
+        if (instr->op != Opcode::ARRAY)
+        {
+            arrayPosition = instr.get();
+            break;
+        }
+    }
+
+    vector<pair<Instruction *, BasicBlock *>> returns;
+    for (auto &source : callee->blocks)
+    {
+        BasicBlock *copy = blockMap[source.get()];
+
+        vector<Instruction *> arrays;
+        for (auto &instr : copy->instructions)
+        {
+            if (instr->op == Opcode::ARRAY)
+                arrays.push_back(instr.get());
+        }
+        for (auto array : arrays)
+        {
+            entry->insertBefore(arrayPosition, copy->detach(array));
+        }
+
+        Instruction *term = copy->terminator();
+        if (!term || term->op != Opcode::RET)
+            continue;
+
+        if (!term->operands.empty())
+            returns.push_back({term->operands[0], copy});
+        copy->erase(term);
+        copy->append(Opcode::BR, VoidType)->blocks.push_back(cont);
+    }
+
+    if (!call->users.empty())
+    {
+        if (returns.size() == 1)
+        {
+            call->replaceAllUsesWith(returns[0].first);
+        }
+        else if (returns.empty())
+        {
+            call->replaceAllUsesWith(caller.zeroValue(call->type));
+        }
+        else
+        {
+            Instruction *phi = cont->addPhi(call->type);
+            for (auto &ret : returns)
+            {
+                phi->addIncoming(ret.first, ret.second);
+            }
+            call->replaceAllUsesWith(phi);
+        }
+    }
+
+    block->erase(call);
+    block->append(Opcode::BR, VoidType)->blocks.push_back(blockMap[callee->entry()]);
+    caller.recomputePredecessors();
+}
+
+bool Inliner::runOnModule(IRModule &module)
+{
+    CallGraph graph(module);
+    depth.clear();
+    unordered_set<IRFunction *> inlined;
+
+    for (auto caller : graph.bottomUpOrder())
+    {
+        vector<Instruction *> sites = graph.callSites(caller);
+        for (auto call : sites)
+        {
+            IRFunction *callee = module.getFunction(call->text);
+            if (call->parallel || call->spawn || !shouldInline(graph, caller, callee))
+                continue;
+
+            inlineCall(call, callee);
+            depth[caller] = max(depth[caller], depth[callee] + 1);
+            inlined.insert(callee);
+        }
+    }
+
+    if (inlined.empty())
+        return false;
+
+    CallGraph remaining(module);
+    for (auto callee : inlined)
+    {
+        if (remaining.callers(callee).empty())
+            module.removeFunction(callee);
+    }
+    return true;
+}
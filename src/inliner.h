@@ -0,0 +1,28 @@
+#ifndef INLINER_H
+#define INLINER_H
+
+#include "call_graph.h"
+#include "pass_manager.h"
+
+using namespace std;
+
+class Inliner : public Pass
+{
+private:
+    int threshold;
+    int maxDepth;
+    unordered_map<IRFunction *, int> depth;
+
+    bool shouldInline(CallGraph &graph, IRFunction *caller, IRFunction *callee);
+    void inlineCall(Instruction *call, IRFunction *callee);
+
+public:
+    Inliner(int threshold, int maxDepth) : threshold(threshold), maxDepth(maxDepth) {}
+
+    string name() const override { return "inline"; }
+    bool runOnModule(IRModule &module) override;
+};
+
+int functionSize(const IRFunction &function);
+
+#endif
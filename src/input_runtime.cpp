@@ -0,0 +1,231 @@
+#include "input_runtime.h"
+
+using namespace std;
+
+// Standard input is read in 1MB blocks into one buffer that all threads share under a lock. Numbers are
+// parsed in place: the character after a token is set to NUL while it is parsed and then put back.
+const char *const inputRuntimeSource = R"nova(#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define NOVA_IN_CAPACITY (1 << 20)
+
+static struct
+{
+    pthread_mutex_t lock;
+    int eof;
+    size_t start;
+    size_t end;
+    char data[NOVA_IN_CAPACITY + 1];
+} nova_in = {PTHREAD_MUTEX_INITIALIZER, 0, 0, 0, {0}};
+
+static void nova_in_fail(const char *expected)
+{
+    fprintf(stderr, "Runtime error: expected %s on standard input\n", expected);
+    exit(1);
+}
+
+// Moves the unread bytes to the front of the buffer and appends the next block. Returns 0 at end of input.
+static int nova_in_fill(void)
+{
+    if (nova_in.eof)
+        return 0;
+    size_t remaining = nova_in.end - nova_in.start;
+    memmove(nova_in.data, nova_in.data + nova_in.start, remaining);
+    nova_in.start = 0;
+    nova_in.end = remaining;
+    if (remaining == NOVA_IN_CAPACITY)
+    {
+        fprintf(stderr, "Runtime error: input token longer than %d bytes\n", NOVA_IN_CAPACITY);
+        exit(1);
+    }
+    for (;;)
+    {
+        ssize_t count = read(0, nova_in.data + nova_in.end, NOVA_IN_CAPACITY - nova_in.end);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+        {
+            nova_in.eof = 1;
+            return 0;
+        }
+        nova_in.end += (size_t)count;
+        return 1;
+    }
+}
+
+// Skips whitespace and returns the next token, NUL-terminated in place, or NULL at end of input. The byte
+// replaced by the NUL is stored in *saved and must be put back with nova_in_restore.
+static char *nova_in_token(char *saved)
+{
+    for (;;)
+    {
+        while (nova_in.start < nova_in.end && (unsigned char)nova_in.data[nova_in.start] <= ' ')
+            nova_in.start++;
+        if (nova_in.start < nova_in.end)
+            break;
+        if (!nova_in_fill())
+            return NULL;
+    }
+    size_t i = nova_in.start;
+    for (;;)
+    {
+        while (i < nova_in.end && (unsigned char)nova_in.data[i] > ' ')
+            i++;
+        if (i < nova_in.end)
+            break;
+        size_t offset = i - nova_in.start;
+        int more = nova_in_fill();
+        i = nova_in.start + offset;
+        if (!more)
+            break;
+    }
+    char *token = nova_in.data + nova_in.start;
+    *saved = nova_in.data[i];
+    nova_in.data[i] = '\0';
+    nova_in.start = i;
+    return token;
+}
+
+static void nova_in_restore(char saved)
+{
+    nova_in.data[nova_in.start] = saved;
+}
+
+// Reads the next integer into *value. Returns 0 at end of input.
+static int nova_in_int(int *value)
+{
+    char saved;
+    const char *p = nova_in_token(&saved);
+    if (!p)
+        return 0;
+    int negative = *p == '-';
+    if (*p == '-' || *p == '+')
+        p++;
+    unsigned long long magnitude = 0;
+    const char *digits = p;
+    while (*p >= '0' && *p <= '9' && magnitude <= 2147483648ULL)
+        magnitude = magnitude * 10 + (unsigned)(*p++ - '0');
+    if (*p || p == digits || magnitude > 2147483647ULL + negative)
+        nova_in_fail("an integer");
+    nova_in_restore(saved);
+    *value = negative ? (int)(0U - (unsigned)magnitude) : (int)magnitude;
+    return 1;
+}
+
+// Plain decimals with at most 7 digits and 10 decimal places are a quotient of two exact floats, so one
+// division rounds them correctly. Everything else goes through strtof.
+static float nova_in_float(void)
+{
+    static const float powers[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    char saved;
+    char *token = nova_in_token(&saved);
+    if (!token)
+        nova_in_fail("a float");
+    const char *p = token;
+    int negative = *p == '-';
+    if (*p == '-' || *p == '+')
+        p++;
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    for (; *p >= '0' && *p <= '9'; p++, digits++)
+        mantissa = mantissa * 10 + (unsigned)(*p - '0');
+    if (*p == '.')
+    {
+        for (p++; *p >= '0' && *p <= '9'; p++, digits++, exponent--)
+            mantissa = mantissa * 10 + (unsigned)(*p - '0');
+    }
+    float value;
+    if (*p == '\0' && digits > 0 && digits <= 7 && exponent >= -10)
+    {
+        value = exponent < 0 ? (float)mantissa / powers[-exponent] : (float)mantissa;
+        value = negative ? -value : value;
+    }
+    else
+    {
+        char *end;
+        value = strtof(token, &end);
+        if (*end || end == token)
+            nova_in_fail("a float");
+    }
+    nova_in_restore(saved);
+    return value;
+}
+
+static int nova_read_int(void)
+{
+    int value;
+    pthread_mutex_lock(&nova_in.lock);
+    if (!nova_in_int(&value))
+        nova_in_fail("an integer");
+    pthread_mutex_unlock(&nova_in.lock);
+    return value;
+}
+
+static float nova_read_float(void)
+{
+    pthread_mutex_lock(&nova_in.lock);
+    float value = nova_in_float();
+    pthread_mutex_unlock(&nova_in.lock);
+    return value;
+}
+
+// The rest of the current line without its line break, or "" at end of input.
+static char *nova_read_line(void)
+{
+    size_t length = 0;
+    char *line = malloc(1);
+    pthread_mutex_lock(&nova_in.lock);
+    while (nova_in.start < nova_in.end || nova_in_fill())
+    {
+        char *begin = nova_in.data + nova_in.start;
+        char *newline = memchr(begin, '\n', nova_in.end - nova_in.start);
+        size_t count = newline ? (size_t)(newline - begin) : nova_in.end - nova_in.start;
+        line = realloc(line, length + count + 1);
+        memcpy(line + length, begin, count);
+        length += count;
+        nova_in.start += count + (newline != NULL);
+        if (newline)
+            break;
+    }
+    pthread_mutex_unlock(&nova_in.lock);
+    if (length > 0 && line[length - 1] == '\r')
+        length--;
+    line[length] = '\0';
+    return line;
+}
+
+static int nova_in_count(int count, int size)
+{
+    if (count < 0 || count > size)
+    {
+        fprintf(stderr, "Runtime error: cannot read %d values into an array of size %d\n", count, size);
+        exit(1);
+    }
+    return count;
+}
+
+// Fills values with up to count integers and returns how many there were before the end of input.
+static int nova_read_ints(int *values, int count)
+{
+    int filled = 0;
+    pthread_mutex_lock(&nova_in.lock);
+    while (filled < count && nova_in_int(&values[filled]))
+        filled++;
+    pthread_mutex_unlock(&nova_in.lock);
+    return filled;
+}
+)nova";
+
+bool isInputBuiltin(const string &name)
+{
+    return name == "read_int" || name == "read_float" || name == "read_line" || name == "read_ints";
+}
+
+string inputCall(const string &name, const vector<string> &args, int arraySize)
+{
+    if (name == "read_ints")
+        return "nova_read_ints(" + args[0] + ", nova_in_count(" + args[1] + ", " + to_string(arraySize) + "))";
+    return "nova_" + name + "()";
+}
@@ -0,0 +1,19 @@
+#ifndef INPUT_RUNTIME_H
+#define INPUT_RUNTIME_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// C source of the buffered stdin reader behind the input builtins, emitted into programs that read input.
+extern const char *const inputRuntimeSource;
+
+// read_int, read_float, read_line and read_ints.
+bool isInputBuiltin(const string &name);
+
+// C expression for the input builtin `name` applied to the C expressions `args`. read_ints checks its count
+// against arraySize, the size of the array it fills.
+string inputCall(const string &name, const vector<string> &args, int arraySize);
+
+#endif
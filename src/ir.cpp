@@ -0,0 +1,668 @@
+#include "ir.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+using namespace std;
+
+static void removeUser(Instruction *value, Instruction *user)
+{
+    auto it = find(value->users.begin(), value->users.end(), user);
+    if (it != value->users.end())
+    {
+        value->users.erase(it);
+    }
+}
+
+void Instruction::addOperand(Instruction *value)
+{
+    operands.push_back(value);
+    value->users.push_back(this);
+}
+
+void Instruction::setOperand(size_t index, Instruction *value)
+{
+    removeUser(operands[index], this);
+    operands[index] = value;
+    value->users.push_back(this);
+}
+
+void Instruction::removeOperand(size_t index)
+{
+    removeUser(operands[index], this);
+    operands.erase(operands.begin() + index);
+}
+
+void Instruction::dropOperands()
+{
+    for (auto operand : operands)
+    {
+        removeUser(operand, this);
+    }
+    operands.clear();
+}
+
+void Instruction::replaceAllUsesWith(Instruction *value)
+{
+    if (value == this)
+        return;
+
+    vector<Instruction *> oldUsers = users;
+    for (auto user : oldUsers)
+    {
+        for (size_t i = 0; i < user->operands.size(); ++i)
+        {
+            if (user->operands[i] == this)
+            {
+                user->operands[i] = value;
+                value->users.push_back(user);
+            }
+        }
+    }
+    users.clear();
+}
+
+bool Instruction::isTerminator() const
+{
+    return op == Opcode::BR || op == Opcode::CONDBR || op == Opcode::RET;
+}
+
+bool Instruction::isBinary() const
+{
+    switch (op)
+    {
+    case Opcode::ADD:
+    case Opcode::SUB:
+    case Opcode::MUL:
+    case Opcode::DIV:
+    case Opcode::REM:
+        return true;
+    default:
+        return isComparison();
+    }
+}
+
+bool Instruction::isComparison() const
+{
+    switch (op)
+    {
+    case Opcode::EQ:
+    case Opcode::NE:
+    case Opcode::LT:
+    case Opcode::LE:
+    case Opcode::GT:
+    case Opcode::GE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool Instruction::hasSideEffects() const
+{
+    switch (op)
+    {
+    case Opcode::CALL:
+    case Opcode::AWAIT:
+    case Opcode::STORE:
+    case Opcode::STORE_GLOBAL:
+    case Opcode::PRINT:
+    case Opcode::BR:
+    case Opcode::CONDBR:
+    case Opcode::RET:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool Instruction::mayTrap() const
+{
+    if (op == Opcode::DIV || op == Opcode::REM)
+        return type->kind == TypeKind::INT;
+    return (op == Opcode::LOAD && !speculative) || hasSideEffects();
+}
+
+bool Instruction::readsMemory() const
+{
+    return op == Opcode::LOAD || op == Opcode::LOAD_GLOBAL || op == Opcode::CALL || op == Opcode::AWAIT;
+}
+
+void Instruction::addIncoming(Instruction *value, BasicBlock *block)
+{
+    addOperand(value);
+    blocks.push_back(block);
+}
+
+Instruction *Instruction::incomingFor(BasicBlock *block) const
+{
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        if (blocks[i] == block)
+            return operands[i];
+    }
+    return nullptr;
+}
+
+void Instruction::removeIncoming(BasicBlock *block)
+{
+    for (size_t i = 0; i < blocks.size();)
+    {
+        if (blocks[i] == block)
+        {
+            removeOperand(i);
+            blocks.erase(blocks.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+Instruction *BasicBlock::terminator() const
+{
+    if (instructions.empty() || !instructions.back()->isTerminator())
+        return nullptr;
+    return instructions.back().get();
+}
+
+vector<BasicBlock *> BasicBlock::successors() const
+{
+    Instruction *term = terminator();
+    if (!term || term->op == Opcode::RET)
+        return {};
+    return term->blocks;
+}
+
+vector<Instruction *> BasicBlock::phis() const
+{
+    vector<Instruction *> result;
+    for (auto &instr : instructions)
+    {
+        if (instr->op != Opcode::PHI)
+            break;
+        result.push_back(instr.get());
+    }
+    return result;
+}
+
+Instruction *BasicBlock::firstNonPhi() const
+{
+    for (auto &instr : instructions)
+    {
+        if (instr->op != Opcode::PHI)
+            return instr.get();
+    }
+    return nullptr;
+}
+
+Instruction *BasicBlock::append(Opcode op, shared_ptr<Type> type,
+                                const vector<Instruction *> &operands)
+{
+    return insertBefore(nullptr, op, type, operands);
+}
+
+Instruction *BasicBlock::insertBefore(Instruction *position, Opcode op, shared_ptr<Type> type,
+                                      const vector<Instruction *> &operands)
+{
+    auto instr = parent->createInstruction(op, type);
+    for (auto operand : operands)
+    {
+        instr->addOperand(operand);
+    }
+    return insertBefore(position, move(instr));
+}
+
+Instruction *BasicBlock::addPhi(shared_ptr<Type> type)
+{
+    return insertBefore(firstNonPhi(), Opcode::PHI, type);
+}
+
+Instruction *BasicBlock::insertBefore(Instruction *position, unique_ptr<Instruction> instr)
+{
+    Instruction *result = instr.get();
+    result->parent = this;
+
+    auto it = position ? position->location : instructions.end();
+    result->location = instructions.insert(it, move(instr));
+    return result;
+}
+
+unique_ptr<Instruction> BasicBlock::detach(Instruction *instr)
+{
+    if (instr->parent != this)
+        return nullptr;
+    unique_ptr<Instruction> result = move(*instr->location);
+    instructions.erase(instr->location);
+    result->parent = nullptr;
+    return result;
+}
+
+void BasicBlock::erase(Instruction *instr)
+{
+    instr->dropOperands();
+    detach(instr);
+}
+
+void BasicBlock::replaceSuccessor(BasicBlock *from, BasicBlock *to)
+{
+    Instruction *term = terminator();
+    if (!term)
+        return;
+    for (auto &target : term->blocks)
+    {
+        if (target == from)
+            target = to;
+    }
+}
+
+IRFunction::~IRFunction()
+{
+    for (auto &block : blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            instr->operands.clear();
+            instr->users.clear();
+        }
+    }
+}
+
+BasicBlock *IRFunction::createBlock()
+{
+    blocks.push_back(make_unique<BasicBlock>(nextBlockId++, this));
+    blocks.back()->location = prev(blocks.end());
+    return blocks.back().get();
+}
+
+void IRFunction::removeBlock(BasicBlock *block)
+{
+    for (auto &instr : block->instructions)
+    {
+        instr->dropOperands();
+    }
+    for (auto succ : block->successors())
+    {
+        for (auto phi : succ->phis())
+        {
+            phi->removeIncoming(block);
+        }
+    }
+    for (auto &instr : block->instructions)
+    {
+        if (!instr->users.empty())
+        {
+            instr->replaceAllUsesWith(zeroValue(instr->type));
+        }
+    }
+    blocks.erase(block->location);
+}
+
+void IRFunction::recomputePredecessors()
+{
+    for (auto &block : blocks)
+    {
+        block->preds.clear();
+    }
+    for (auto &block : blocks)
+    {
+        for (auto succ : block->successors())
+        {
+            succ->preds.push_back(block.get());
+        }
+    }
+}
+
+unique_ptr<Instruction> IRFunction::createInstruction(Opcode op, shared_ptr<Type> type)
+{
+    auto instr = make_unique<Instruction>(op, type);
+    instr->function = this;
+    instr->id = nextValueId++;
+    return instr;
+}
+
+Instruction *IRFunction::addParam(shared_ptr<Type> type, const string &name)
+{
+    auto param = createInstruction(Opcode::PARAM, type);
+    param->name = name;
+    params.push_back(move(param));
+    return params.back().get();
+}
+
+Instruction *IRFunction::addConstant(unique_ptr<Instruction> constant)
+{
+    constants.push_back(move(constant));
+    return constants.back().get();
+}
+
+Instruction *IRFunction::constInt(int value)
+{
+    auto key = make_pair(static_cast<int>(TypeKind::INT), static_cast<long long>(value));
+    auto it = constantCache.find(key);
+    if (it != constantCache.end())
+        return it->second;
+
+    auto constant = createInstruction(Opcode::CONST, IntType);
+    constant->intValue = value;
+    return constantCache[key] = addConstant(move(constant));
+}
+
+Instruction *IRFunction::constFloat(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    auto key = make_pair(static_cast<int>(TypeKind::FLOAT), static_cast<long long>(bits));
+    auto it = constantCache.find(key);
+    if (it != constantCache.end())
+        return it->second;
+
+    auto constant = createInstruction(Opcode::CONST, FloatType);
+    constant->floatValue = value;
+    return constantCache[key] = addConstant(move(constant));
+}
+
+Instruction *IRFunction::constBool(bool value)
+{
+    auto key = make_pair(static_cast<int>(TypeKind::BOOL), static_cast<long long>(value));
+    auto it = constantCache.find(key);
+    if (it != constantCache.end())
+        return it->second;
+
+    auto constant = createInstruction(Opcode::CONST, BoolType);
+    constant->intValue = value ? 1 : 0;
+    return constantCache[key] = addConstant(move(constant));
+}
+
+Instruction *IRFunction::constString(const string &value)
+{
+    auto it = stringCache.find(value);
+    if (it != stringCache.end())
+        return it->second;
+
+    auto constant = createInstruction(Opcode::CONST, StringType);
+    constant->text = value;
+    return stringCache[value] = addConstant(move(constant));
+}
+
+Instruction *IRFunction::nullString()
+{
+    auto key = make_pair(static_cast<int>(TypeKind::STRING), 0LL);
+    auto it = constantCache.find(key);
+    if (it != constantCache.end())
+        return it->second;
+
+    auto constant = createInstruction(Opcode::CONST, StringType);
+    constant->intValue = 1;
+    return constantCache[key] = addConstant(move(constant));
+}
+
+Instruction *IRFunction::zeroValue(shared_ptr<Type> type)
+{
+    switch (type->kind)
+    {
+    case TypeKind::FLOAT:
+        return constFloat(0.0f);
+    case TypeKind::BOOL:
+        return constBool(false);
+    case TypeKind::STRING:
+    case TypeKind::ARRAY:
+        return nullString();
+    case TypeKind::TASK:
+    case TypeKind::CHANNEL:
+    case TypeKind::VECTOR:
+        return addConstant(createInstruction(Opcode::CONST, type));
+    default:
+        return constInt(0);
+    }
+}
+
+Instruction *IRFunction::globalRef(const string &name, shared_ptr<Type> type)
+{
+    auto it = globalCache.find(name);
+    if (it != globalCache.end())
+        return it->second;
+
+    auto ref = createInstruction(Opcode::GLOBAL, type);
+    ref->text = name;
+    return globalCache[name] = addConstant(move(ref));
+}
+
+IRFunction *IRModule::createFunction(const string &name, shared_ptr<Type> returnType)
+{
+    functions.push_back(make_unique<IRFunction>(name, returnType));
+    functions.back()->module = this;
+    return functions.back().get();
+}
+
+IRFunction *IRModule::getFunction(const string &name) const
+{
+    for (auto &function : functions)
+    {
+        if (function->name == name)
+            return function.get();
+    }
+    return nullptr;
+}
+
+IRGlobal *IRModule::getGlobal(const string &name) const
+{
+    for (auto &global : globals)
+    {
+        if (global->name == name)
+            return global.get();
+    }
+    return nullptr;
+}
+
+void IRModule::removeFunction(IRFunction *function)
+{
+    functions.remove_if([function](const unique_ptr<IRFunction> &f)
+                        { return f.get() == function; });
+}
+
+string opcodeName(Opcode op)
+{
+    switch (op)
+    {
+    case Opcode::CONST:
+        return "const";
+    case Opcode::PARAM:
+        return "param";
+    case Opcode::GLOBAL:
+        return "global";
+    case Opcode::ADD:
+        return "add";
+    case Opcode::SUB:
+        return "sub";
+    case Opcode::MUL:
+        return "mul";
+    case Opcode::DIV:
+        return "div";
+    case Opcode::REM:
+        return "rem";
+    case Opcode::EQ:
+        return "eq";
+    case Opcode::NE:
+        return "ne";
+    case Opcode::LT:
+        return "lt";
+    case Opcode::LE:
+        return "le";
+    case Opcode::GT:
+        return "gt";
+    case Opcode::GE:
+        return "ge";
+    case Opcode::NEG:
+        return "neg";
+    case Opcode::NOT:
+        return "not";
+    case Opcode::ITOF:
+        return "itof";
+    case Opcode::PHI:
+        return "phi";
+    case Opcode::CALL:
+        return "call";
+    case Opcode::AWAIT:
+        return "await";
+    case Opcode::ARRAY:
+        return "array";
+    case Opcode::LOAD:
+        return "load";
+    case Opcode::STORE:
+        return "store";
+    case Opcode::LOAD_GLOBAL:
+        return "loadglobal";
+    case Opcode::STORE_GLOBAL:
+        return "storeglobal";
+    case Opcode::PRINT:
+        return "print";
+    case Opcode::BR:
+        return "br";
+    case Opcode::CONDBR:
+        return "condbr";
+    case Opcode::RET:
+        return "ret";
+    }
+    return "unknown";
+}
+
+string valueName(const Instruction *value)
+{
+    if (value->op == Opcode::CONST)
+    {
+        switch (value->type->kind)
+        {
+        case TypeKind::FLOAT:
+        {
+            ostringstream out;
+            out << value->floatValue;
+            return out.str();
+        }
+        case TypeKind::BOOL:
+            return value->intValue ? "true" : "false";
+        case TypeKind::STRING:
+            return value->intValue ? "null" : "\"" + value->text + "\"";
+        case TypeKind::TASK:
+        case TypeKind::CHANNEL:
+            return "null";
+        case TypeKind::VECTOR:
+            return "zeroinitializer";
+        default:
+            return to_string(value->intValue);
+        }
+    }
+    if (value->op == Opcode::GLOBAL)
+    {
+        return "@" + value->text;
+    }
+    return "%" + (value->name.empty() ? "" : value->name + ".") + to_string(value->id);
+}
+
+static string blockName(const BasicBlock *block)
+{
+    return "bb" + to_string(block->id);
+}
+
+void printFunction(ostream &out, const IRFunction &function)
+{
+    out << "function " << function.returnType->toString() << " " << function.name << "(";
+    for (size_t i = 0; i < function.params.size(); ++i)
+    {
+        if (i > 0)
+            out << ", ";
+        out << (function.params[i]->noalias ? "noalias " : "") << function.params[i]->type->toString() << " "
+            << valueName(function.params[i].get());
+    }
+    out << ")";
+    if (function.purity == Purity::CONST)
+        out << " const";
+    else if (function.purity == Purity::PURE)
+        out << " pure";
+    out << (function.memoize ? " memoize" : "");
+    if (!function.reduction.empty())
+        out << " reduce(" << function.reduction << ")";
+    out << " {" << endl;
+
+    for (auto &block : function.blocks)
+    {
+        out << blockName(block.get()) << ":";
+        if (!block->preds.empty())
+        {
+            out << "    ; preds:";
+            for (auto pred : block->preds)
+            {
+                out << " " << blockName(pred);
+            }
+        }
+        if (block->unrollFactor > 0)
+            out << "    ; unroll " << block->unrollFactor;
+        out << endl;
+
+        for (auto &instr : block->instructions)
+        {
+            out << "    ";
+            if (instr->type->kind != TypeKind::VOID && !instr->isTerminator())
+            {
+                out << valueName(instr.get()) << " = ";
+            }
+            out << opcodeName(instr->op) << (instr->speculative ? ".spec" : "") << (instr->checked ? ".checked" : "")
+                << (instr->parallel ? ".parallel" : "") << (instr->spawn ? ".spawn" : "");
+            if (instr->type->kind != TypeKind::VOID && !instr->isTerminator())
+            {
+                out << " " << instr->type->toString();
+            }
+            if (!instr->text.empty())
+            {
+                out << " " << instr->text;
+            }
+
+            for (size_t i = 0; i < instr->operands.size(); ++i)
+            {
+                out << (i > 0 ? ", " : " ");
+                if (instr->op == Opcode::PHI)
+                {
+                    out << "[" << valueName(instr->operands[i]) << ", "
+                        << blockName(instr->blocks[i]) << "]";
+                }
+                else
+                {
+                    out << valueName(instr->operands[i]);
+                }
+            }
+
+            if (instr->op != Opcode::PHI)
+            {
+                for (size_t i = 0; i < instr->blocks.size(); ++i)
+                {
+                    out << ((i > 0 || !instr->operands.empty()) ? ", " : " ") << blockName(instr->blocks[i]);
+                }
+            }
+            out << endl;
+        }
+    }
+    out << "}" << endl;
+}
+
+void printModule(ostream &out, const IRModule &module)
+{
+    for (auto &global : module.globals)
+    {
+        out << "global " << global->type->toString() << " @" << global->name;
+        if (global->initializer)
+        {
+            out << " = " << valueName(global->initializer.get());
+        }
+        out << endl;
+    }
+    if (!module.globals.empty())
+    {
+        out << endl;
+    }
+
+    for (auto &function : module.functions)
+    {
+        printFunction(out, *function);
+        out << endl;
+    }
+}
@@ -0,0 +1,209 @@
+#ifndef IR_H
+#define IR_H
+
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "types.h"
+
+using namespace std;
+
+class BasicBlock;
+class IRFunction;
+class IRModule;
+
+enum class Opcode
+{
+    CONST,
+    PARAM,
+    GLOBAL,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    REM,
+    EQ,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE,
+    NEG,
+    NOT,
+    ITOF,
+    PHI,
+    CALL,
+    AWAIT,
+    ARRAY,
+    LOAD,
+    STORE,
+    LOAD_GLOBAL,
+    STORE_GLOBAL,
+    PRINT,
+    BR,
+    CONDBR,
+    RET
+};
+
+enum class Purity
+{
+    IMPURE,
+    PURE,
+    CONST
+};
+
+class Instruction
+{
+public:
+    Opcode op;
+    shared_ptr<Type> type;
+    vector<Instruction *> operands;
+    vector<BasicBlock *> blocks;
+    vector<Instruction *> users;
+    BasicBlock *parent;
+    list<unique_ptr<Instruction>>::iterator location;
+    IRFunction *function;
+    int id;
+    string name;
+
+    int intValue;
+    float floatValue;
+    string text;
+    bool speculative;
+    bool checked;
+    bool parallel;
+    bool spawn;
+    // On array parameters: no other array the function can reach is the same array.
+    bool noalias;
+
+    Instruction(Opcode op, shared_ptr<Type> type)
+        : op(op), type(type), parent(nullptr), function(nullptr), id(0), intValue(0), floatValue(0.0f),
+          speculative(false), checked(false), parallel(false), spawn(false), noalias(false) {}
+
+    void addOperand(Instruction *value);
+    void setOperand(size_t index, Instruction *value);
+    void removeOperand(size_t index);
+    void dropOperands();
+    void replaceAllUsesWith(Instruction *value);
+
+    bool isConstant() const { return op == Opcode::CONST; }
+    bool isTerminator() const;
+    bool isBinary() const;
+    bool isComparison() const;
+    bool hasSideEffects() const;
+    bool mayTrap() const;
+    bool readsMemory() const;
+
+    void addIncoming(Instruction *value, BasicBlock *block);
+    Instruction *incomingFor(BasicBlock *block) const;
+    void removeIncoming(BasicBlock *block);
+};
+
+class BasicBlock
+{
+public:
+    int id;
+    IRFunction *parent;
+    list<unique_ptr<BasicBlock>>::iterator location;
+    list<unique_ptr<Instruction>> instructions;
+    vector<BasicBlock *> preds;
+    int unrollFactor;
+
+    BasicBlock(int id, IRFunction *parent) : id(id), parent(parent), unrollFactor(0) {}
+
+    Instruction *terminator() const;
+    vector<BasicBlock *> successors() const;
+    vector<Instruction *> phis() const;
+    Instruction *firstNonPhi() const;
+
+    Instruction *append(Opcode op, shared_ptr<Type> type,
+                        const vector<Instruction *> &operands = {});
+    Instruction *insertBefore(Instruction *position, Opcode op, shared_ptr<Type> type,
+                              const vector<Instruction *> &operands = {});
+    Instruction *addPhi(shared_ptr<Type> type);
+    Instruction *insertBefore(Instruction *position, unique_ptr<Instruction> instr);
+    unique_ptr<Instruction> detach(Instruction *instr);
+    void erase(Instruction *instr);
+
+    void replaceSuccessor(BasicBlock *from, BasicBlock *to);
+};
+
+class IRFunction
+{
+public:
+    string name;
+    shared_ptr<Type> returnType;
+    vector<unique_ptr<Instruction>> params;
+    vector<unique_ptr<Instruction>> constants;
+    list<unique_ptr<BasicBlock>> blocks;
+    IRModule *module;
+    int nextValueId;
+    int nextBlockId;
+    set<string> annotations;
+    bool memoize;
+    Purity purity;
+    string reduction;
+
+    IRFunction(const string &name, shared_ptr<Type> returnType)
+        : name(name), returnType(returnType), module(nullptr),
+          nextValueId(0), nextBlockId(0), memoize(false), purity(Purity::IMPURE) {}
+    ~IRFunction();
+
+    bool isMain() const { return name == "main"; }
+    BasicBlock *entry() const { return blocks.front().get(); }
+    BasicBlock *createBlock();
+    void removeBlock(BasicBlock *block);
+    void recomputePredecessors();
+
+    Instruction *addParam(shared_ptr<Type> type, const string &name);
+    Instruction *constInt(int value);
+    Instruction *constFloat(float value);
+    Instruction *constBool(bool value);
+    Instruction *constString(const string &value);
+    Instruction *nullString();
+    Instruction *zeroValue(shared_ptr<Type> type);
+    Instruction *globalRef(const string &name, shared_ptr<Type> type);
+
+    unique_ptr<Instruction> createInstruction(Opcode op, shared_ptr<Type> type);
+
+private:
+    map<pair<int, long long>, Instruction *> constantCache;
+    map<string, Instruction *> stringCache;
+    map<string, Instruction *> globalCache;
+
+    Instruction *addConstant(unique_ptr<Instruction> constant);
+};
+
+class IRGlobal
+{
+public:
+    string name;
+    shared_ptr<Type> type;
+    unique_ptr<Instruction> initializer;
+
+    IRGlobal(const string &name, shared_ptr<Type> type)
+        : name(name), type(type) {}
+};
+
+class IRModule
+{
+public:
+    vector<unique_ptr<IRGlobal>> globals;
+    list<unique_ptr<IRFunction>> functions;
+
+    IRFunction *createFunction(const string &name, shared_ptr<Type> returnType);
+    IRFunction *getFunction(const string &name) const;
+    IRGlobal *getGlobal(const string &name) const;
+    void removeFunction(IRFunction *function);
+};
+
+string opcodeName(Opcode op);
+string valueName(const Instruction *value);
+void printFunction(ostream &out, const IRFunction &function);
+void printModule(ostream &out, const IRModule &module);
+
+#endif
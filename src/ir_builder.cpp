@@ -0,0 +1,1067 @@
+#include "ir_builder.h"
+#include "atomic_runtime.h"
+#include "error.h"
+#include "map_runtime.h"
+#include "simplify_cfg.h"
+#include "vector_runtime.h"
+
+using namespace std;
+
+IRBuilder::IRBuilder(const CompilerOptions &options)
+    : function(nullptr), block(nullptr), value(nullptr), boundsCheck(options.boundsCheck),
+      fastMath(options.fastMath), autoParallel(options.autoParallel && options.optLevel > 0),
+      captureBase(-1), parallelLoops(0) {}
+
+unique_ptr<IRModule> IRBuilder::build(shared_ptr<Program> program)
+{
+    module = make_unique<IRModule>();
+    program->accept(this);
+    return move(module);
+}
+
+int IRBuilder::declareVariable(const string &name, shared_ptr<Type> type)
+{
+    variables.push_back(IRVariable(name, type));
+    int var = static_cast<int>(variables.size()) - 1;
+    scopes.back()[name] = var;
+    return var;
+}
+
+int IRBuilder::resolveVariable(const string &name)
+{
+    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it)
+    {
+        auto found = it->find(name);
+        if (found != it->end())
+            return found->second;
+    }
+    return -1;
+}
+
+void IRBuilder::enterScope()
+{
+    scopes.push_back({});
+    mappings.push_back({});
+}
+
+// Mapped arrays are released where they go out of scope, unless control has already left through a return.
+void IRBuilder::exitScope()
+{
+    if (block)
+        unmapArrays(mappings.back());
+    scopes.pop_back();
+    mappings.pop_back();
+}
+
+void IRBuilder::unmapArrays(const vector<Instruction *> &arrays)
+{
+    for (auto it = arrays.rbegin(); it != arrays.rend(); ++it)
+    {
+        // Scopes below an outlined loop body belong to the function it was outlined from.
+        if ((*it)->function != function)
+            continue;
+        Instruction *unmap = emit(Opcode::CALL, VoidType, {*it});
+        unmap->text = "nova_unmap";
+    }
+}
+
+void IRBuilder::writeVariable(int var, BasicBlock *target, Instruction *val)
+{
+    currentDef[target][var] = val;
+}
+
+Instruction *IRBuilder::readVariable(int var, BasicBlock *target)
+{
+    auto &defs = currentDef[target];
+    auto it = defs.find(var);
+    if (it != defs.end())
+        return it->second;
+    return readVariableRecursive(var, target);
+}
+
+Instruction *IRBuilder::readVariableRecursive(int var, BasicBlock *target)
+{
+    Instruction *val;
+    if (!sealedBlocks.count(target))
+    {
+        val = target->addPhi(variables[var].type);
+        val->name = variables[var].name;
+        incompletePhis[target].push_back({var, val});
+    }
+    else if (target->preds.empty())
+    {
+        val = function->zeroValue(variables[var].type);
+    }
+    else if (target->preds.size() == 1)
+    {
+        val = readVariable(var, target->preds[0]);
+    }
+    else
+    {
+        val = target->addPhi(variables[var].type);
+        val->name = variables[var].name;
+        writeVariable(var, target, val);
+        addPhiOperands(var, val);
+    }
+    writeVariable(var, target, val);
+    return val;
+}
+
+void IRBuilder::addPhiOperands(int var, Instruction *phi)
+{
+    for (auto pred : phi->parent->preds)
+    {
+        phi->addIncoming(readVariable(var, pred), pred);
+    }
+}
+
+void IRBuilder::sealBlock(BasicBlock *target)
+{
+    for (auto &pending : incompletePhis[target])
+    {
+        addPhiOperands(pending.first, pending.second);
+    }
+    incompletePhis.erase(target);
+    sealedBlocks.insert(target);
+}
+
+Instruction *IRBuilder::emit(Opcode op, shared_ptr<Type> type, const vector<Instruction *> &operands)
+{
+    return block->append(op, type, operands);
+}
+
+void IRBuilder::branch(BasicBlock *target)
+{
+    Instruction *br = emit(Opcode::BR, VoidType);
+    br->blocks.push_back(target);
+    target->preds.push_back(block);
+    block = nullptr;
+}
+
+void IRBuilder::condBranch(Instruction *cond, BasicBlock *ifTrue, BasicBlock *ifFalse)
+{
+    Instruction *br = emit(Opcode::CONDBR, VoidType, {cond});
+    br->blocks.push_back(ifTrue);
+    br->blocks.push_back(ifFalse);
+    ifTrue->preds.push_back(block);
+    ifFalse->preds.push_back(block);
+    block = nullptr;
+}
+
+void IRBuilder::finishBlock(BasicBlock *merge)
+{
+    sealBlock(merge);
+    if (merge->preds.empty())
+    {
+        function->removeBlock(merge);
+        block = nullptr;
+    }
+    else
+    {
+        block = merge;
+    }
+}
+
+Instruction *IRBuilder::lower(Expression *expr)
+{
+    value = nullptr;
+    expr->accept(this);
+    return value;
+}
+
+Instruction *IRBuilder::convert(Instruction *val, shared_ptr<Type> targetType)
+{
+    if (targetType->kind == TypeKind::FLOAT && val->type->kind == TypeKind::INT)
+    {
+        if (val->isConstant())
+            return function->constFloat(static_cast<float>(val->intValue));
+        return emit(Opcode::ITOF, FloatType, {val});
+    }
+    return val;
+}
+
+// Atomic variables live in a one-element array so that calls, tasks and parallel loops share the cell.
+static shared_ptr<Type> storageType(shared_ptr<Type> type)
+{
+    return type->kind == TypeKind::ATOMIC ? make_shared<ArrayType>(type, 1) : type;
+}
+
+void IRBuilder::lowerStatement(Statement *stmt)
+{
+    if (block)
+    {
+        stmt->accept(this);
+    }
+}
+
+Instruction *IRBuilder::arrayAllocation(shared_ptr<Type> type, const string &name)
+{
+    BasicBlock *entry = function->entry();
+    Instruction *position = nullptr;
+    for (auto &instr : entry->instructions)
+    {
+        if (instr->op != Opcode::ARRAY)
+        {
+            position = instr.get();
+            break;
+        }
+    }
+    Instruction *array = entry->insertBefore(position, Opcode::ARRAY, type);
+    array->name = name;
+    return array;
+}
+
+unique_ptr<Instruction> IRBuilder::constantInitializer(Expression *expr, shared_ptr<Type> type)
+{
+    bool negate = false;
+    if (auto unary = dynamic_cast<UnaryOp *>(expr))
+    {
+        if (unary->op != "-")
+            return nullptr;
+        negate = true;
+        expr = unary->expr.get();
+    }
+
+    auto constant = make_unique<Instruction>(Opcode::CONST, type);
+    if (auto intLit = dynamic_cast<IntLiteral *>(expr))
+    {
+        if (type->kind == TypeKind::FLOAT)
+            constant->floatValue = negate ? -static_cast<float>(intLit->value) : static_cast<float>(intLit->value);
+        else
+            constant->intValue = negate ? -intLit->value : intLit->value;
+    }
+    else if (auto floatLit = dynamic_cast<FloatLiteral *>(expr))
+    {
+        constant->floatValue = negate ? -floatLit->value : floatLit->value;
+    }
+    else if (auto boolLit = dynamic_cast<BoolLiteral *>(expr))
+    {
+        if (negate)
+            return nullptr;
+        constant->intValue = boolLit->value ? 1 : 0;
+    }
+    else if (auto stringLit = dynamic_cast<StringLiteral *>(expr))
+    {
+        if (negate)
+            return nullptr;
+        constant->text = stringLit->value;
+    }
+    else
+    {
+        return nullptr;
+    }
+    return constant;
+}
+
+void IRBuilder::visitProgram(Program *node)
+{
+    scopes.clear();
+    enterScope();
+
+    for (auto &decl : node->declarations)
+    {
+        if (dynamic_cast<Function *>(decl.get()) || dynamic_cast<VarDeclaration *>(decl.get()))
+        {
+            decl->accept(this);
+        }
+        else
+        {
+            errorReporter.reportError("Only functions and variable declarations are allowed at top level");
+        }
+    }
+
+    exitScope();
+}
+
+void IRBuilder::visitFunction(Function *node)
+{
+    signatures[node->name] = node;
+
+    function = module->createFunction(node->name, node->returnType);
+    for (const auto &annotation : node->annotations)
+    {
+        function->annotations.insert(annotation.name);
+    }
+    block = function->createBlock();
+    sealBlock(block);
+
+    enterScope();
+    for (const auto &param : node->parameters)
+    {
+        auto type = storageType(param.type);
+        Instruction *arg = function->addParam(type, param.name);
+        arg->noalias = param.noalias;
+        int var = declareVariable(param.name, type);
+        if (type->kind == TypeKind::ARRAY)
+        {
+            variables[var].array = arg;
+        }
+        else
+        {
+            writeVariable(var, block, arg);
+        }
+    }
+
+    if (function->isMain())
+    {
+        for (auto &init : deferredGlobalInits)
+        {
+            if (init.first->type->kind == TypeKind::ARRAY)
+            {
+                Instruction *cell = function->globalRef(init.first->name, init.first->type);
+                atomicInit(cell, lower(init.second.get()));
+                continue;
+            }
+            Instruction *val = convert(lower(init.second.get()), init.first->type);
+            Instruction *store = emit(Opcode::STORE_GLOBAL, VoidType, {val});
+            store->text = init.first->name;
+        }
+    }
+
+    for (auto &stmt : node->body->statements)
+    {
+        lowerStatement(stmt.get());
+    }
+    exitScope();
+
+    if (block)
+    {
+        if (node->returnType->kind == TypeKind::VOID)
+            emit(Opcode::RET, VoidType);
+        else
+            emit(Opcode::RET, VoidType, {function->zeroValue(node->returnType)});
+        block = nullptr;
+    }
+
+    removeTrivialPhis(*function);
+
+    currentDef.clear();
+    incompletePhis.clear();
+    sealedBlocks.clear();
+    function = nullptr;
+}
+
+void IRBuilder::visitVarDeclaration(VarDeclaration *node)
+{
+    if (!function)
+    {
+        auto global = make_unique<IRGlobal>(node->name, storageType(node->type));
+        if (node->initializer && node->type->kind == TypeKind::ATOMIC)
+        {
+            deferredGlobalInits.push_back({global.get(), node->initializer});
+        }
+        else if (node->initializer)
+        {
+            global->initializer = constantInitializer(node->initializer.get(), node->type);
+            if (!global->initializer)
+            {
+                deferredGlobalInits.push_back({global.get(), node->initializer});
+            }
+        }
+        module->globals.push_back(move(global));
+        return;
+    }
+
+    if (node->type->kind == TypeKind::ARRAY)
+    {
+        auto map = dynamic_cast<FunctionCall *>(node->initializer.get());
+        if (node->initializer && !(map && map->builtin && isMapBuiltin(map->name)))
+        {
+            errorReporter.reportError("Array variable '" + node->name + "' cannot be initialized from an expression");
+            return;
+        }
+        int var = declareVariable(node->name, node->type);
+        variables[var].array = map ? lower(map) : arrayAllocation(node->type, node->name);
+        if (map)
+            mappings.back().push_back(variables[var].array);
+        return;
+    }
+
+    if (node->type->kind == TypeKind::ATOMIC)
+    {
+        auto type = storageType(node->type);
+        int var = declareVariable(node->name, type);
+        variables[var].array = arrayAllocation(type, node->name);
+        atomicInit(variables[var].array,
+                   node->initializer ? lower(node->initializer.get()) : function->constInt(0));
+        return;
+    }
+
+    Instruction *init = node->initializer
+                            ? convert(lower(node->initializer.get()), node->type)
+                            : function->zeroValue(node->type);
+    int var = declareVariable(node->name, node->type);
+    writeVariable(var, block, init);
+}
+
+Instruction *IRBuilder::assign(Expression *target, Expression *valueExpr)
+{
+    if (auto var = dynamic_cast<Variable *>(target))
+    {
+        int id = resolveVariable(var->name);
+        IRGlobal *global = id < 0 ? module->getGlobal(var->name) : nullptr;
+        shared_ptr<Type> type = id >= 0 ? variables[id].type : (global ? global->type : nullptr);
+
+        if (!type || type->kind == TypeKind::ARRAY)
+        {
+            errorReporter.reportError("Cannot assign to '" + var->name + "'");
+            return function->zeroValue(target->type);
+        }
+
+        Instruction *val = convert(lower(valueExpr), type);
+        if (id >= 0)
+        {
+            writeVariable(id, block, val);
+        }
+        else
+        {
+            Instruction *store = emit(Opcode::STORE_GLOBAL, VoidType, {val});
+            store->text = global->name;
+        }
+        return val;
+    }
+
+    if (auto access = dynamic_cast<ArrayAccess *>(target))
+    {
+        Instruction *array = lower(access->array.get());
+        Instruction *index = lower(access->index.get());
+        Instruction *val = convert(lower(valueExpr), access->type);
+        Instruction *store = emit(Opcode::STORE, VoidType, {array, index, val});
+        store->checked = boundsCheck;
+        return val;
+    }
+
+    errorReporter.reportError("Invalid assignment target");
+    return function->zeroValue(target->type);
+}
+
+void IRBuilder::visitAssignment(Assignment *node)
+{
+    assign(node->target.get(), node->value.get());
+}
+
+void IRBuilder::visitBlock(Block *node)
+{
+    enterScope();
+    for (auto &stmt : node->statements)
+    {
+        lowerStatement(stmt.get());
+    }
+    exitScope();
+}
+
+void IRBuilder::visitIfStatement(IfStatement *node)
+{
+    Instruction *cond = lower(node->condition.get());
+
+    BasicBlock *thenBlock = function->createBlock();
+    BasicBlock *elseBlock = node->elseBranch ? function->createBlock() : nullptr;
+    BasicBlock *merge = function->createBlock();
+
+    condBranch(cond, thenBlock, elseBlock ? elseBlock : merge);
+
+    sealBlock(thenBlock);
+    block = thenBlock;
+    enterScope();
+    lowerStatement(node->thenBranch.get());
+    exitScope();
+    if (block)
+        branch(merge);
+
+    if (elseBlock)
+    {
+        sealBlock(elseBlock);
+        block = elseBlock;
+        enterScope();
+        lowerStatement(node->elseBranch.get());
+        exitScope();
+        if (block)
+            branch(merge);
+    }
+
+    finishBlock(merge);
+}
+
+void IRBuilder::visitWhileStatement(WhileStatement *node)
+{
+    BasicBlock *header = function->createBlock();
+    BasicBlock *body = function->createBlock();
+    BasicBlock *exit = function->createBlock();
+
+    branch(header);
+
+    block = header;
+    Instruction *cond = lower(node->condition.get());
+    condBranch(cond, body, exit);
+
+    sealBlock(body);
+    block = body;
+    enterScope();
+    lowerStatement(node->body.get());
+    exitScope();
+    if (block)
+        branch(header);
+
+    sealBlock(header);
+    finishBlock(exit);
+}
+
+Instruction *IRBuilder::capture(int var)
+{
+    for (auto &entry : captures)
+    {
+        if (entry.first == var)
+            return entry.second;
+    }
+    Instruction *param = function->addParam(variables[var].type, variables[var].name);
+    captures.push_back({var, param});
+    return param;
+}
+
+void IRBuilder::lowerParallelFor(ForStatement *node, Instruction *start, Instruction *end, const Reduction *reduction)
+{
+    auto init = static_cast<VarDeclaration *>(node->init.get());
+
+    Instruction *initial = nullptr;
+    if (reduction)
+    {
+        Variable accumulator(reduction->variable);
+        initial = lower(&accumulator);
+    }
+
+    IRFunction *parent = function;
+    BasicBlock *parentBlock = block;
+    int parentCaptureBase = captureBase;
+    vector<pair<int, Instruction *>> parentCaptures;
+    parentCaptures.swap(captures);
+    function = module->createFunction(parent->name + "__par" + to_string(parallelLoops++),
+                                      initial ? initial->type : VoidType);
+    Instruction *lo = function->addParam(IntType, "lo");
+    Instruction *hi = function->addParam(IntType, "hi");
+    Instruction *partial = initial ? function->addParam(initial->type, reduction->variable) : nullptr;
+    captureBase = static_cast<int>(variables.size());
+    block = function->createBlock();
+    sealBlock(block);
+
+    enterScope();
+    int var = declareVariable(init->name, IntType);
+    writeVariable(var, block, lo);
+    int acc = -1;
+    if (partial)
+    {
+        function->reduction = reduction->op;
+        acc = declareVariable(reduction->variable, partial->type);
+        writeVariable(acc, block, partial);
+    }
+
+    BasicBlock *header = function->createBlock();
+    BasicBlock *body = function->createBlock();
+    BasicBlock *latch = function->createBlock();
+    BasicBlock *exit = function->createBlock();
+
+    branch(header);
+
+    block = header;
+    condBranch(emit(Opcode::LT, BoolType, {readVariable(var, header), hi}), body, exit);
+
+    sealBlock(body);
+    block = body;
+    enterScope();
+    lowerStatement(node->body.get());
+    exitScope();
+    if (block)
+        branch(latch);
+
+    sealBlock(latch);
+    if (latch->preds.empty())
+    {
+        function->removeBlock(latch);
+    }
+    else
+    {
+        block = latch;
+        lowerStatement(node->update.get());
+        branch(header);
+    }
+
+    sealBlock(header);
+    finishBlock(exit);
+    if (block && partial)
+        emit(Opcode::RET, VoidType, {readVariable(acc, block)});
+    else if (block)
+        emit(Opcode::RET, VoidType);
+    exitScope();
+    removeTrivialPhis(*function);
+
+    IRFunction *outlined = function;
+    function = parent;
+    block = parentBlock;
+    captureBase = parentCaptureBase;
+    vector<pair<int, Instruction *>> outlinedCaptures;
+    outlinedCaptures.swap(captures);
+    captures.swap(parentCaptures);
+
+    vector<Instruction *> args{start, end};
+    if (initial)
+        args.push_back(initial);
+    for (auto &entry : outlinedCaptures)
+    {
+        IRVariable &captured = variables[entry.first];
+        if (entry.first < captureBase)
+            args.push_back(capture(entry.first));
+        else
+            args.push_back(captured.array ? captured.array : readVariable(entry.first, block));
+    }
+
+    Instruction *call = emit(Opcode::CALL, outlined->returnType, args);
+    call->text = outlined->name;
+    call->parallel = true;
+
+    if (reduction)
+    {
+        int id = resolveVariable(reduction->variable);
+        if (id >= 0)
+        {
+            writeVariable(id, block, call);
+        }
+        else
+        {
+            Instruction *store = emit(Opcode::STORE_GLOBAL, VoidType, {call});
+            store->text = reduction->variable;
+        }
+    }
+}
+
+// Loops below this many iterations stay serial; starting the worker pool costs more than they save.
+static const int minParallelTrips = 1 << 16;
+static const int minParallelTripsNested = 256;
+
+bool IRBuilder::findParallelReduction(ForStatement *node, Reduction &reduction, int &minTrips)
+{
+    if (!autoParallel || !isCanonicalLoop(node))
+        return false;
+
+    ReductionAnalysis analysis(node);
+    vector<Reduction> reductions = analysis.reductions();
+    if (analysis.hasSideEffects() || !analysis.sharedWrites().empty() || reductions.size() != 1)
+        return false;
+
+    int id = resolveVariable(reductions[0].variable);
+    if (id < 0 || variables[id].array)
+        return false;
+    TypeKind kind = variables[id].type->kind;
+    if (kind != TypeKind::INT && !(kind == TypeKind::FLOAT && fastMath))
+        return false;
+
+    reduction = reductions[0];
+    minTrips = analysis.hasNestedLoops() ? minParallelTripsNested : minParallelTrips;
+    return true;
+}
+
+void IRBuilder::lowerReductionLoop(ForStatement *node, const Reduction &reduction, int minTrips)
+{
+    auto init = static_cast<VarDeclaration *>(node->init.get());
+    auto condition = static_cast<BinaryOp *>(node->condition.get());
+    Instruction *start = lower(init->initializer.get());
+    Instruction *end = lower(condition->right.get());
+
+    BasicBlock *parallel = function->createBlock();
+    BasicBlock *serial = function->createBlock();
+    BasicBlock *merge = function->createBlock();
+
+    Instruction *trips = emit(Opcode::SUB, IntType, {end, start});
+    condBranch(emit(Opcode::GE, BoolType, {trips, function->constInt(minTrips)}), parallel, serial);
+
+    sealBlock(parallel);
+    block = parallel;
+    lowerParallelFor(node, start, end, &reduction);
+    branch(merge);
+
+    sealBlock(serial);
+    block = serial;
+    lowerFor(node);
+    if (block)
+        branch(merge);
+
+    finishBlock(merge);
+}
+
+void IRBuilder::visitForStatement(ForStatement *node)
+{
+    if (node->parallel)
+    {
+        auto init = static_cast<VarDeclaration *>(node->init.get());
+        auto condition = static_cast<BinaryOp *>(node->condition.get());
+        Instruction *start = lower(init->initializer.get());
+        Instruction *end = lower(condition->right.get());
+        vector<Reduction> reductions = ReductionAnalysis(node).reductions();
+        lowerParallelFor(node, start, end, reductions.empty() ? nullptr : &reductions[0]);
+        return;
+    }
+
+    Reduction reduction;
+    int minTrips;
+    if (findParallelReduction(node, reduction, minTrips))
+    {
+        lowerReductionLoop(node, reduction, minTrips);
+        return;
+    }
+    lowerFor(node);
+}
+
+void IRBuilder::lowerFor(ForStatement *node)
+{
+    enterScope();
+
+    if (node->init)
+    {
+        lowerStatement(node->init.get());
+    }
+
+    BasicBlock *header = function->createBlock();
+    BasicBlock *body = function->createBlock();
+    BasicBlock *latch = function->createBlock();
+    BasicBlock *exit = function->createBlock();
+
+    for (const auto &annotation : node->annotations)
+    {
+        if (annotation.name == "unroll")
+            header->unrollFactor = annotation.args[0];
+    }
+
+    branch(header);
+
+    block = header;
+    if (node->condition)
+    {
+        Instruction *cond = lower(node->condition.get());
+        condBranch(cond, body, exit);
+    }
+    else
+    {
+        branch(body);
+    }
+
+    sealBlock(body);
+    block = body;
+    enterScope();
+    lowerStatement(node->body.get());
+    exitScope();
+    if (block)
+        branch(latch);
+
+    sealBlock(latch);
+    if (latch->preds.empty())
+    {
+        function->removeBlock(latch);
+    }
+    else
+    {
+        block = latch;
+        if (node->update)
+        {
+            lowerStatement(node->update.get());
+        }
+        branch(header);
+    }
+
+    sealBlock(header);
+    finishBlock(exit);
+
+    exitScope();
+}
+
+void IRBuilder::visitReturnStatement(ReturnStatement *node)
+{
+    Instruction *val = node->value ? convert(lower(node->value.get()), function->returnType) : nullptr;
+    for (auto it = mappings.rbegin(); it != mappings.rend(); ++it)
+    {
+        unmapArrays(*it);
+    }
+    if (val)
+        emit(Opcode::RET, VoidType, {val});
+    else
+        emit(Opcode::RET, VoidType);
+    block = nullptr;
+}
+
+void IRBuilder::visitPrintStatement(PrintStatement *node)
+{
+    Instruction *val = lower(node->expr.get());
+    if (val->type->kind != TypeKind::VOID)
+    {
+        emit(Opcode::PRINT, VoidType, {val});
+    }
+}
+
+void IRBuilder::visitExpressionStatement(ExpressionStatement *node)
+{
+    lower(node->expr.get());
+}
+
+void IRBuilder::visitIntLiteral(IntLiteral *node)
+{
+    value = function->constInt(node->value);
+}
+
+void IRBuilder::visitFloatLiteral(FloatLiteral *node)
+{
+    value = function->constFloat(node->value);
+}
+
+void IRBuilder::visitStringLiteral(StringLiteral *node)
+{
+    value = function->constString(node->value);
+}
+
+void IRBuilder::visitBoolLiteral(BoolLiteral *node)
+{
+    value = function->constBool(node->value);
+}
+
+void IRBuilder::visitVariable(Variable *node)
+{
+    int id = resolveVariable(node->name);
+    if (id >= 0)
+    {
+        IRVariable &var = variables[id];
+        if (id < captureBase)
+            value = capture(id);
+        else
+            value = var.array ? var.array : readVariable(id, block);
+        return;
+    }
+
+    IRGlobal *global = module->getGlobal(node->name);
+    if (!global)
+    {
+        errorReporter.reportError("Cannot lower reference to '" + node->name + "'");
+        value = function->constInt(0);
+        return;
+    }
+
+    if (global->type->kind == TypeKind::ARRAY)
+    {
+        value = function->globalRef(global->name, global->type);
+    }
+    else
+    {
+        value = emit(Opcode::LOAD_GLOBAL, global->type);
+        value->text = global->name;
+    }
+}
+
+void IRBuilder::visitArrayAccess(ArrayAccess *node)
+{
+    Instruction *array = lower(node->array.get());
+    Instruction *index = lower(node->index.get());
+    if (array->type->kind == TypeKind::VECTOR)
+    {
+        index = checkedIndex(index, static_pointer_cast<VectorType>(array->type)->lanes);
+        value = emit(Opcode::CALL, node->type, {array, index});
+        value->text = "nova_lane";
+        return;
+    }
+    value = emit(Opcode::LOAD, node->type, {array, index});
+    value->checked = boundsCheck;
+}
+
+static Opcode binaryOpcode(const string &op)
+{
+    if (op == "+")
+        return Opcode::ADD;
+    if (op == "-")
+        return Opcode::SUB;
+    if (op == "*")
+        return Opcode::MUL;
+    if (op == "/")
+        return Opcode::DIV;
+    if (op == "%")
+        return Opcode::REM;
+    if (op == "==")
+        return Opcode::EQ;
+    if (op == "!=")
+        return Opcode::NE;
+    if (op == "<")
+        return Opcode::LT;
+    if (op == "<=")
+        return Opcode::LE;
+    if (op == ">")
+        return Opcode::GT;
+    return Opcode::GE;
+}
+
+Instruction *IRBuilder::lowerShortCircuit(BinaryOp *node)
+{
+    bool isAnd = node->op == "&&";
+    Instruction *left = lower(node->left.get());
+
+    BasicBlock *rhs = function->createBlock();
+    BasicBlock *merge = function->createBlock();
+    BasicBlock *leftEnd = block;
+
+    if (isAnd)
+        condBranch(left, rhs, merge);
+    else
+        condBranch(left, merge, rhs);
+
+    sealBlock(rhs);
+    block = rhs;
+    Instruction *right = lower(node->right.get());
+    BasicBlock *rightEnd = block;
+    branch(merge);
+
+    sealBlock(merge);
+    block = merge;
+    Instruction *phi = block->addPhi(BoolType);
+    phi->addIncoming(function->constBool(!isAnd), leftEnd);
+    phi->addIncoming(right, rightEnd);
+    return phi;
+}
+
+void IRBuilder::visitBinaryOp(BinaryOp *node)
+{
+    if (node->op == "=")
+    {
+        value = assign(node->left.get(), node->right.get());
+        return;
+    }
+
+    if (node->op == "&&" || node->op == "||")
+    {
+        value = lowerShortCircuit(node);
+        return;
+    }
+
+    Instruction *left = lower(node->left.get());
+    Instruction *right = lower(node->right.get());
+
+    if (left->type->kind == TypeKind::VECTOR || right->type->kind == TypeKind::VECTOR)
+    {
+        auto vectorType = static_pointer_cast<VectorType>(left->type->kind == TypeKind::VECTOR ? left->type
+                                                                                                : right->type);
+        left = splat(left, vectorType);
+        right = splat(right, vectorType);
+        Opcode op = binaryOpcode(node->op);
+        value = emit(op, (op >= Opcode::EQ && op <= Opcode::GE) ? vectorType->maskType() : vectorType, {left, right});
+        return;
+    }
+
+    if (left->type->kind == TypeKind::FLOAT || right->type->kind == TypeKind::FLOAT)
+    {
+        left = convert(left, FloatType);
+        right = convert(right, FloatType);
+    }
+
+    Opcode op = binaryOpcode(node->op);
+    shared_ptr<Type> type = (op >= Opcode::EQ && op <= Opcode::GE) ? BoolType : left->type;
+    value = emit(op, type, {left, right});
+}
+
+void IRBuilder::visitUnaryOp(UnaryOp *node)
+{
+    Instruction *operand = lower(node->expr.get());
+    value = emit(node->op == "!" ? Opcode::NOT : Opcode::NEG, operand->type, {operand});
+}
+
+void IRBuilder::visitFunctionCall(FunctionCall *node)
+{
+    Function *callee = signatures.count(node->name) ? signatures[node->name] : nullptr;
+
+    vector<Instruction *> args;
+    for (size_t i = 0; i < node->args.size(); ++i)
+    {
+        Instruction *arg = lower(node->args[i].get());
+        if (callee && i < callee->parameters.size())
+        {
+            arg = convert(arg, callee->parameters[i].type);
+        }
+        else if (node->builtin && i == 1 && node->args[0]->type->kind == TypeKind::CHANNEL)
+        {
+            arg = convert(arg, static_pointer_cast<ChannelType>(node->args[0]->type)->elementType);
+        }
+        args.push_back(arg);
+    }
+
+    if (node->builtin && isAtomicBuiltin(node->name))
+        args.push_back(function->constString(node->memoryOrder));
+    if (node->builtin && node->name == "store")
+        args[2] = checkedIndex(args[2], static_pointer_cast<ArrayType>(node->args[1]->type)->size,
+                               static_pointer_cast<VectorType>(node->args[0]->type)->lanes);
+
+    value = emit(Opcode::CALL, node->type, args);
+    value->text = node->name;
+}
+
+void IRBuilder::atomicInit(Instruction *cell, Instruction *val)
+{
+    Instruction *store = emit(Opcode::CALL, VoidType, {cell, val, function->constString("relaxed")});
+    store->text = "atomic_store";
+}
+
+void IRBuilder::visitSpawnExpression(SpawnExpression *node)
+{
+    visitFunctionCall(node->call.get());
+    value->type = node->type;
+    value->spawn = true;
+}
+
+void IRBuilder::visitAwaitExpression(AwaitExpression *node)
+{
+    Instruction *task = lower(node->task.get());
+    value = emit(Opcode::AWAIT, node->type, {task});
+}
+
+void IRBuilder::visitChannelExpression(ChannelExpression *node)
+{
+    Instruction *capacity = lower(node->capacity.get());
+    value = emit(Opcode::CALL, node->type, {capacity});
+    value->text = "channel";
+}
+
+Instruction *IRBuilder::splat(Instruction *val, shared_ptr<Type> vectorType)
+{
+    if (val->type->kind == TypeKind::VECTOR)
+        return val;
+    val = convert(val, static_pointer_cast<VectorType>(vectorType)->elementType);
+    Instruction *vector = emit(Opcode::CALL, vectorType, {val});
+    vector->text = vectorType->toString();
+    return vector;
+}
+
+// Vector loads, stores and lane reads are builtin calls rather than LOAD and STORE, so their checks are
+// explicit calls that bounds check elimination leaves alone.
+// A vector access of several lanes must fit in the array as a whole; its check also carries the lane count.
+Instruction *IRBuilder::checkedIndex(Instruction *index, int size, int lanes)
+{
+    if (!boundsCheck)
+        return index;
+    Instruction *check = emit(Opcode::CALL, IntType, {index, function->constInt(size)});
+    if (lanes > 1)
+        check->addOperand(function->constInt(lanes));
+    check->text = "nova_bounds_check";
+    return check;
+}
+
+void IRBuilder::visitVectorExpression(VectorExpression *node)
+{
+    auto vectorType = static_pointer_cast<VectorType>(node->type);
+    vector<Instruction *> args;
+    for (auto &arg : node->args)
+    {
+        args.push_back(lower(arg.get()));
+    }
+    if (args.size() == 2)
+    {
+        args[1] = checkedIndex(args[1], static_pointer_cast<ArrayType>(node->args[0]->type)->size, vectorType->lanes);
+    }
+    else
+    {
+        for (auto &arg : args)
+        {
+            arg = convert(arg, vectorType->elementType);
+        }
+    }
+    value = emit(Opcode::CALL, vectorType, args);
+    value->text = vectorType->toString();
+}
@@ -0,0 +1,110 @@
+#ifndef IR_BUILDER_H
+#define IR_BUILDER_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include "ast.h"
+#include "ir.h"
+#include "options.h"
+#include "reduction.h"
+
+using namespace std;
+
+struct IRVariable
+{
+    string name;
+    shared_ptr<Type> type;
+    Instruction *array;
+
+    IRVariable(const string &name, shared_ptr<Type> type)
+        : name(name), type(type), array(nullptr) {}
+};
+
+class IRBuilder : public ASTVisitor
+{
+private:
+    unique_ptr<IRModule> module;
+    IRFunction *function;
+    BasicBlock *block;
+    Instruction *value;
+    bool boundsCheck;
+    bool fastMath;
+    bool autoParallel;
+    int captureBase;
+    vector<pair<int, Instruction *>> captures;
+    int parallelLoops;
+
+    vector<IRVariable> variables;
+    vector<unordered_map<string, int>> scopes;
+    vector<vector<Instruction *>> mappings;
+    unordered_map<string, Function *> signatures;
+    vector<pair<IRGlobal *, shared_ptr<Expression>>> deferredGlobalInits;
+
+    unordered_map<BasicBlock *, unordered_map<int, Instruction *>> currentDef;
+    unordered_map<BasicBlock *, vector<pair<int, Instruction *>>> incompletePhis;
+    unordered_set<BasicBlock *> sealedBlocks;
+
+    int declareVariable(const string &name, shared_ptr<Type> type);
+    int resolveVariable(const string &name);
+    void writeVariable(int var, BasicBlock *target, Instruction *val);
+    Instruction *readVariable(int var, BasicBlock *target);
+    Instruction *readVariableRecursive(int var, BasicBlock *target);
+    void addPhiOperands(int var, Instruction *phi);
+    void sealBlock(BasicBlock *target);
+
+    void enterScope();
+    void exitScope();
+    void unmapArrays(const vector<Instruction *> &arrays);
+
+    Instruction *lower(Expression *expr);
+    Instruction *convert(Instruction *val, shared_ptr<Type> targetType);
+    Instruction *emit(Opcode op, shared_ptr<Type> type, const vector<Instruction *> &operands = {});
+    Instruction *lowerShortCircuit(BinaryOp *node);
+    Instruction *assign(Expression *target, Expression *valueExpr);
+    void branch(BasicBlock *target);
+    void condBranch(Instruction *cond, BasicBlock *ifTrue, BasicBlock *ifFalse);
+    void lowerStatement(Statement *stmt);
+    Instruction *capture(int var);
+    void lowerFor(ForStatement *node);
+    void lowerParallelFor(ForStatement *node, Instruction *start, Instruction *end, const Reduction *reduction);
+    bool findParallelReduction(ForStatement *node, Reduction &reduction, int &minTrips);
+    void lowerReductionLoop(ForStatement *node, const Reduction &reduction, int minTrips);
+    void finishBlock(BasicBlock *merge);
+    Instruction *arrayAllocation(shared_ptr<Type> type, const string &name);
+    void atomicInit(Instruction *cell, Instruction *val);
+    Instruction *splat(Instruction *val, shared_ptr<Type> vectorType);
+    Instruction *checkedIndex(Instruction *index, int size, int lanes = 1);
+    unique_ptr<Instruction> constantInitializer(Expression *expr, shared_ptr<Type> type);
+
+public:
+    IRBuilder(const CompilerOptions &options);
+
+    unique_ptr<IRModule> build(shared_ptr<Program> program);
+
+    void visitProgram(Program *node) override;
+    void visitFunction(Function *node) override;
+    void visitVarDeclaration(VarDeclaration *node) override;
+    void visitAssignment(Assignment *node) override;
+    void visitBlock(Block *node) override;
+    void visitIfStatement(IfStatement *node) override;
+    void visitWhileStatement(WhileStatement *node) override;
+    void visitForStatement(ForStatement *node) override;
+    void visitReturnStatement(ReturnStatement *node) override;
+    void visitPrintStatement(PrintStatement *node) override;
+    void visitExpressionStatement(ExpressionStatement *node) override;
+    void visitIntLiteral(IntLiteral *node) override;
+    void visitFloatLiteral(FloatLiteral *node) override;
+    void visitStringLiteral(StringLiteral *node) override;
+    void visitBoolLiteral(BoolLiteral *node) override;
+    void visitVariable(Variable *node) override;
+    void visitArrayAccess(ArrayAccess *node) override;
+    void visitBinaryOp(BinaryOp *node) override;
+    void visitUnaryOp(UnaryOp *node) override;
+    void visitFunctionCall(FunctionCall *node) override;
+    void visitSpawnExpression(SpawnExpression *node) override;
+    void visitAwaitExpression(AwaitExpression *node) override;
+    void visitChannelExpression(ChannelExpression *node) override;
+    void visitVectorExpression(VectorExpression *node) override;
+};
+
+#endif
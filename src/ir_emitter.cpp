@@ -0,0 +1,1225 @@
+#include "ir_emitter.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include "atomic_runtime.h"
+#include "cfg.h"
+#include "channel_runtime.h"
+#include "input_runtime.h"
+#include "loop_info.h"
+#include "map_runtime.h"
+#include "parallel_runtime.h"
+#include "print_runtime.h"
+#include "spawn_runtime.h"
+#include "vector_runtime.h"
+
+using namespace std;
+
+// Every array is a local or global declared with this alignment, so array parameters can assume it too and
+// vectorized loops need no peeling.
+static const string arrayAlignment = " __attribute__((aligned(64)))";
+
+string formatIntLiteral(int value)
+{
+    if (value == INT_MIN)
+        return "(-2147483647 - 1)";
+    if (value < 0)
+        return "(" + to_string(value) + ")";
+    return to_string(value);
+}
+
+string symbolName(const string &name)
+{
+    return name == "main" ? name : "nv_" + name;
+}
+
+string formatFloatLiteral(float value)
+{
+    if (std::isnan(value))
+        return "__builtin_nanf(\"\")";
+    if (std::isinf(value))
+        return value > 0 ? "__builtin_inff()" : "(-__builtin_inff())";
+
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.9g", value);
+    string text = buffer;
+    if (text.find_first_of(".e") == string::npos)
+        text += ".0";
+    text += "f";
+    return value < 0 || (value == 0.0f && signbit(value)) ? "(" + text + ")" : text;
+}
+
+IREmitter::IREmitter(ostream &output)
+    : output(output), indent(0), current(&output), module(nullptr), borrowing(false), loopHeader(nullptr) {}
+
+void IREmitter::writeIndent()
+{
+    for (int i = 0; i < indent; ++i)
+    {
+        *current << "    ";
+    }
+}
+
+void IREmitter::writeLine(const string &text)
+{
+    writeIndent();
+    *current << text << endl;
+}
+
+string IREmitter::getCType(shared_ptr<Type> type)
+{
+    switch (type->kind)
+    {
+    case TypeKind::INT:
+        return "int";
+    case TypeKind::FLOAT:
+        return "float";
+    case TypeKind::STRING:
+        return "char*";
+    case TypeKind::BOOL:
+        return "int";
+    case TypeKind::VOID:
+        return "void";
+    case TypeKind::ARRAY:
+    {
+        auto arrayType = static_pointer_cast<ArrayType>(type);
+        return getCType(arrayType->elementType) + "*";
+    }
+    case TypeKind::TASK:
+        return "nova_handle";
+    case TypeKind::CHANNEL:
+        return "nova_channel";
+    case TypeKind::ATOMIC:
+        return "atomic_int";
+    case TypeKind::VECTOR:
+        return type->toString();
+    default:
+        return "void*";
+    }
+}
+
+string IREmitter::declaration(shared_ptr<Type> type, const string &name)
+{
+    return getCType(type) + " " + name;
+}
+
+string IREmitter::signature(const IRFunction &function)
+{
+    return signature(function, symbolName(function.name));
+}
+
+string IREmitter::signature(const IRFunction &function, const string &name)
+{
+    string result = (function.isMain() ? "int" : getCType(function.returnType)) + " " + name + "(";
+    for (size_t i = 0; i < function.params.size(); ++i)
+    {
+        if (i > 0)
+            result += ", ";
+        const Instruction *param = function.params[i].get();
+        result += param->noalias ? getCType(param->type) + " restrict " + local(param)
+                                 : declaration(param->type, local(param));
+    }
+    if (function.params.empty())
+        result += "void";
+    return result + ")";
+}
+
+string IREmitter::attributes(const IRFunction &function)
+{
+    switch (function.purity)
+    {
+    case Purity::CONST:
+        return " __attribute__((const))";
+    case Purity::PURE:
+        return " __attribute__((pure))";
+    default:
+        return "";
+    }
+}
+
+// Helpers generated for a function are named nv<kind>_<function>, which no user symbol can spell.
+static string helperName(const string &kind, const string &function)
+{
+    return "nv" + kind + "_" + function;
+}
+
+string IREmitter::local(const Instruction *value)
+{
+    return "t" + to_string(value->id) + (value->name.empty() ? "" : "_" + value->name);
+}
+
+string IREmitter::label(const BasicBlock *block)
+{
+    return "L" + to_string(block->id);
+}
+
+string IREmitter::operand(const Instruction *value)
+{
+    if (value->op == Opcode::GLOBAL)
+        return symbolName(value->text);
+    if (value->op != Opcode::CONST)
+        return local(value);
+
+    switch (value->type->kind)
+    {
+    case TypeKind::FLOAT:
+        return formatFloatLiteral(value->floatValue);
+    case TypeKind::BOOL:
+        return value->intValue ? "1" : "0";
+    case TypeKind::STRING:
+        return value->intValue ? "NULL" : "\"" + value->text + "\"";
+    case TypeKind::TASK:
+    case TypeKind::CHANNEL:
+        return "NULL";
+    case TypeKind::VECTOR:
+        return "(" + value->type->toString() + "){0}";
+    default:
+        return formatIntLiteral(value->intValue);
+    }
+}
+
+string IREmitter::index(const Instruction *access)
+{
+    string value = operand(access->operands[1]);
+    if (!access->checked)
+        return value;
+    auto arrayType = static_pointer_cast<ArrayType>(access->operands[0]->type);
+    return "nova_bounds_check(" + value + ", " + to_string(arrayType->size) + ")";
+}
+
+// The nova_job result member that holds a value of this type, and the suffix of its await helper.
+static pair<string, string> taskField(const shared_ptr<Type> &type)
+{
+    switch (type->kind)
+    {
+    case TypeKind::INT:
+    case TypeKind::BOOL:
+        return {"i", "int"};
+    case TypeKind::FLOAT:
+        return {"f", "float"};
+    case TypeKind::STRING:
+        return {"s", "string"};
+    case TypeKind::VOID:
+        return {"", "void"};
+    default:
+        return {"p", "ptr"};
+    }
+}
+
+// An await may free its job when it is the spawn's only use and runs at most once per spawn, which holds when
+// every loop around the await also contains the spawn.
+static bool releasesTask(const Instruction *await, const LoopInfo &loops)
+{
+    const Instruction *task = await->operands[0];
+    if (task->op != Opcode::CALL || !task->spawn || task->users.size() != 1)
+        return false;
+    for (Loop *loop = loops.loopFor(await->parent); loop; loop = loop->parent)
+    {
+        if (!loop->contains(task))
+            return false;
+    }
+    return true;
+}
+
+// A spawned call receives its array and atomic arguments by pointer. Unless they are globals, they live in the
+// spawning frame, which the task could otherwise outlive.
+static bool borrowsStorage(const Instruction *call)
+{
+    if (call->op != Opcode::CALL || !call->spawn)
+        return false;
+    for (auto operand : call->operands)
+    {
+        if (operand->type->kind == TypeKind::ARRAY && operand->op != Opcode::GLOBAL)
+            return true;
+    }
+    return false;
+}
+
+// The value that `value` adds a constant to, through any chain of additions such as the ones unrolling leaves.
+static const Instruction *offsetBase(const Instruction *value, long long &offset)
+{
+    offset = 0;
+    while (value->operands.size() == 2 && (value->op == Opcode::ADD || value->op == Opcode::SUB))
+    {
+        const Instruction *lhs = value->operands[0];
+        const Instruction *rhs = value->operands[1];
+        if (value->op == Opcode::ADD && lhs->isConstant())
+            swap(lhs, rhs);
+        if (!rhs->isConstant())
+            break;
+        offset += value->op == Opcode::ADD ? rhs->intValue : -(long long)rhs->intValue;
+        value = lhs;
+    }
+    return value;
+}
+
+// Iterations of an innermost loop are independent when its only memory accesses are array elements at offsets
+// from one induction variable that span less than its step, so that no iteration touches an element another one
+// does.
+static bool hasIndependentIterations(Loop *loop)
+{
+    if (!loop->children.empty() || loop->latches.size() != 1)
+        return false;
+
+    const Instruction *variable = nullptr;
+    long long low = LLONG_MAX;
+    long long high = LLONG_MIN;
+    for (auto block : loop->blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            switch (instr->op)
+            {
+            case Opcode::CALL:
+            case Opcode::AWAIT:
+            case Opcode::PRINT:
+            case Opcode::STORE_GLOBAL:
+            case Opcode::ARRAY:
+                return false;
+            case Opcode::LOAD:
+            case Opcode::STORE:
+            {
+                long long offset;
+                const Instruction *base = offsetBase(instr->operands[1], offset);
+                if (base->op != Opcode::PHI || base->parent != loop->header || (variable && base != variable))
+                    return false;
+                variable = base;
+                low = min(low, offset);
+                high = max(high, offset);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+    if (!variable)
+        return false;
+
+    Instruction *next = variable->incomingFor(loop->latches[0]);
+    long long step;
+    return next && offsetBase(next, step) == variable && step != 0 && high - low < llabs(step);
+}
+
+// Independent loops that can be emitted as a C loop, as ranges of `order` from the header to the last block. The
+// loop's blocks must be contiguous and entered by falling through from the preheader.
+static map<size_t, size_t> independentLoops(const IRFunction &function, const vector<BasicBlock *> &order)
+{
+    map<size_t, size_t> ranges;
+    DominatorTree dominators(function);
+    LoopInfo loops(dominators);
+    for (auto loop : loops.innermostFirst())
+    {
+        auto header = find(order.begin(), order.end(), loop->header);
+        size_t start = header - order.begin();
+        size_t end = start + loop->blocks.size() - 1;
+        if (header == order.begin() || *prev(header) != loop->preheader() || end >= order.size() ||
+            !hasIndependentIterations(loop))
+            continue;
+
+        bool contiguous = true;
+        for (size_t i = start; i <= end && contiguous; ++i)
+        {
+            contiguous = loop->contains(order[i]);
+        }
+        if (contiguous)
+            ranges[start] = end;
+    }
+    return ranges;
+}
+
+static bool needsVariable(const Instruction *instr)
+{
+    if (instr->type->kind == TypeKind::VOID || instr->isTerminator() || instr->op == Opcode::ARRAY)
+        return false;
+    return !(instr->op == Opcode::CALL && instr->users.empty());
+}
+
+static string binaryOperator(Opcode op)
+{
+    switch (op)
+    {
+    case Opcode::ADD:
+        return "+";
+    case Opcode::SUB:
+        return "-";
+    case Opcode::MUL:
+        return "*";
+    case Opcode::DIV:
+        return "/";
+    case Opcode::REM:
+        return "%";
+    case Opcode::EQ:
+        return "==";
+    case Opcode::NE:
+        return "!=";
+    case Opcode::LT:
+        return "<";
+    case Opcode::LE:
+        return "<=";
+    case Opcode::GT:
+        return ">";
+    default:
+        return ">=";
+    }
+}
+
+static bool containsType(const shared_ptr<Type> &type, TypeKind kind)
+{
+    if (type->kind == TypeKind::ARRAY)
+        return containsType(static_pointer_cast<ArrayType>(type)->elementType, kind);
+    return type->kind == kind;
+}
+
+static bool usesType(const IRModule &module, TypeKind kind)
+{
+    for (auto &global : module.globals)
+    {
+        if (containsType(global->type, kind))
+            return true;
+    }
+    for (auto &function : module.functions)
+    {
+        if (containsType(function->returnType, kind))
+            return true;
+        for (auto &param : function->params)
+        {
+            if (containsType(param->type, kind))
+                return true;
+        }
+        for (auto &block : function->blocks)
+        {
+            for (auto &instr : block->instructions)
+            {
+                if (containsType(instr->type, kind) || (kind == TypeKind::TASK && instr->op == Opcode::AWAIT))
+                    return true;
+                for (auto operand : instr->operands)
+                {
+                    if (containsType(operand->type, kind))
+                        return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+static bool usesInstruction(const IRModule &module, bool (*matches)(const Instruction *))
+{
+    for (auto &function : module.functions)
+    {
+        for (auto &block : function->blocks)
+        {
+            for (auto &instr : block->instructions)
+            {
+                if (matches(instr.get()))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+void IREmitter::emit(const IRModule &module)
+{
+    writeLine("#include <stdio.h>");
+    writeLine("#include <stdlib.h>");
+    writeLine("#include <string.h>");
+    writeLine("");
+    this->module = &module;
+
+    if (usesInstruction(module, [](const Instruction *instr) { return instr->op == Opcode::PRINT; }))
+    {
+        istringstream runtime(printRuntimeSource);
+        for (string line; getline(runtime, line);)
+        {
+            writeLine(line);
+        }
+        writeLine("");
+    }
+    if (usesInstruction(module, [](const Instruction *instr)
+                        { return instr->op == Opcode::CALL && isInputBuiltin(instr->text); }))
+    {
+        istringstream runtime(inputRuntimeSource);
+        for (string line; getline(runtime, line);)
+        {
+            writeLine(line);
+        }
+        writeLine("");
+    }
+    if (usesInstruction(module, [](const Instruction *instr)
+                        { return instr->op == Opcode::CALL && isMapBuiltin(instr->text); }))
+    {
+        istringstream runtime(mapRuntimeSource);
+        for (string line; getline(runtime, line);)
+        {
+            writeLine(line);
+        }
+        writeLine("");
+    }
+    // Blocked channel operations call back into the task scheduler.
+    bool channels = usesType(module, TypeKind::CHANNEL);
+    if (channels || usesType(module, TypeKind::TASK))
+    {
+        istringstream runtime(spawnRuntimeSource);
+        for (string line; getline(runtime, line);)
+        {
+            writeLine(line);
+        }
+        writeLine("");
+    }
+    if (usesType(module, TypeKind::ATOMIC))
+    {
+        istringstream runtime(atomicRuntimeSource);
+        for (string line; getline(runtime, line);)
+        {
+            writeLine(line);
+        }
+        writeLine("");
+    }
+    if (usesType(module, TypeKind::VECTOR))
+    {
+        istringstream runtime(vectorRuntimeSource);
+        for (string line; getline(runtime, line);)
+        {
+            writeLine(line);
+        }
+        writeLine("");
+    }
+    if (channels)
+    {
+        istringstream runtime(channelRuntimeSource);
+        for (string line; getline(runtime, line);)
+        {
+            writeLine(line);
+        }
+        writeLine("");
+    }
+
+    emitGlobals(module);
+
+    bool floatKeys = false;
+    bool boundsChecks = false;
+    set<string> parallelTasks;
+    set<string> spawnedTasks;
+    for (auto &function : module.functions)
+    {
+        if (!function->isMain())
+            writeLine("static " + signature(*function) + attributes(*function) + ";");
+        for (auto &param : function->params)
+        {
+            floatKeys = floatKeys || (function->memoize && param->type->kind == TypeKind::FLOAT);
+        }
+        for (auto &block : function->blocks)
+        {
+            for (auto &instr : block->instructions)
+            {
+                boundsChecks = boundsChecks || instr->checked ||
+                               (instr->op == Opcode::CALL && instr->text == "nova_bounds_check");
+                if (instr->parallel)
+                    parallelTasks.insert(instr->text);
+                if (instr->spawn)
+                    spawnedTasks.insert(instr->text);
+            }
+        }
+    }
+    writeLine("");
+
+    if (floatKeys)
+    {
+        writeLine("static unsigned nova_float_bits(float value)");
+        writeLine("{");
+        writeLine("    unsigned bits;");
+        writeLine("    memcpy(&bits, &value, sizeof(bits));");
+        writeLine("    return bits;");
+        writeLine("}");
+        writeLine("");
+    }
+
+    if (boundsChecks)
+    {
+        writeLine("static int nova_bounds_check(int index, int size)");
+        writeLine("{");
+        writeLine("    if ((unsigned)index >= (unsigned)size)");
+        writeLine("    {");
+        writeLine("        fprintf(stderr, \"Runtime error: array index %d out of bounds for size %d\\n\", index, size);");
+        writeLine("        exit(1);");
+        writeLine("    }");
+        writeLine("    return index;");
+        writeLine("}");
+        writeLine("");
+    }
+
+    if (!parallelTasks.empty())
+    {
+        istringstream runtime(parallelRuntimeSource);
+        for (string line; getline(runtime, line);)
+        {
+            writeLine(line);
+        }
+        writeLine("");
+        for (auto &name : parallelTasks)
+        {
+            emitParallelTask(*module.getFunction(name));
+        }
+    }
+
+    for (auto &name : spawnedTasks)
+    {
+        emitSpawnTask(*module.getFunction(name));
+    }
+
+    for (auto &function : module.functions)
+    {
+        emitFunction(*function);
+        writeLine("");
+    }
+}
+
+void IREmitter::emitGlobals(const IRModule &module)
+{
+    for (auto &global : module.globals)
+    {
+        string text;
+        if (global->type->kind == TypeKind::ARRAY)
+        {
+            auto arrayType = static_pointer_cast<ArrayType>(global->type);
+            text = declaration(arrayType->elementType, symbolName(global->name)) + "[" +
+                   to_string(arrayType->size) + "]" + arrayAlignment;
+        }
+        else
+        {
+            text = declaration(global->type, symbolName(global->name));
+        }
+        if (global->initializer)
+        {
+            text += " = " + operand(global->initializer.get());
+        }
+        writeLine(text + ";");
+    }
+    if (!module.globals.empty())
+    {
+        writeLine("");
+    }
+}
+
+void IREmitter::emitLocals(const vector<BasicBlock *> &order)
+{
+    map<string, vector<string>> byType;
+    vector<string> typeOrder;
+
+    for (auto block : order)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (instr->op == Opcode::ARRAY)
+            {
+                auto arrayType = static_pointer_cast<ArrayType>(instr->type);
+                writeLine(declaration(arrayType->elementType, local(instr.get())) +
+                          "[" + to_string(arrayType->size) + "]" + arrayAlignment + ";");
+                continue;
+            }
+            if (!needsVariable(instr.get()))
+                continue;
+
+            string ctype = getCType(instr->type);
+            if (!byType.count(ctype))
+                typeOrder.push_back(ctype);
+            byType[ctype].push_back(local(instr.get()));
+        }
+    }
+
+    for (const auto &ctype : typeOrder)
+    {
+        // Each declarator of a grouped pointer declaration needs its own '*'.
+        size_t base = ctype.find_last_not_of('*') + 1;
+        string line = ctype.substr(0, base);
+        const auto &names = byType[ctype];
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            line += (i == 0 ? " " : ", ") + ctype.substr(base) + names[i];
+        }
+        writeLine(line + ";");
+    }
+}
+
+vector<string> IREmitter::phiCopies(const BasicBlock *from, const BasicBlock *to)
+{
+    vector<pair<Instruction *, Instruction *>> copies;
+    unordered_set<const Instruction *> destinations;
+    for (auto phi : to->phis())
+    {
+        Instruction *incoming = phi->incomingFor(const_cast<BasicBlock *>(from));
+        if (incoming && incoming != phi)
+        {
+            copies.push_back({phi, incoming});
+            destinations.insert(phi);
+        }
+    }
+
+    bool conflict = false;
+    for (auto &copy : copies)
+    {
+        if (destinations.count(copy.second))
+            conflict = true;
+    }
+
+    vector<string> lines;
+    if (!conflict)
+    {
+        for (auto &copy : copies)
+        {
+            lines.push_back(local(copy.first) + " = " + operand(copy.second) + ";");
+        }
+        return lines;
+    }
+
+    lines.push_back("{");
+    for (size_t i = 0; i < copies.size(); ++i)
+    {
+        lines.push_back("    " + declaration(copies[i].first->type, "c" + to_string(i)) +
+                        " = " + operand(copies[i].second) + ";");
+    }
+    for (size_t i = 0; i < copies.size(); ++i)
+    {
+        lines.push_back("    " + local(copies[i].first) + " = c" + to_string(i) + ";");
+    }
+    lines.push_back("}");
+    return lines;
+}
+
+void IREmitter::emitEdge(const BasicBlock *from, BasicBlock *to, const BasicBlock *next)
+{
+    for (const auto &line : phiCopies(from, to))
+    {
+        writeLine(line);
+    }
+    if (to != next)
+        writeLine(jump(to));
+}
+
+// The back edge of a loop emitted as a C loop must be a continue for GCC to apply the loop's pragma.
+string IREmitter::jump(const BasicBlock *to)
+{
+    if (to == loopHeader)
+        return "continue;";
+    labelled.insert(to);
+    return "goto " + label(to) + ";";
+}
+
+void IREmitter::emitInstruction(const IRFunction &function, const Instruction *instr, const BasicBlock *next)
+{
+    const auto &ops = instr->operands;
+    string target = needsVariable(instr) ? local(instr) + " = " : "";
+
+    if (instr->isBinary())
+    {
+        writeLine(target + operand(ops[0]) + " " + binaryOperator(instr->op) + " " + operand(ops[1]) + ";");
+        return;
+    }
+
+    switch (instr->op)
+    {
+    case Opcode::NEG:
+        writeLine(target + "-" + operand(ops[0]) + ";");
+        break;
+    case Opcode::NOT:
+        writeLine(target + "!" + operand(ops[0]) + ";");
+        break;
+    case Opcode::ITOF:
+        writeLine(target + "(float)" + operand(ops[0]) + ";");
+        break;
+    case Opcode::CALL:
+    {
+        if (instr->parallel && instr->type->kind != TypeKind::VOID)
+        {
+            string call = helperName("reduce", instr->text) + "(";
+            for (size_t i = 0; i < ops.size(); ++i)
+            {
+                call += (i > 0 ? ", " : "") + operand(ops[i]);
+            }
+            writeLine(target + call + ");");
+            break;
+        }
+        if (instr->parallel)
+        {
+            string env = "NULL";
+            if (ops.size() > 2)
+            {
+                env = "&(struct " + helperName("env", instr->text) + "){";
+                for (size_t i = 2; i < ops.size(); ++i)
+                {
+                    env += (i > 2 ? ", " : "") + operand(ops[i]);
+                }
+                env += "}";
+            }
+            writeLine("nova_parallel_for(" + operand(ops[0]) + ", " + operand(ops[1]) + ", " +
+                      helperName("task", instr->text) + ", " + env + ");");
+            break;
+        }
+
+        if (!module->getFunction(instr->text))
+        {
+            vector<string> args;
+            for (auto op : ops)
+            {
+                args.push_back(operand(op));
+            }
+            if (instr->text == "nova_bounds_check" && args.size() == 3)
+            {
+                writeLine(target + "nova_vector_check(" + args[0] + ", " + args[1] + ", " + args[2] + ");");
+                break;
+            }
+            if (instr->text == "nova_bounds_check")
+            {
+                writeLine(target + "nova_bounds_check(" + args[0] + ", " + args[1] + ");");
+                break;
+            }
+            if (instr->text == "nova_lane" || isVectorBuiltin(instr->text) || vectorType(instr->text))
+            {
+                auto vector = vectorType(instr->text) ? instr->type : ops[instr->text == "select" ? 1 : 0]->type;
+                writeLine(target + vectorCall(instr->text, args, vector) + ";");
+                break;
+            }
+            if (instr->text == "nova_unmap")
+            {
+                if (borrowing)
+                    writeLine("nova_job_join(&nvborrowed);");
+                writeLine(unmapCall(args[0], ops[0]->type) + ";");
+                break;
+            }
+            if (isMapBuiltin(instr->text))
+            {
+                writeLine(target + mapCall(instr->text, args, instr->type) + ";");
+                break;
+            }
+            if (isInputBuiltin(instr->text))
+            {
+                int size = ops.empty() ? 0 : static_pointer_cast<ArrayType>(ops[0]->type)->size;
+                writeLine(target + inputCall(instr->text, args, size) + ";");
+                break;
+            }
+            if (isAtomicBuiltin(instr->text))
+            {
+                args.pop_back();
+                writeLine(target + atomicCall(instr->text, args, ops.back()->text) + ";");
+                break;
+            }
+            auto channel = instr->text == "channel" ? instr->type : ops[0]->type;
+            int size = ops.size() > 1 && ops[1]->type->kind == TypeKind::ARRAY
+                           ? static_pointer_cast<ArrayType>(ops[1]->type)->size
+                           : 0;
+            writeLine(target + channelCall(instr->text, args, channel, size) + ";");
+            break;
+        }
+
+        string call = (instr->spawn ? helperName("spawn", instr->text) : symbolName(instr->text)) + "(";
+        for (size_t i = 0; i < ops.size(); ++i)
+        {
+            if (i > 0)
+                call += ", ";
+            call += operand(ops[i]);
+        }
+        if (borrowsStorage(instr))
+            call = "nova_job_borrow(&nvborrowed, " + call + ")";
+        // Nothing can await a task whose handle is unused, so the handle lets go of it right away.
+        if (instr->spawn && instr->users.empty())
+            call = "nova_job_release(" + call + ")";
+        writeLine(target + call + ");");
+        break;
+    }
+    case Opcode::AWAIT:
+        writeLine(target + "nova_await_" + taskField(instr->type).second + "(" + operand(ops[0]) + ", " +
+                  (releasing.count(instr) ? "1" : "0") + ");");
+        break;
+    case Opcode::LOAD:
+        if (instr->speculative)
+        {
+            auto arrayType = static_pointer_cast<ArrayType>(ops[0]->type);
+            string zero = instr->type->kind == TypeKind::FLOAT ? "0.0f" : "0";
+            writeLine(target + "(unsigned)" + operand(ops[1]) + " < " + to_string(arrayType->size) + "u ? " +
+                      operand(ops[0]) + "[" + operand(ops[1]) + "] : " + zero + ";");
+        }
+        else
+        {
+            writeLine(target + operand(ops[0]) + "[" + index(instr) + "];");
+        }
+        break;
+    case Opcode::STORE:
+        writeLine(operand(ops[0]) + "[" + index(instr) + "] = " + operand(ops[2]) + ";");
+        break;
+    case Opcode::LOAD_GLOBAL:
+        writeLine(target + symbolName(instr->text) + ";");
+        break;
+    case Opcode::STORE_GLOBAL:
+        writeLine(symbolName(instr->text) + " = " + operand(ops[0]) + ";");
+        break;
+    case Opcode::PRINT:
+    {
+        writeLine(printCall(ops[0]->type, operand(ops[0])) + ";");
+        break;
+    }
+    case Opcode::BR:
+        emitEdge(instr->parent, instr->blocks[0], next);
+        break;
+    case Opcode::CONDBR:
+    {
+        BasicBlock *ifTrue = instr->blocks[0];
+        BasicBlock *ifFalse = instr->blocks[1];
+        string cond = operand(ops[0]);
+        vector<string> trueCopies = phiCopies(instr->parent, ifTrue);
+        vector<string> falseCopies = phiCopies(instr->parent, ifFalse);
+
+        if (trueCopies.empty() && ifTrue == next)
+        {
+            if (falseCopies.empty())
+            {
+                writeLine("if (!" + cond + ") " + jump(ifFalse));
+            }
+            else
+            {
+                writeLine("if (!" + cond + ") {");
+                indent++;
+                emitEdge(instr->parent, ifFalse, nullptr);
+                indent--;
+                writeLine("}");
+            }
+            break;
+        }
+
+        if (trueCopies.empty())
+        {
+            writeLine("if (" + cond + ") " + jump(ifTrue));
+        }
+        else
+        {
+            writeLine("if (" + cond + ") {");
+            indent++;
+            emitEdge(instr->parent, ifTrue, nullptr);
+            indent--;
+            writeLine("}");
+        }
+        emitEdge(instr->parent, ifFalse, next);
+        break;
+    }
+    case Opcode::RET:
+        if (borrowing)
+            writeLine("nova_job_join(&nvborrowed);");
+        if (!ops.empty())
+            writeLine("return " + operand(ops[0]) + ";");
+        else if (function.isMain())
+            writeLine("return 0;");
+        else
+            writeLine("return;");
+        break;
+    default:
+        break;
+    }
+}
+
+void IREmitter::findReleasingAwaits(const IRFunction &function)
+{
+    releasing.clear();
+    vector<const Instruction *> awaits;
+    for (auto &block : function.blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (instr->op == Opcode::AWAIT)
+                awaits.push_back(instr.get());
+        }
+    }
+    if (awaits.empty())
+        return;
+
+    DominatorTree dominators(function);
+    LoopInfo loops(dominators);
+    for (auto await : awaits)
+    {
+        if (releasesTask(await, loops))
+            releasing.insert(await);
+    }
+}
+
+void IREmitter::emitFunction(const IRFunction &function)
+{
+    vector<BasicBlock *> order = reversePostOrder(function);
+    findReleasingAwaits(function);
+    borrowing = false;
+    for (auto block : order)
+    {
+        for (auto &instr : block->instructions)
+        {
+            borrowing = borrowing || borrowsStorage(instr.get());
+        }
+    }
+
+    if (function.memoize)
+    {
+        emitMemoWrapper(function);
+        writeLine("static " + signature(function, helperName("impl", function.name)));
+    }
+    else
+    {
+        writeLine((function.isMain() ? "" : "static ") + signature(function));
+    }
+    writeLine("{");
+    indent++;
+    emitLocals(order);
+    if (borrowing)
+        writeLine("nova_job *nvborrowed = NULL;");
+    for (auto &param : function.params)
+    {
+        if (param->type->kind == TypeKind::ARRAY && !param->users.empty())
+            writeLine(local(param.get()) + " = __builtin_assume_aligned(" + local(param.get()) + ", 64);");
+    }
+
+    // Loops proven independent become `for (; 1;)` loops, since GCC only accepts ivdep on a C loop with a
+    // condition. Their last block cannot fall through, as that would start the next iteration.
+    map<size_t, size_t> loops = independentLoops(function, order);
+    size_t end = 0;
+    labelled.clear();
+    vector<string> bodies;
+    ostringstream body;
+    current = &body;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (loops.count(i))
+        {
+            loopHeader = order[i];
+            end = loops[i];
+            indent++;
+        }
+        body.str("");
+        const BasicBlock *next = i + 1 < order.size() && !(loopHeader && i == end) ? order[i + 1] : nullptr;
+        for (auto &instr : order[i]->instructions)
+        {
+            emitInstruction(function, instr.get(), next);
+        }
+        bodies.push_back(body.str());
+        if (loopHeader && i == end)
+        {
+            loopHeader = nullptr;
+            indent--;
+        }
+    }
+    current = &output;
+
+    bool inLoop = false;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (loops.count(i))
+        {
+            writeLine("#pragma GCC ivdep");
+            writeLine("for (; 1;) {");
+            end = loops[i];
+            inLoop = true;
+        }
+        if (labelled.count(order[i]))
+        {
+            *current << label(order[i]) << ":" << endl;
+        }
+        *current << bodies[i];
+        if (inLoop && i == end)
+        {
+            writeLine("}");
+            inLoop = false;
+        }
+    }
+
+    indent--;
+    writeLine("}");
+}
+
+static string reductionIdentity(const IRFunction &function)
+{
+    bool isFloat = function.returnType->kind == TypeKind::FLOAT;
+    if (function.reduction == "+")
+        return isFloat ? "0.0f" : "0";
+    if (function.reduction == "*")
+        return isFloat ? "1.0f" : "1";
+    if (function.reduction == "min")
+        return isFloat ? "__builtin_inff()" : "2147483647";
+    return isFloat ? "-__builtin_inff()" : "(-2147483647 - 1)";
+}
+
+static string reductionCombine(const IRFunction &function, const string &acc, const string &value)
+{
+    if (function.reduction == "min")
+        return value + " < " + acc + " ? " + value + " : " + acc;
+    if (function.reduction == "max")
+        return value + " > " + acc + " ? " + value + " : " + acc;
+    return acc + " " + function.reduction + " " + value;
+}
+
+void IREmitter::emitParallelTask(const IRFunction &function)
+{
+    bool reduces = !function.reduction.empty();
+    size_t first = reduces ? 3 : 2;
+    string resultType = getCType(function.returnType);
+
+    string args;
+    if (function.params.size() > first || reduces)
+    {
+        writeLine("struct " + helperName("env", function.name));
+        writeLine("{");
+        for (size_t i = first; i < function.params.size(); ++i)
+        {
+            writeLine("    " + declaration(function.params[i]->type, "a" + to_string(i)) + ";");
+            args += ", env->a" + to_string(i);
+        }
+        if (reduces)
+            writeLine("    " + resultType + " partial[NOVA_MAX_WORKERS];");
+        writeLine("};");
+        writeLine("");
+    }
+
+    writeLine("static void " + helperName("task", function.name) + "(int lo, int hi, void *data)");
+    writeLine("{");
+    if (function.params.size() > first || reduces)
+        writeLine("    struct " + helperName("env", function.name) + " *env = data;");
+    else
+        writeLine("    (void)data;");
+    if (reduces)
+        writeLine("    env->partial[nova_worker_id] = " + symbolName(function.name) +
+                  "(lo, hi, env->partial[nova_worker_id]" + args + ");");
+    else
+        writeLine("    " + symbolName(function.name) + "(lo, hi" + args + ");");
+    writeLine("}");
+    writeLine("");
+
+    if (!reduces)
+        return;
+
+    string params = "int lo, int hi, " + declaration(function.returnType, "init");
+    for (size_t i = first; i < function.params.size(); ++i)
+    {
+        params += ", " + declaration(function.params[i]->type, "a" + to_string(i));
+    }
+    writeLine("static " + resultType + " " + helperName("reduce", function.name) + "(" + params + ")");
+    writeLine("{");
+    writeLine("    struct " + helperName("env", function.name) + " env;");
+    for (size_t i = first; i < function.params.size(); ++i)
+    {
+        writeLine("    env.a" + to_string(i) + " = a" + to_string(i) + ";");
+    }
+    writeLine("    env.partial[0] = init;");
+    writeLine("    for (int i = 1; i < NOVA_MAX_WORKERS; ++i)");
+    writeLine("        env.partial[i] = " + reductionIdentity(function) + ";");
+    writeLine("    nova_parallel_for(lo, hi, " + helperName("task", function.name) + ", &env);");
+    writeLine("    " + resultType + " result = env.partial[0];");
+    writeLine("    for (int i = 1; i < NOVA_MAX_WORKERS; ++i)");
+    writeLine("        result = " + reductionCombine(function, "result", "env.partial[i]") + ";");
+    writeLine("    return result;");
+    writeLine("}");
+    writeLine("");
+}
+
+void IREmitter::emitSpawnTask(const IRFunction &function)
+{
+    string job = "struct " + helperName("job", function.name);
+    writeLine(job);
+    writeLine("{");
+    writeLine("    nova_job job;");
+    string params;
+    string args;
+    for (size_t i = 0; i < function.params.size(); ++i)
+    {
+        string name = "a" + to_string(i);
+        writeLine("    " + declaration(function.params[i]->type, name) + ";");
+        params += (i > 0 ? ", " : "") + declaration(function.params[i]->type, name);
+        args += (i > 0 ? ", self->" : "self->") + name;
+    }
+    writeLine("};");
+    writeLine("");
+
+    writeLine("static void " + helperName("run", function.name) + "(nova_job *job)");
+    writeLine("{");
+    writeLine("    " + job + " *self = (" + job + " *)job;");
+    if (function.returnType->kind == TypeKind::VOID)
+        writeLine("    " + symbolName(function.name) + "(" + args + ");");
+    else
+        writeLine("    self->job.result." + taskField(function.returnType).first + " = " +
+                  symbolName(function.name) + "(" + args + ");");
+    writeLine("}");
+    writeLine("");
+
+    writeLine("static nova_job *" + helperName("spawn", function.name) + "(" + (params.empty() ? "void" : params) +
+              ")");
+    writeLine("{");
+    writeLine("    " + job + " *self = nova_job_alloc(sizeof(" + job + "));");
+    writeLine("    self->job.run = " + helperName("run", function.name) + ";");
+    for (size_t i = 0; i < function.params.size(); ++i)
+    {
+        writeLine("    self->a" + to_string(i) + " = a" + to_string(i) + ";");
+    }
+    writeLine("    return nova_spawn(&self->job);");
+    writeLine("}");
+    writeLine("");
+}
+
+void IREmitter::emitMemoWrapper(const IRFunction &function)
+{
+    const int tableSize = 4096;
+    string table = helperName("memo", function.name);
+    string returnType = getCType(function.returnType);
+
+    vector<string> keys;
+    for (auto &param : function.params)
+    {
+        string name = local(param.get());
+        keys.push_back(param->type->kind == TypeKind::FLOAT ? "nova_float_bits(" + name + ")" : name);
+    }
+
+    writeLine("static " + signature(function, helperName("impl", function.name)) + ";");
+    writeLine("");
+    writeLine("static struct");
+    writeLine("{");
+    writeLine("    int valid;");
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        string keyType = function.params[i]->type->kind == TypeKind::FLOAT ? "unsigned" : "int";
+        writeLine("    " + keyType + " k" + to_string(i) + ";");
+    }
+    writeLine("    " + returnType + " value;");
+    writeLine("} " + table + "[" + to_string(tableSize) + "];");
+    writeLine("");
+
+    writeLine("static " + signature(function));
+    writeLine("{");
+    indent++;
+    writeLine("unsigned hash = 2166136261u;");
+    for (auto &key : keys)
+    {
+        writeLine("hash = (hash ^ (unsigned)" + key + ") * 16777619u;");
+    }
+    writeLine("unsigned slot = (hash ^ (hash >> 16)) & " + to_string(tableSize - 1) + "u;");
+
+    string condition = table + "[slot].valid";
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        condition += " && " + table + "[slot].k" + to_string(i) + " == " + keys[i];
+    }
+    writeLine("if (" + condition + ")");
+    writeLine("    return " + table + "[slot].value;");
+
+    string args;
+    for (size_t i = 0; i < function.params.size(); ++i)
+    {
+        args += (i > 0 ? ", " : "") + local(function.params[i].get());
+    }
+    writeLine(returnType + " result = " + helperName("impl", function.name) + "(" + args + ");");
+    writeLine(table + "[slot].valid = 1;");
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        writeLine(table + "[slot].k" + to_string(i) + " = " + keys[i] + ";");
+    }
+    writeLine(table + "[slot].value = result;");
+    writeLine("return result;");
+    indent--;
+    writeLine("}");
+    writeLine("");
+}
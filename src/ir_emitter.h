@@ -0,0 +1,60 @@
+#ifndef IR_EMITTER_H
+#define IR_EMITTER_H
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "ir.h"
+
+using namespace std;
+
+class IREmitter
+{
+private:
+    ostream &output;
+    int indent;
+    ostream *current;
+    const IRModule *module;
+    unordered_set<const BasicBlock *> labelled;
+    unordered_set<const Instruction *> releasing;
+    bool borrowing;
+    const BasicBlock *loopHeader;
+
+    void writeIndent();
+    void writeLine(const string &text);
+    string getCType(shared_ptr<Type> type);
+    string declaration(shared_ptr<Type> type, const string &name);
+    string signature(const IRFunction &function);
+    string signature(const IRFunction &function, const string &name);
+    string attributes(const IRFunction &function);
+    string operand(const Instruction *value);
+    string index(const Instruction *access);
+    string local(const Instruction *value);
+    string label(const BasicBlock *block);
+    string jump(const BasicBlock *to);
+
+    void emitGlobals(const IRModule &module);
+    void findReleasingAwaits(const IRFunction &function);
+    void emitFunction(const IRFunction &function);
+    void emitMemoWrapper(const IRFunction &function);
+    void emitParallelTask(const IRFunction &function);
+    void emitSpawnTask(const IRFunction &function);
+    void emitLocals(const vector<BasicBlock *> &order);
+    void emitInstruction(const IRFunction &function, const Instruction *instr, const BasicBlock *next);
+    void emitEdge(const BasicBlock *from, BasicBlock *to, const BasicBlock *next);
+    vector<string> phiCopies(const BasicBlock *from, const BasicBlock *to);
+
+public:
+    IREmitter(ostream &output);
+
+    void emit(const IRModule &module);
+};
+
+// C name of a user function or global. Every other name in the generated C (locals, labels, helpers and the
+// runtime) starts differently, so user names cannot collide with it.
+string symbolName(const string &name);
+string formatFloatLiteral(float value);
+string formatIntLiteral(int value);
+
+#endif
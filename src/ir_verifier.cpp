@@ -0,0 +1,290 @@
+#include "ir_verifier.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include "cfg.h"
+
+using namespace std;
+
+IRVerifier::IRVerifier() : module(nullptr) {}
+
+void IRVerifier::fail(const IRFunction &function, const string &message)
+{
+    errors.push_back("in function '" + function.name + "': " + message);
+}
+
+void IRVerifier::fail(const IRFunction &function, const Instruction *instr, const string &message)
+{
+    fail(function, opcodeName(instr->op) + " " + valueName(instr) + ": " + message);
+}
+
+bool IRVerifier::verify(const IRModule &target)
+{
+    module = &target;
+    bool ok = true;
+    for (auto &function : target.functions)
+    {
+        ok = verifyFunction(*function) && ok;
+    }
+    module = nullptr;
+    return ok;
+}
+
+static bool sameType(const shared_ptr<Type> &a, const shared_ptr<Type> &b)
+{
+    return a && b && a->equals(b.get());
+}
+
+// Vector comparisons produce a lane mask instead of a bool.
+static shared_ptr<Type> comparisonType(const shared_ptr<Type> &operand)
+{
+    if (operand->kind == TypeKind::VECTOR)
+        return static_pointer_cast<VectorType>(operand)->maskType();
+    return BoolType;
+}
+
+void IRVerifier::verifyInstruction(const IRFunction &function, const Instruction *instr)
+{
+    const auto &ops = instr->operands;
+
+    if (instr->isBinary())
+    {
+        if (ops.size() != 2)
+        {
+            fail(function, instr, "expected two operands");
+            return;
+        }
+        if (!sameType(ops[0]->type, ops[1]->type))
+            fail(function, instr, "operand types differ");
+        if (!sameType(instr->type, instr->isComparison() ? comparisonType(ops[0]->type) : ops[0]->type))
+            fail(function, instr, "result type does not match operands");
+        return;
+    }
+
+    switch (instr->op)
+    {
+    case Opcode::NEG:
+    case Opcode::NOT:
+        if (ops.size() != 1 || !sameType(instr->type, ops[0]->type))
+            fail(function, instr, "malformed unary operation");
+        break;
+    case Opcode::ITOF:
+        if (ops.size() != 1 || ops[0]->type->kind != TypeKind::INT || instr->type->kind != TypeKind::FLOAT)
+            fail(function, instr, "itof converts int to float");
+        break;
+    case Opcode::PHI:
+        for (auto operand : ops)
+        {
+            if (!sameType(operand->type, instr->type))
+                fail(function, instr, "incoming value type differs from phi type");
+        }
+        break;
+    case Opcode::LOAD:
+    case Opcode::STORE:
+    {
+        size_t expected = instr->op == Opcode::LOAD ? 2 : 3;
+        if (ops.size() != expected || ops[0]->type->kind != TypeKind::ARRAY || ops[1]->type->kind != TypeKind::INT)
+        {
+            fail(function, instr, "expected array and int index operands");
+            break;
+        }
+        auto element = static_pointer_cast<ArrayType>(ops[0]->type)->elementType;
+        const shared_ptr<Type> &accessed = instr->op == Opcode::LOAD ? instr->type : ops[2]->type;
+        if (!sameType(element, accessed))
+            fail(function, instr, "accessed type differs from element type");
+        break;
+    }
+    case Opcode::LOAD_GLOBAL:
+    case Opcode::STORE_GLOBAL:
+    {
+        IRGlobal *global = module ? module->getGlobal(instr->text) : nullptr;
+        if (module && !global)
+        {
+            fail(function, instr, "unknown global '" + instr->text + "'");
+            break;
+        }
+        if (global)
+        {
+            const shared_ptr<Type> &accessed = instr->op == Opcode::LOAD_GLOBAL ? instr->type : ops[0]->type;
+            if (!sameType(global->type, accessed))
+                fail(function, instr, "type differs from global '" + instr->text + "'");
+        }
+        break;
+    }
+    case Opcode::CALL:
+    {
+        IRFunction *callee = module ? module->getFunction(instr->text) : nullptr;
+        if (!callee)
+            break;
+        if (callee->params.size() != ops.size())
+        {
+            fail(function, instr, "argument count mismatch calling '" + instr->text + "'");
+            break;
+        }
+        for (size_t i = 0; i < ops.size(); ++i)
+        {
+            if (!sameType(callee->params[i]->type, ops[i]->type))
+                fail(function, instr, "argument type mismatch calling '" + instr->text + "'");
+        }
+        if (instr->spawn ? instr->type->kind != TypeKind::TASK ||
+                               !sameType(callee->returnType, static_pointer_cast<TaskType>(instr->type)->resultType)
+                         : !sameType(callee->returnType, instr->type))
+            fail(function, instr, "return type mismatch calling '" + instr->text + "'");
+        break;
+    }
+    case Opcode::AWAIT:
+        if (ops.size() != 1 || ops[0]->type->kind != TypeKind::TASK ||
+            !sameType(static_pointer_cast<TaskType>(ops[0]->type)->resultType, instr->type))
+            fail(function, instr, "expected a task operand of the result type");
+        break;
+    case Opcode::PRINT:
+        if (ops.size() != 1)
+            fail(function, instr, "expected one operand");
+        break;
+    case Opcode::BR:
+        if (instr->blocks.size() != 1 || !ops.empty())
+            fail(function, instr, "expected one target");
+        break;
+    case Opcode::CONDBR:
+        if (instr->blocks.size() != 2 || ops.size() != 1 || ops[0]->type->kind != TypeKind::BOOL)
+            fail(function, instr, "expected bool condition and two targets");
+        break;
+    case Opcode::RET:
+        if (function.returnType->kind == TypeKind::VOID ? !ops.empty()
+                                                        : ops.size() != 1 || !sameType(ops[0]->type, function.returnType))
+            fail(function, instr, "return value does not match function type");
+        break;
+    default:
+        break;
+    }
+}
+
+bool IRVerifier::verifyFunction(const IRFunction &function)
+{
+    size_t errorCount = errors.size();
+
+    if (function.blocks.empty())
+    {
+        fail(function, "function has no blocks");
+        return false;
+    }
+
+    unordered_set<const BasicBlock *> ownBlocks;
+    for (auto &block : function.blocks)
+    {
+        ownBlocks.insert(block.get());
+    }
+
+    for (auto &block : function.blocks)
+    {
+        if (block->parent != &function)
+            fail(function, "bb" + to_string(block->id) + " has wrong parent");
+
+        Instruction *term = block->terminator();
+        if (!term)
+        {
+            fail(function, "bb" + to_string(block->id) + " has no terminator");
+            continue;
+        }
+
+        for (auto succ : block->successors())
+        {
+            if (!ownBlocks.count(succ))
+                fail(function, "bb" + to_string(block->id) + " branches outside the function");
+            else if (count(succ->preds.begin(), succ->preds.end(), block.get()) !=
+                     count(term->blocks.begin(), term->blocks.end(), succ))
+                fail(function, "bb" + to_string(succ->id) + " predecessor list is stale");
+        }
+        for (auto pred : block->preds)
+        {
+            vector<BasicBlock *> succs = pred->successors();
+            if (find(succs.begin(), succs.end(), block.get()) == succs.end())
+                fail(function, "bb" + to_string(block->id) + " lists bb" + to_string(pred->id) + " as a predecessor");
+        }
+
+        bool seenNonPhi = false;
+        for (auto &instr : block->instructions)
+        {
+            if (instr->parent != block.get() || instr->function != &function)
+                fail(function, instr.get(), "has wrong parent");
+            if (instr->isTerminator() && instr.get() != term)
+                fail(function, instr.get(), "terminator in the middle of a block");
+
+            if (instr->op == Opcode::PHI)
+            {
+                if (seenNonPhi)
+                    fail(function, instr.get(), "phi after non-phi instruction");
+                if (instr->blocks.size() != instr->operands.size() || instr->blocks.size() != block->preds.size())
+                    fail(function, instr.get(), "incoming count does not match predecessors");
+                for (auto pred : block->preds)
+                {
+                    if (!instr->incomingFor(pred))
+                        fail(function, instr.get(), "missing incoming value for bb" + to_string(pred->id));
+                }
+            }
+            else
+            {
+                seenNonPhi = true;
+            }
+
+            for (auto operand : instr->operands)
+            {
+                if (operand->function != &function)
+                    fail(function, instr.get(), "uses a value from another function");
+                else if (count(operand->users.begin(), operand->users.end(), instr.get()) !=
+                         count(instr->operands.begin(), instr->operands.end(), operand))
+                    fail(function, instr.get(), "use list of " + valueName(operand) + " is stale");
+                if (operand->parent && !ownBlocks.count(operand->parent))
+                    fail(function, instr.get(), "uses " + valueName(operand) + " which is not in the function");
+                if (operand->type->kind == TypeKind::VOID)
+                    fail(function, instr.get(), "uses a void value");
+            }
+
+            verifyInstruction(function, instr.get());
+        }
+    }
+
+    if (errors.size() != errorCount)
+        return false;
+
+    DominatorTree domTree(function);
+    unordered_map<const Instruction *, size_t> position;
+    for (auto &block : function.blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            position.emplace(instr.get(), position.size());
+        }
+    }
+    for (auto &block : function.blocks)
+    {
+        if (!domTree.isReachable(block.get()))
+            continue;
+        for (auto &instr : block->instructions)
+        {
+            for (size_t i = 0; i < instr->operands.size(); ++i)
+            {
+                Instruction *operand = instr->operands[i];
+                bool ok;
+                if (instr->op == Opcode::PHI)
+                {
+                    BasicBlock *incoming = instr->blocks[i];
+                    ok = !operand->parent || !domTree.isReachable(incoming) ||
+                         domTree.dominates(operand->parent, incoming);
+                }
+                else if (operand->parent == block.get())
+                {
+                    ok = position.at(operand) < position.at(instr.get());
+                }
+                else
+                {
+                    ok = domTree.dominates(operand, instr.get());
+                }
+                if (!ok)
+                    fail(function, instr.get(), "operand " + valueName(operand) + " does not dominate its use");
+            }
+        }
+    }
+
+    return errors.size() == errorCount;
+}
@@ -0,0 +1,28 @@
+#ifndef IR_VERIFIER_H
+#define IR_VERIFIER_H
+
+#include <string>
+#include <vector>
+#include "ir.h"
+
+using namespace std;
+
+class IRVerifier
+{
+private:
+    vector<string> errors;
+    const IRModule *module;
+
+    void fail(const IRFunction &function, const string &message);
+    void fail(const IRFunction &function, const Instruction *instr, const string &message);
+    void verifyInstruction(const IRFunction &function, const Instruction *instr);
+
+public:
+    IRVerifier();
+
+    bool verify(const IRModule &module);
+    bool verifyFunction(const IRFunction &function);
+    const vector<string> &getErrors() const { return errors; }
+};
+
+#endif
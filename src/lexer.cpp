@@ -17,6 +17,17 @@ unordered_map<string, TokenType> Lexer::keywords = {
     {"else", TOKEN_ELSE},
     {"while", TOKEN_WHILE},
     {"for", TOKEN_FOR},
+    {"parallel", TOKEN_PARALLEL},
+    {"spawn", TOKEN_SPAWN},
+    {"await", TOKEN_AWAIT},
+    {"task", TOKEN_TASK},
+    {"channel", TOKEN_CHANNEL},
+    {"atomic", TOKEN_ATOMIC},
+    {"vec4f", TOKEN_VECTOR},
+    {"vec8f", TOKEN_VECTOR},
+    {"vec4i", TOKEN_VECTOR},
+    {"vec8i", TOKEN_VECTOR},
+    {"noalias", TOKEN_NOALIAS},
     {"print", TOKEN_PRINT}};
 
 Lexer::Lexer(const string &input)
@@ -253,6 +264,8 @@ Token Lexer::nextToken()
         return Token(TOKEN_COMMA, ",", line, startColumn);
     case '.':
         return Token(TOKEN_DOT, ".", line, startColumn);
+    case '@':
+        return Token(TOKEN_AT, "@", line, startColumn);
     default:
         return Token(TOKEN_ERROR, string(1, c), line, startColumn);
     }
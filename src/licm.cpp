@@ -0,0 +1,137 @@
+#include "licm.h"
+#include "alias_analysis.h"
+
+using namespace std;
+
+bool LICM::isSafeToSpeculate(const Instruction *instr)
+{
+    switch (instr->op)
+    {
+    case Opcode::DIV:
+    case Opcode::REM:
+    {
+        if (instr->type->kind != TypeKind::INT)
+            return true;
+        const Instruction *divisor = instr->operands[1];
+        return divisor->isConstant() && divisor->intValue != 0 && divisor->intValue != -1;
+    }
+    case Opcode::LOAD:
+    {
+        const Instruction *index = instr->operands[1];
+        auto arrayType = static_pointer_cast<ArrayType>(instr->operands[0]->type);
+        return index->isConstant() && index->intValue >= 0 && index->intValue < arrayType->size;
+    }
+    default:
+        return !instr->mayTrap();
+    }
+}
+
+bool LICM::isGuaranteedToExecute(const Instruction *instr, Loop *loop, const DominatorTree &dominators)
+{
+    vector<BasicBlock *> exiting = loop->exitingBlocks();
+    if (exiting.empty())
+        return instr->parent == loop->header;
+
+    for (auto block : exiting)
+    {
+        if (!dominators.dominates(instr->parent, block))
+            return false;
+    }
+    return true;
+}
+
+bool LICM::isClobberedIn(const Instruction *load, Loop *loop)
+{
+    for (auto block : loop->blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (mayClobber(instr.get(), load, *purity))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool LICM::hoistFrom(Loop *loop, const DominatorTree &dominators)
+{
+    BasicBlock *preheader = loop->preheader();
+    if (!preheader)
+        return false;
+
+    bool changed = false;
+    for (auto block : loop->blocks)
+    {
+        vector<Instruction *> candidates;
+        for (auto &instr : block->instructions)
+        {
+            candidates.push_back(instr.get());
+        }
+
+        for (auto instr : candidates)
+        {
+            switch (instr->op)
+            {
+            case Opcode::PHI:
+            case Opcode::ARRAY:
+            case Opcode::CALL:
+                continue;
+            case Opcode::LOAD:
+            case Opcode::LOAD_GLOBAL:
+                if (isClobberedIn(instr, loop))
+                    continue;
+                break;
+            default:
+                if (instr->hasSideEffects() || instr->readsMemory())
+                    continue;
+            }
+
+            bool invariant = true;
+            for (auto operand : instr->operands)
+            {
+                invariant = invariant && loop->isInvariant(operand);
+            }
+            if (!invariant)
+                continue;
+
+            if (!isSafeToSpeculate(instr) && !isGuaranteedToExecute(instr, loop, dominators))
+            {
+                if (instr->op != Opcode::LOAD || instr->checked)
+                    continue;
+                instr->speculative = true;
+            }
+
+            preheader->insertBefore(preheader->terminator(), block->detach(instr));
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool LICM::runOnFunction(IRFunction &function)
+{
+    bool changed = insertPreheaders(function);
+
+    DominatorTree dominators(function);
+    LoopInfo loops(dominators);
+    for (auto loop : loops.innermostFirst())
+    {
+        changed = hoistFrom(loop, dominators) || changed;
+    }
+    return changed;
+}
+
+bool LICM::runOnModule(IRModule &module)
+{
+    PurityAnalysis analysis(module);
+    purity = &analysis;
+
+    bool changed = false;
+    for (auto &function : module.functions)
+    {
+        changed = runOnFunction(*function) || changed;
+    }
+
+    purity = nullptr;
+    return changed;
+}
@@ -0,0 +1,28 @@
+#ifndef LICM_H
+#define LICM_H
+
+#include "loop_info.h"
+#include "pass_manager.h"
+#include "purity.h"
+
+using namespace std;
+
+class LICM : public Pass
+{
+private:
+    PurityAnalysis *purity;
+
+    bool isSafeToSpeculate(const Instruction *instr);
+    bool isGuaranteedToExecute(const Instruction *instr, Loop *loop, const DominatorTree &dominators);
+    bool isClobberedIn(const Instruction *load, Loop *loop);
+    bool hoistFrom(Loop *loop, const DominatorTree &dominators);
+    bool runOnFunction(IRFunction &function);
+
+public:
+    LICM() : purity(nullptr) {}
+
+    string name() const override { return "licm"; }
+    bool runOnModule(IRModule &module) override;
+};
+
+#endif
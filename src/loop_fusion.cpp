@@ -0,0 +1,333 @@
+#include "loop_fusion.h"
+#include <algorithm>
+#include "alias_analysis.h"
+
+using namespace std;
+
+bool LoopFusion::isSimple(FusionCandidate &candidate)
+{
+    Loop *loop = candidate.loop;
+    if (loop->latches.size() != 1 || loop->latches[0] == loop->header || !loop->preheader())
+        return false;
+
+    candidate.exit = loop->headerExit();
+    if (!candidate.exit)
+        return false;
+
+    candidate.analysis = make_unique<InductionAnalysis>(loop);
+    candidate.condition = candidate.analysis->exitCondition();
+    if (!candidate.condition.variable || !loop->isInvariant(candidate.condition.bound))
+        return false;
+
+    for (auto block : loop->blocks)
+    {
+        if (block->terminator()->op == Opcode::RET)
+            return false;
+    }
+    return true;
+}
+
+bool LoopFusion::sameIterationSpace(const FusionCandidate &first, const FusionCandidate &second)
+{
+    const InductionVariable *a = first.condition.variable;
+    const InductionVariable *b = second.condition.variable;
+    if (a->step != b->step)
+        return false;
+
+    TripCount firstTrip = first.analysis->tripCount();
+    TripCount secondTrip = second.analysis->tripCount();
+    if (firstTrip.known && secondTrip.known)
+        return firstTrip.count == secondTrip.count;
+
+    return a->start == b->start && first.condition.bound == second.condition.bound &&
+           first.condition.predicate == second.condition.predicate;
+}
+
+bool LoopFusion::normalizedIndex(const FusionCandidate &candidate, const Instruction *index, long long &offset)
+{
+    int constant = 0;
+    const InductionVariable *variable = candidate.analysis->affineOffset(index, constant);
+    if (!variable || variable != candidate.condition.variable)
+        return false;
+
+    offset = constant;
+    if (variable->start->isConstant())
+        offset += variable->start->intValue;
+    return true;
+}
+
+static bool isGlobalAccess(const Instruction *instr)
+{
+    return instr->op == Opcode::LOAD_GLOBAL || instr->op == Opcode::STORE_GLOBAL;
+}
+
+bool LoopFusion::conflicts(const FusionCandidate &first, const Instruction *a,
+                           const FusionCandidate &second, const Instruction *b)
+{
+    // A failing bounds check is as observable as output, so it must not be reordered against it.
+    auto effectsOf = [this](const Instruction *instr)
+    {
+        FunctionEffects effects;
+        switch (instr->op)
+        {
+        case Opcode::LOAD:
+        case Opcode::LOAD_GLOBAL:
+            effects.readsMemory = true;
+            effects.performsIO = instr->checked;
+            break;
+        case Opcode::STORE:
+        case Opcode::STORE_GLOBAL:
+            effects.writesMemory = true;
+            effects.performsIO = instr->checked;
+            break;
+        case Opcode::PRINT:
+            effects.performsIO = true;
+            break;
+        case Opcode::CALL:
+        {
+            IRFunction *callee = instr->function->module->getFunction(instr->text);
+            if (callee)
+                effects = purity->effectsOf(callee);
+            else
+                effects.readsMemory = effects.writesMemory = effects.performsIO = true;
+            break;
+        }
+        case Opcode::AWAIT:
+            effects.readsMemory = effects.writesMemory = effects.performsIO = true;
+            break;
+        default:
+            break;
+        }
+        return effects;
+    };
+
+    FunctionEffects effectsA = effectsOf(a);
+    FunctionEffects effectsB = effectsOf(b);
+    if (effectsA.performsIO && effectsB.performsIO)
+        return true;
+    if (!effectsA.writesMemory && !effectsB.writesMemory)
+        return false;
+    if (!(effectsA.readsMemory || effectsA.writesMemory) || !(effectsB.readsMemory || effectsB.writesMemory))
+        return false;
+    if (a->op == Opcode::CALL || b->op == Opcode::CALL || a->op == Opcode::AWAIT || b->op == Opcode::AWAIT)
+        return true;
+
+    if (isGlobalAccess(a) || isGlobalAccess(b))
+        return isGlobalAccess(a) && isGlobalAccess(b) && a->text == b->text;
+
+    if (aliasAccesses(a, b) == AliasResult::NO_ALIAS)
+        return false;
+    if (aliasArrays(a->operands[0], b->operands[0]) != AliasResult::MUST_ALIAS)
+        return true;
+
+    long long offsetA;
+    long long offsetB;
+    if (!normalizedIndex(first, a->operands[1], offsetA) || !normalizedIndex(second, b->operands[1], offsetB))
+        return true;
+    return (offsetB - offsetA) * first.condition.variable->step > 0;
+}
+
+bool LoopFusion::isLegal(const FusionCandidate &first, const FusionCandidate &second)
+{
+    BasicBlock *between = first.exit;
+    if (between->preds.size() != 1 || second.loop->preheader() != between || !sameIterationSpace(first, second))
+        return false;
+
+    for (auto &instr : between->instructions)
+    {
+        if (instr->isTerminator())
+            continue;
+        if (instr->hasSideEffects() || instr->readsMemory() || instr->mayTrap())
+            return false;
+        for (auto operand : instr->operands)
+        {
+            if (first.loop->contains(operand))
+                return false;
+        }
+    }
+
+    for (auto &instr : second.loop->header->instructions)
+    {
+        if (instr->op == Opcode::PHI || instr->isTerminator())
+            continue;
+        if (instr->hasSideEffects())
+            return false;
+        for (auto user : instr->users)
+        {
+            if (!second.loop->contains(user))
+                return false;
+        }
+    }
+
+    vector<Instruction *> firstAccesses;
+    vector<Instruction *> secondAccesses;
+    for (auto block : first.loop->blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (instr->readsMemory() || (instr->hasSideEffects() && !instr->isTerminator()))
+                firstAccesses.push_back(instr.get());
+        }
+    }
+    for (auto block : second.loop->blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            for (auto operand : instr->operands)
+            {
+                if (first.loop->contains(operand))
+                    return false;
+            }
+            if (instr->readsMemory() || (instr->hasSideEffects() && !instr->isTerminator()))
+                secondAccesses.push_back(instr.get());
+        }
+    }
+
+    for (auto a : firstAccesses)
+    {
+        for (auto b : secondAccesses)
+        {
+            if (conflicts(first, a, second, b))
+                return false;
+        }
+    }
+    return true;
+}
+
+void LoopFusion::fuse(IRFunction &function, FusionCandidate &first, FusionCandidate &second)
+{
+    BasicBlock *preheader = first.loop->preheader();
+    BasicBlock *header = first.loop->header;
+    BasicBlock *latch = first.loop->latches[0];
+    BasicBlock *between = first.exit;
+    BasicBlock *secondHeader = second.loop->header;
+    BasicBlock *secondLatch = second.loop->latches[0];
+    BasicBlock *exit = second.exit;
+
+    Instruction *secondTerm = secondHeader->terminator();
+    BasicBlock *secondBody = secondTerm->blocks[0] == exit ? secondTerm->blocks[1] : secondTerm->blocks[0];
+
+    vector<Instruction *> hoisted;
+    for (auto &instr : between->instructions)
+    {
+        if (!instr->isTerminator())
+            hoisted.push_back(instr.get());
+    }
+    for (auto instr : hoisted)
+    {
+        preheader->insertBefore(preheader->terminator(), between->detach(instr));
+    }
+
+    vector<Instruction *> phis;
+    vector<Instruction *> computations;
+    for (auto &instr : secondHeader->instructions)
+    {
+        if (instr->op == Opcode::PHI)
+            phis.push_back(instr.get());
+        else if (!instr->isTerminator())
+            computations.push_back(instr.get());
+    }
+
+    Instruction *position = secondBody->firstNonPhi();
+    for (auto instr : computations)
+    {
+        secondBody->insertBefore(position, secondHeader->detach(instr));
+    }
+
+    for (auto phi : header->phis())
+    {
+        replace(phi->blocks.begin(), phi->blocks.end(), latch, secondLatch);
+    }
+    position = header->firstNonPhi();
+    for (auto phi : phis)
+    {
+        replace(phi->blocks.begin(), phi->blocks.end(), between, preheader);
+        header->insertBefore(position, secondHeader->detach(phi));
+    }
+    for (auto phi : exit->phis())
+    {
+        replace(phi->blocks.begin(), phi->blocks.end(), secondHeader, header);
+    }
+
+    latch->replaceSuccessor(header, secondBody);
+    secondLatch->replaceSuccessor(secondHeader, header);
+    header->replaceSuccessor(between, exit);
+
+    const InductionVariable *variable = first.condition.variable;
+    const InductionVariable *secondVariable = second.condition.variable;
+    if (variable->start == secondVariable->start)
+        secondVariable->phi->replaceAllUsesWith(variable->phi);
+
+    function.removeBlock(between);
+    function.removeBlock(secondHeader);
+    function.recomputePredecessors();
+}
+
+bool LoopFusion::fuseAdjacent(IRFunction &function)
+{
+    function.recomputePredecessors();
+    DominatorTree dominators(function);
+    LoopInfo loops(dominators);
+
+    for (auto loop : loops.innermostFirst())
+    {
+        FusionCandidate first(loop);
+        if (!isSimple(first))
+            continue;
+
+        vector<BasicBlock *> successors = first.exit->successors();
+        if (successors.size() != 1)
+            continue;
+        Loop *next = loops.loopFor(successors[0]);
+        if (!next || next->header != successors[0] || next->parent != loop->parent)
+            continue;
+
+        FusionCandidate second(next);
+        if (!isSimple(second) || !isLegal(first, second))
+            continue;
+
+        fuse(function, first, second);
+        return true;
+    }
+    return false;
+}
+
+bool LoopFusion::runOnFunction(IRFunction &function)
+{
+    bool changed = insertPreheaders(function);
+
+    int fused = 0;
+    while (fuseAdjacent(function))
+    {
+        ++fused;
+    }
+
+    if (fused > 0)
+        statistics.push_back({function.name, fused});
+    return changed || fused > 0;
+}
+
+bool LoopFusion::runOnModule(IRModule &module)
+{
+    PurityAnalysis analysis(module);
+    purity = &analysis;
+    statistics.clear();
+
+    bool changed = false;
+    for (auto &function : module.functions)
+    {
+        changed = runOnFunction(*function) || changed;
+    }
+
+    purity = nullptr;
+    return changed;
+}
+
+void LoopFusion::printStatistics(ostream &out) const
+{
+    for (auto &entry : statistics)
+    {
+        out << "loop-fusion: " << entry.first << ": " << entry.second << " loop"
+            << (entry.second == 1 ? "" : "s") << " fused" << endl;
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef LOOP_FUSION_H
+#define LOOP_FUSION_H
+
+#include "induction.h"
+#include "pass_manager.h"
+#include "purity.h"
+
+using namespace std;
+
+struct FusionCandidate
+{
+    Loop *loop;
+    BasicBlock *exit;
+    ExitCondition condition;
+    unique_ptr<InductionAnalysis> analysis;
+
+    FusionCandidate(Loop *loop) : loop(loop), exit(nullptr) {}
+};
+
+class LoopFusion : public Pass
+{
+private:
+    PurityAnalysis *purity;
+    vector<pair<string, int>> statistics;
+
+    bool isSimple(FusionCandidate &candidate);
+    bool sameIterationSpace(const FusionCandidate &first, const FusionCandidate &second);
+    bool normalizedIndex(const FusionCandidate &candidate, const Instruction *index, long long &offset);
+    bool conflicts(const FusionCandidate &first, const Instruction *a,
+                   const FusionCandidate &second, const Instruction *b);
+    bool isLegal(const FusionCandidate &first, const FusionCandidate &second);
+    void fuse(IRFunction &function, FusionCandidate &first, FusionCandidate &second);
+    bool fuseAdjacent(IRFunction &function);
+    bool runOnFunction(IRFunction &function);
+
+public:
+    LoopFusion() : purity(nullptr) {}
+
+    string name() const override { return "loop-fusion"; }
+    bool runOnModule(IRModule &module) override;
+    void printStatistics(ostream &out) const override;
+};
+
+#endif
@@ -0,0 +1,224 @@
+#include "loop_info.h"
+#include <algorithm>
+
+using namespace std;
+
+BasicBlock *Loop::preheader() const
+{
+    BasicBlock *candidate = nullptr;
+    for (auto pred : header->preds)
+    {
+        if (contains(pred))
+            continue;
+        if (candidate)
+            return nullptr;
+        candidate = pred;
+    }
+    if (!candidate || candidate->successors().size() != 1)
+        return nullptr;
+    return candidate;
+}
+
+vector<BasicBlock *> Loop::exitingBlocks() const
+{
+    vector<BasicBlock *> result;
+    for (auto block : blocks)
+    {
+        for (auto succ : block->successors())
+        {
+            if (!contains(succ))
+            {
+                result.push_back(block);
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+vector<BasicBlock *> Loop::exitBlocks() const
+{
+    vector<BasicBlock *> result;
+    for (auto block : blocks)
+    {
+        for (auto succ : block->successors())
+        {
+            if (!contains(succ) && find(result.begin(), result.end(), succ) == result.end())
+                result.push_back(succ);
+        }
+    }
+    return result;
+}
+
+BasicBlock *Loop::headerExit() const
+{
+    vector<BasicBlock *> exiting = exitingBlocks();
+    vector<BasicBlock *> exits = exitBlocks();
+    if (exiting.size() != 1 || exiting[0] != header || exits.size() != 1)
+        return nullptr;
+    if (header->terminator()->op != Opcode::CONDBR)
+        return nullptr;
+    return exits[0];
+}
+
+LoopInfo::LoopInfo(const DominatorTree &dominators)
+{
+    unordered_map<BasicBlock *, Loop *> byHeader;
+
+    for (auto block : dominators.reversePostOrder())
+    {
+        for (auto succ : block->successors())
+        {
+            if (!dominators.dominates(succ, block))
+                continue;
+
+            Loop *&loop = byHeader[succ];
+            if (!loop)
+            {
+                loops.push_back(make_unique<Loop>(succ));
+                loop = loops.back().get();
+            }
+            loop->latches.push_back(block);
+        }
+    }
+
+    for (auto &loop : loops)
+    {
+        loop->blockSet.insert(loop->header);
+        vector<BasicBlock *> worklist(loop->latches.begin(), loop->latches.end());
+        while (!worklist.empty())
+        {
+            BasicBlock *block = worklist.back();
+            worklist.pop_back();
+            if (!loop->blockSet.insert(block).second)
+                continue;
+            for (auto pred : block->preds)
+            {
+                if (dominators.isReachable(pred))
+                    worklist.push_back(pred);
+            }
+        }
+
+        for (auto block : dominators.reversePostOrder())
+        {
+            if (loop->blockSet.count(block))
+                loop->blocks.push_back(block);
+        }
+    }
+
+    sort(loops.begin(), loops.end(), [](const unique_ptr<Loop> &a, const unique_ptr<Loop> &b)
+         { return a->blocks.size() > b->blocks.size(); });
+
+    for (size_t i = 0; i < loops.size(); ++i)
+    {
+        Loop *loop = loops[i].get();
+        for (size_t j = i; j-- > 0;)
+        {
+            if (loops[j]->contains(loop->header))
+            {
+                loop->parent = loops[j].get();
+                loop->depth = loop->parent->depth + 1;
+                loop->parent->children.push_back(loop);
+                break;
+            }
+        }
+        for (auto block : loop->blocks)
+        {
+            innermost[block] = loop;
+        }
+    }
+}
+
+Loop *LoopInfo::loopFor(BasicBlock *block) const
+{
+    auto it = innermost.find(block);
+    return it == innermost.end() ? nullptr : it->second;
+}
+
+vector<Loop *> LoopInfo::topLevelLoops() const
+{
+    vector<Loop *> result;
+    for (auto &loop : loops)
+    {
+        if (!loop->parent)
+            result.push_back(loop.get());
+    }
+    return result;
+}
+
+vector<Loop *> LoopInfo::innermostFirst() const
+{
+    vector<Loop *> result;
+    for (auto it = loops.rbegin(); it != loops.rend(); ++it)
+    {
+        result.push_back(it->get());
+    }
+    return result;
+}
+
+BasicBlock *insertPreheader(IRFunction &function, Loop *loop)
+{
+    if (BasicBlock *existing = loop->preheader())
+        return existing;
+
+    vector<BasicBlock *> outside;
+    for (auto pred : loop->header->preds)
+    {
+        if (!loop->contains(pred) && find(outside.begin(), outside.end(), pred) == outside.end())
+            outside.push_back(pred);
+    }
+
+    if (outside.empty())
+        return nullptr;
+
+    BasicBlock *preheader = function.createBlock();
+    for (auto pred : outside)
+    {
+        pred->replaceSuccessor(loop->header, preheader);
+    }
+
+    for (auto phi : loop->header->phis())
+    {
+        Instruction *value = nullptr;
+        if (outside.size() == 1)
+        {
+            value = phi->incomingFor(outside[0]);
+        }
+        else
+        {
+            value = preheader->addPhi(phi->type);
+            value->name = phi->name;
+            for (auto pred : outside)
+            {
+                value->addIncoming(phi->incomingFor(pred), pred);
+            }
+        }
+        for (auto pred : outside)
+        {
+            phi->removeIncoming(pred);
+        }
+        phi->addIncoming(value, preheader);
+    }
+
+    preheader->append(Opcode::BR, VoidType)->blocks.push_back(loop->header);
+    function.recomputePredecessors();
+    return preheader;
+}
+
+bool insertPreheaders(IRFunction &function)
+{
+    function.recomputePredecessors();
+    DominatorTree dominators(function);
+    LoopInfo loops(dominators);
+
+    bool changed = false;
+    for (auto loop : loops.innermostFirst())
+    {
+        if (!loop->preheader())
+        {
+            insertPreheader(function, loop);
+            changed = true;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,53 @@
+#ifndef LOOP_INFO_H
+#define LOOP_INFO_H
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "cfg.h"
+
+using namespace std;
+
+class Loop
+{
+public:
+    BasicBlock *header;
+    vector<BasicBlock *> blocks;
+    unordered_set<BasicBlock *> blockSet;
+    vector<BasicBlock *> latches;
+    Loop *parent;
+    vector<Loop *> children;
+    int depth;
+
+    Loop(BasicBlock *header) : header(header), parent(nullptr), depth(1) {}
+
+    bool contains(const BasicBlock *block) const { return blockSet.count(const_cast<BasicBlock *>(block)) > 0; }
+    bool contains(const Instruction *instr) const { return instr->parent && contains(instr->parent); }
+    bool isInvariant(const Instruction *value) const { return !contains(value); }
+
+    BasicBlock *preheader() const;
+    vector<BasicBlock *> exitingBlocks() const;
+    vector<BasicBlock *> exitBlocks() const;
+    BasicBlock *headerExit() const;
+};
+
+class LoopInfo
+{
+private:
+    vector<unique_ptr<Loop>> loops;
+    unordered_map<BasicBlock *, Loop *> innermost;
+
+public:
+    LoopInfo(const DominatorTree &dominators);
+
+    Loop *loopFor(BasicBlock *block) const;
+    vector<Loop *> topLevelLoops() const;
+    vector<Loop *> innermostFirst() const;
+    bool empty() const { return loops.empty(); }
+};
+
+BasicBlock *insertPreheader(IRFunction &function, Loop *loop);
+bool insertPreheaders(IRFunction &function);
+
+#endif
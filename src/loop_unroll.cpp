@@ -0,0 +1,335 @@
+#include "loop_unroll.h"
+#include <unordered_set>
+#include "simplify_cfg.h"
+
+using namespace std;
+
+static Instruction *lookup(const ValueMap &values, Instruction *value)
+{
+    auto it = values.find(value);
+    return it != values.end() ? it->second : value;
+}
+
+static int loopSize(const Loop *loop)
+{
+    int size = 0;
+    for (auto block : loop->blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (instr->op != Opcode::PHI)
+                ++size;
+        }
+    }
+    return size;
+}
+
+static void branchInto(BasicBlock *headerCopy, BasicBlock *exit)
+{
+    Instruction *term = headerCopy->terminator();
+    BasicBlock *body = term->blocks[0] == exit ? term->blocks[1] : term->blocks[0];
+    headerCopy->erase(term);
+    Instruction *br = headerCopy->append(Opcode::BR, VoidType);
+    br->blocks.push_back(body);
+}
+
+BasicBlock *LoopUnroll::unrollableExit(Loop *loop)
+{
+    if (!loop->children.empty() || loop->latches.size() != 1 || !loop->preheader())
+        return nullptr;
+
+    BasicBlock *exit = loop->headerExit();
+    if (!exit || exit->preds.size() != 1 || !exit->phis().empty())
+        return nullptr;
+
+    for (auto block : loop->blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (instr->op == Opcode::ARRAY)
+                return nullptr;
+        }
+    }
+    return exit;
+}
+
+BasicBlock *LoopUnroll::cloneIteration(Loop *loop, ValueMap &values, BlockMap &blockMap)
+{
+    IRFunction &function = *loop->header->parent;
+    for (auto block : loop->blocks)
+    {
+        BasicBlock *copy = function.createBlock();
+        blockMap[block] = copy;
+        for (auto &instr : block->instructions)
+        {
+            if (block == loop->header && instr->op == Opcode::PHI)
+                continue;
+            values[instr.get()] = copy->insertBefore(nullptr, cloneInstruction(function, instr.get()));
+        }
+    }
+
+    for (auto block : loop->blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (block == loop->header && instr->op == Opcode::PHI)
+                continue;
+
+            Instruction *clone = values[instr.get()];
+            for (auto operand : instr->operands)
+            {
+                clone->addOperand(lookup(values, operand));
+            }
+            for (auto successor : instr->blocks)
+            {
+                bool inside = successor != loop->header && loop->contains(successor);
+                clone->blocks.push_back(inside ? blockMap[successor] : successor);
+            }
+        }
+    }
+    return blockMap[loop->header];
+}
+
+ValueMap LoopUnroll::nextIteration(Loop *loop, const ValueMap &values)
+{
+    ValueMap next;
+    for (auto phi : loop->header->phis())
+    {
+        next[phi] = lookup(values, phi->incomingFor(loop->latches[0]));
+    }
+    return next;
+}
+
+void LoopUnroll::peel(Loop *loop, BasicBlock *exit, long long count)
+{
+    BasicBlock *preheader = loop->preheader();
+    BasicBlock *pred = preheader;
+
+    ValueMap current;
+    for (auto phi : loop->header->phis())
+    {
+        current[phi] = phi->incomingFor(preheader);
+    }
+
+    for (long long i = 0; i < count; ++i)
+    {
+        ValueMap values = current;
+        BlockMap blockMap;
+        BasicBlock *headerCopy = cloneIteration(loop, values, blockMap);
+        branchInto(headerCopy, exit);
+        pred->replaceSuccessor(loop->header, headerCopy);
+        pred = blockMap[loop->latches[0]];
+        current = nextIteration(loop, values);
+    }
+
+    for (auto phi : loop->header->phis())
+    {
+        for (size_t i = 0; i < phi->blocks.size(); ++i)
+        {
+            if (phi->blocks[i] != preheader)
+                continue;
+            phi->setOperand(i, current[phi]);
+            phi->blocks[i] = pred;
+        }
+    }
+}
+
+void LoopUnroll::unrollFully(Loop *loop, BasicBlock *exit, long long count)
+{
+    peel(loop, exit, count);
+
+    BasicBlock *header = loop->header;
+    for (auto phi : header->phis())
+    {
+        phi->removeIncoming(loop->latches[0]);
+    }
+    header->erase(header->terminator());
+    Instruction *br = header->append(Opcode::BR, VoidType);
+    br->blocks.push_back(exit);
+}
+
+void LoopUnroll::unrollByFactor(Loop *loop, BasicBlock *exit, int factor, bool exact)
+{
+    BasicBlock *header = loop->header;
+    BasicBlock *latch = loop->latches[0];
+    vector<BasicBlock *> headers;
+    vector<BasicBlock *> latches{latch};
+
+    vector<pair<BasicBlock *, ValueMap>> exitingCopies;
+    unordered_set<BasicBlock *> copies;
+    ValueMap current = nextIteration(loop, ValueMap());
+
+    for (int i = 1; i < factor; ++i)
+    {
+        ValueMap values = current;
+        BlockMap blockMap;
+        BasicBlock *headerCopy = cloneIteration(loop, values, blockMap);
+        if (exact)
+            branchInto(headerCopy, exit);
+        else
+            exitingCopies.push_back({headerCopy, values});
+
+        for (auto &entry : blockMap)
+        {
+            copies.insert(entry.second);
+        }
+        headers.push_back(headerCopy);
+        latches.push_back(blockMap[latch]);
+        current = nextIteration(loop, values);
+    }
+
+    for (size_t i = 0; i < headers.size(); ++i)
+    {
+        latches[i]->replaceSuccessor(header, headers[i]);
+    }
+
+    for (auto phi : header->phis())
+    {
+        for (size_t i = 0; i < phi->blocks.size(); ++i)
+        {
+            if (phi->blocks[i] != latch)
+                continue;
+            phi->setOperand(i, current[phi]);
+            phi->blocks[i] = latches.back();
+        }
+    }
+
+    if (exact)
+        return;
+
+    vector<Instruction *> headerValues;
+    for (auto &instr : header->instructions)
+    {
+        headerValues.push_back(instr.get());
+    }
+
+    unordered_set<Instruction *> merges;
+    for (auto value : headerValues)
+    {
+        vector<Instruction *> outside;
+        for (auto user : value->users)
+        {
+            if (!loop->contains(user) && !copies.count(user->parent) && !merges.count(user))
+                outside.push_back(user);
+        }
+        if (outside.empty())
+            continue;
+
+        Instruction *merged = exit->addPhi(value->type);
+        merges.insert(merged);
+        merged->addIncoming(value, header);
+        for (auto &entry : exitingCopies)
+        {
+            merged->addIncoming(lookup(entry.second, value), entry.first);
+        }
+
+        for (auto user : outside)
+        {
+            for (size_t i = 0; i < user->operands.size(); ++i)
+            {
+                if (user->operands[i] == value)
+                    user->setOperand(i, merged);
+            }
+        }
+    }
+}
+
+bool LoopUnroll::runOnLoop(Loop *loop, bool &removed)
+{
+    BasicBlock *exit = unrollableExit(loop);
+    int hint = loop->header->unrollFactor;
+    loop->header->unrollFactor = 0;
+    if (!exit || hint == 1)
+        return false;
+
+    long long size = loopSize(loop);
+    InductionAnalysis analysis(loop);
+    TripCount trip = analysis.tripCount();
+
+    if (trip.known && (trip.count <= hint || trip.count * size <= threshold))
+    {
+        unrollFully(loop, exit, trip.count);
+        removed = true;
+        return true;
+    }
+
+    int factor = hint;
+    if (factor == 0 && trip.known)
+    {
+        for (int candidate : {4, 2})
+        {
+            if (candidate * size <= threshold)
+            {
+                factor = candidate;
+                break;
+            }
+        }
+    }
+    if (factor < 2)
+        return false;
+
+    if (trip.known)
+        peel(loop, exit, trip.count % factor);
+    unrollByFactor(loop, exit, factor, trip.known);
+    return true;
+}
+
+bool LoopUnroll::runOnFunction(IRFunction &function)
+{
+    bool changed = insertPreheaders(function);
+    unordered_set<BasicBlock *> visited;
+    int unrolled = 0;
+
+    function.recomputePredecessors();
+    bool removed = true;
+    while (removed)
+    {
+        removed = false;
+        DominatorTree dominators(function);
+        LoopInfo loops(dominators);
+
+        // Unrolling one innermost loop leaves the others in the round intact, so the whole function is only
+        // cleaned up once the round is over.
+        int before = unrolled;
+        for (auto loop : loops.innermostFirst())
+        {
+            if (!loop->children.empty() || !visited.insert(loop->header).second)
+                continue;
+            if (runOnLoop(loop, removed))
+                ++unrolled;
+        }
+        if (unrolled == before)
+            continue;
+        function.recomputePredecessors();
+        if (removed)
+        {
+            removeUnreachableBlocks(function);
+            removeTrivialPhis(function);
+        }
+    }
+
+    if (unrolled > 0)
+        statistics.push_back({function.name, unrolled});
+    return changed || unrolled > 0;
+}
+
+bool LoopUnroll::runOnModule(IRModule &module)
+{
+    statistics.clear();
+
+    bool changed = false;
+    for (auto &function : module.functions)
+    {
+        changed = runOnFunction(*function) || changed;
+    }
+    return changed;
+}
+
+void LoopUnroll::printStatistics(ostream &out) const
+{
+    for (auto &entry : statistics)
+    {
+        out << "loop-unroll: " << entry.first << ": " << entry.second << " loop"
+            << (entry.second == 1 ? "" : "s") << " unrolled" << endl;
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef LOOP_UNROLL_H
+#define LOOP_UNROLL_H
+
+#include "cloning.h"
+#include "induction.h"
+#include "pass_manager.h"
+
+using namespace std;
+
+class LoopUnroll : public Pass
+{
+private:
+    int threshold;
+    vector<pair<string, int>> statistics;
+
+    BasicBlock *unrollableExit(Loop *loop);
+    BasicBlock *cloneIteration(Loop *loop, ValueMap &values, BlockMap &blockMap);
+    ValueMap nextIteration(Loop *loop, const ValueMap &values);
+    void peel(Loop *loop, BasicBlock *exit, long long count);
+    void unrollFully(Loop *loop, BasicBlock *exit, long long count);
+    void unrollByFactor(Loop *loop, BasicBlock *exit, int factor, bool exact);
+    bool runOnLoop(Loop *loop, bool &removed);
+    bool runOnFunction(IRFunction &function);
+
+public:
+    LoopUnroll(int threshold) : threshold(threshold) {}
+
+    string name() const override { return "loop-unroll"; }
+    bool runOnModule(IRModule &module) override;
+    void printStatistics(ostream &out) const override;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <cstdlib>
 #include <cstdio>
 #include <filesystem>
@@ -10,6 +11,11 @@
 #include "semantic.h"
 #include "codegen.h"
 #include "error.h"
+#include "ir_builder.h"
+#include "ir_emitter.h"
+#include "ir_verifier.h"
+#include "options.h"
+#include "pass_manager.h"
 
 using namespace std;
 namespace fs = std::filesystem;
@@ -31,12 +37,119 @@ string readFile(const string &filename)
 void printUsage()
 {
     cout << "Usage:" << endl;
-    cout << "  nova <file.nova>                # Compile and run" << endl;
-    cout << "  nova <file.nova> <output.c>     # Compile to C file" << endl;
-    cout << "  nova --help                     # Show this help" << endl;
+    cout << "  nova [options] <file.nova>                # Compile and run" << endl;
+    cout << "  nova [options] <file.nova> <output.c>     # Compile to C file" << endl;
+    cout << "  nova --help                               # Show this help" << endl;
+    cout << endl;
+    cout << "Options:" << endl;
+    cout << "  -O0                 Disable optimizations" << endl;
+    cout << "  -O, -O1             Enable optimizations (default)" << endl;
+    cout << "  --ast-codegen       Emit C directly from the AST, bypassing the IR" << endl;
+    cout << "  --dump-ir           Print the final IR to stderr" << endl;
+    cout << "  --verify-each       Verify the IR after every pass" << endl;
+    cout << "  --stats             Print per-function optimization statistics" << endl;
+    cout << "  --auto-memo         Memoize pure recursive functions without @memo" << endl;
+    cout << "  --bounds-check      Abort on out-of-range array indices" << endl;
+    cout << "  --fast-math         Allow reassociating floating-point reductions" << endl;
+    cout << "  --no-auto-parallel  Do not run reduction loops on multiple threads" << endl;
+    cout << "  --no-inline         Disable function inlining" << endl;
+    cout << "  --inline-threshold=N  Inline callees of at most N instructions (default 40)" << endl;
+    cout << "  --inline-depth=N    Limit nested inlining to N levels (default 3)" << endl;
+    cout << "  --no-specialize     Disable constant-argument function specialization" << endl;
+    cout << "  --specialize-budget=N  Allow N instructions of specialized clones (default 200)" << endl;
+    cout << "  --no-unroll         Disable loop unrolling, including @unroll hints" << endl;
+    cout << "  --unroll-threshold=N  Unroll loops up to N instructions after unrolling (default 128)" << endl;
 }
 
-bool compileNovaToC(const string &inputFile, const string &outputFile)
+bool parseCount(const string &text, int &result)
+{
+    if (text.empty() || text.find_first_not_of("0123456789") != string::npos || text.size() > 9)
+        return false;
+    result = stoi(text);
+    return true;
+}
+
+bool parseOption(const string &arg, CompilerOptions &options)
+{
+    if (arg == "-O0")
+        options.optLevel = 0;
+    else if (arg == "-O" || arg == "-O1")
+        options.optLevel = 1;
+    else if (arg == "--ast-codegen")
+        options.astCodegen = true;
+    else if (arg == "--dump-ir")
+        options.dumpIR = true;
+    else if (arg == "--verify-each")
+        options.verifyEach = true;
+    else if (arg == "--stats")
+        options.printStatistics = true;
+    else if (arg == "--auto-memo")
+        options.autoMemo = true;
+    else if (arg == "--bounds-check")
+        options.boundsCheck = true;
+    else if (arg == "--fast-math")
+        options.fastMath = true;
+    else if (arg == "--no-auto-parallel")
+        options.autoParallel = false;
+    else if (arg == "--no-inline")
+        options.inlineThreshold = 0;
+    else if (arg.rfind("--inline-threshold=", 0) == 0)
+        return parseCount(arg.substr(19), options.inlineThreshold);
+    else if (arg.rfind("--inline-depth=", 0) == 0)
+        return parseCount(arg.substr(15), options.inlineDepth);
+    else if (arg == "--no-specialize")
+        options.specializeBudget = 0;
+    else if (arg.rfind("--specialize-budget=", 0) == 0)
+        return parseCount(arg.substr(20), options.specializeBudget);
+    else if (arg == "--no-unroll")
+        options.unrollThreshold = 0;
+    else if (arg.rfind("--unroll-threshold=", 0) == 0)
+        return parseCount(arg.substr(19), options.unrollThreshold);
+    else
+        return false;
+    return true;
+}
+
+bool generateFromIR(shared_ptr<Program> program, ostream &output, const CompilerOptions &options)
+{
+    IRBuilder builder(options);
+    auto module = builder.build(program);
+
+    if (errorReporter.hadError())
+    {
+        errorReporter.printErrors();
+        return false;
+    }
+
+    PassManager manager(options.verifyEach, options.printStatistics);
+    buildPipeline(manager, options);
+    if (!manager.run(*module))
+    {
+        return false;
+    }
+
+    IRVerifier verifier;
+    if (!verifier.verify(*module))
+    {
+        cerr << "Internal error: invalid IR" << endl;
+        for (const auto &error : verifier.getErrors())
+        {
+            cerr << "  " << error << endl;
+        }
+        return false;
+    }
+
+    if (options.dumpIR)
+    {
+        printModule(cerr, *module);
+    }
+
+    IREmitter emitter(output);
+    emitter.emit(*module);
+    return true;
+}
+
+bool compileNovaToC(const string &inputFile, const string &outputFile, const CompilerOptions &options)
 {
     string input = readFile(inputFile);
 
@@ -49,7 +162,7 @@ bool compileNovaToC(const string &inputFile, const string &outputFile)
         return false;
     }
 
-    SemanticAnalyzer analyzer;
+    SemanticAnalyzer analyzer(options.fastMath);
     analyzer.analyze(program);
 
     if (errorReporter.hadError())
@@ -65,29 +178,55 @@ bool compileNovaToC(const string &inputFile, const string &outputFile)
         return false;
     }
 
-    CodeGenerator generator(output);
-    generator.generate(program);
+    bool ok = true;
+    if (options.astCodegen)
+    {
+        CodeGenerator generator(output, options.boundsCheck);
+        generator.generate(program);
+    }
+    else
+    {
+        ok = generateFromIR(program, output, options);
+    }
     output.close();
 
-    return true;
+    return ok;
 }
 
 int main(int argc, char *argv[])
 {
-    if (argc < 2)
+    CompilerOptions options;
+    vector<string> positional;
+
+    for (int i = 1; i < argc; ++i)
     {
-        printUsage();
-        return 1;
+        string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        if (arg.size() > 1 && arg[0] == '-')
+        {
+            if (!parseOption(arg, options))
+            {
+                cerr << "Error: Unknown option " << arg << endl;
+                printUsage();
+                return 1;
+            }
+            continue;
+        }
+        positional.push_back(arg);
     }
 
-    string firstArg = argv[1];
-
-    if (firstArg == "--help" || firstArg == "-h")
+    if (positional.empty() || positional.size() > 2)
     {
         printUsage();
-        return 0;
+        return 1;
     }
 
+    string firstArg = positional[0];
+
     if (!fs::exists(firstArg))
     {
         cerr << "Error: File not found: " << firstArg << endl;
@@ -100,7 +239,7 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    if (argc == 2)
+    if (positional.size() == 1)
     {
 
         string tempCFile = "/tmp/nova_temp.c";
@@ -108,12 +247,13 @@ int main(int argc, char *argv[])
 
         cout << "Compiling " << firstArg << "..." << endl;
 
-        if (!compileNovaToC(firstArg, tempCFile))
+        if (!compileNovaToC(firstArg, tempCFile, options))
         {
             return 1;
         }
 
-        string compileCmd = "gcc -o " + tempExe + " " + tempCFile + " 2>/dev/null";
+        string gccOpt = options.optLevel > 0 ? " -O2" : "";
+        string compileCmd = "gcc" + gccOpt + " -pthread -o " + tempExe + " " + tempCFile + " 2>/dev/null";
         int compileResult = system(compileCmd.c_str());
 
         if (compileResult != 0)
@@ -130,13 +270,13 @@ int main(int argc, char *argv[])
 
         return WEXITSTATUS(runResult);
     }
-    else if (argc == 3)
+    else
     {
 
-        string inputFile = argv[1];
-        string outputFile = argv[2];
+        string inputFile = positional[0];
+        string outputFile = positional[1];
 
-        if (compileNovaToC(inputFile, outputFile))
+        if (compileNovaToC(inputFile, outputFile, options))
         {
             cout << "Successfully compiled " << inputFile << " to " << outputFile << endl;
             return 0;
@@ -146,9 +286,4 @@ int main(int argc, char *argv[])
             return 1;
         }
     }
-    else
-    {
-        printUsage();
-        return 1;
-    }
 }
\ No newline at end of file
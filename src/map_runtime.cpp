@@ -0,0 +1,78 @@
+#include "map_runtime.h"
+
+using namespace std;
+
+// A mapping is released when its array goes out of scope. The region must start at a multiple of 64 bytes so
+// that the array keeps the alignment every other array has.
+const char *const mapRuntimeSource = R"nova(#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static void *nova_map_file(const char *path, long long offset, long long count, long long element, int writable)
+{
+    if (!path)
+        path = "(null)";
+    if (offset < 0 || offset % 64 != 0)
+    {
+        fprintf(stderr, "Runtime error: mapping offset %lld of '%s' is not a multiple of 64\n", offset, path);
+        exit(1);
+    }
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        fprintf(stderr, "Runtime error: cannot map '%s': %s\n", path, strerror(errno));
+        exit(1);
+    }
+    long long length = count * element;
+    if (info.st_size < offset || info.st_size - offset < length)
+    {
+        fprintf(stderr, "Runtime error: '%s' has %lld bytes, but %lld elements from offset %lld need %lld\n", path,
+                (long long)info.st_size, count, offset, offset + length);
+        exit(1);
+    }
+    long long start = offset - offset % sysconf(_SC_PAGESIZE);
+    int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    char *base = mmap(NULL, (size_t)(length + offset - start), protection, MAP_PRIVATE, fd, (off_t)start);
+    if (base == MAP_FAILED)
+    {
+        fprintf(stderr, "Runtime error: cannot map '%s': %s\n", path, strerror(errno));
+        exit(1);
+    }
+    close(fd);
+    return base + (offset - start);
+}
+
+// The array starts as far into its first page as the region's offset did.
+static void nova_unmap(void *array, long long count, long long element)
+{
+    long long skipped = (long long)((unsigned long)array % (unsigned long)sysconf(_SC_PAGESIZE));
+    munmap((char *)array - skipped, (size_t)(count * element + skipped));
+}
+)nova";
+
+bool isMapBuiltin(const string &name)
+{
+    return name == "map_file" || name == "map_file_cow";
+}
+
+static string elementCType(const ArrayType &array)
+{
+    return array.elementType->kind == TypeKind::FLOAT ? "float" : "int";
+}
+
+string mapCall(const string &name, const vector<string> &args, const shared_ptr<Type> &array)
+{
+    auto arrayType = static_pointer_cast<ArrayType>(array);
+    string element = elementCType(*arrayType);
+    return "(" + element + " *)nova_map_file(" + args[0] + ", " + (args.size() > 1 ? args[1] : "0") + ", " +
+           to_string(arrayType->size) + ", sizeof(" + element + "), " + (name == "map_file_cow" ? "1" : "0") + ")";
+}
+
+string unmapCall(const string &array, const shared_ptr<Type> &type)
+{
+    auto arrayType = static_pointer_cast<ArrayType>(type);
+    return "nova_unmap(" + array + ", " + to_string(arrayType->size) + ", sizeof(" + elementCType(*arrayType) + "))";
+}
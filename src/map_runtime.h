@@ -0,0 +1,23 @@
+#ifndef MAP_RUNTIME_H
+#define MAP_RUNTIME_H
+
+#include <string>
+#include <vector>
+#include "types.h"
+
+using namespace std;
+
+// C source of the file mapping behind `map_file` and `map_file_cow`, emitted into programs that map arrays.
+extern const char *const mapRuntimeSource;
+
+// map_file (read-only) and map_file_cow (copy-on-write).
+bool isMapBuiltin(const string &name);
+
+// C expression mapping the file region named by the C expressions `args` (a path and an optional byte offset)
+// as the elements of `array`.
+string mapCall(const string &name, const vector<string> &args, const shared_ptr<Type> &array);
+
+// C expression releasing the mapping behind `array`, a mapped array of type `type`.
+string unmapCall(const string &array, const shared_ptr<Type> &type);
+
+#endif
@@ -0,0 +1,88 @@
+#include "memoize.h"
+#include "call_graph.h"
+#include "purity.h"
+
+using namespace std;
+
+static int selfCalls(const IRFunction &function)
+{
+    int count = 0;
+    for (auto &block : function.blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (instr->op == Opcode::CALL && instr->text == function.name)
+                ++count;
+        }
+    }
+    return count;
+}
+
+// Functions reachable from a spawned task or a parallel loop body; their memo tables would be shared
+// between threads.
+static unordered_set<IRFunction *> concurrentFunctions(IRModule &module)
+{
+    CallGraph graph(module);
+    unordered_set<IRFunction *> result;
+    vector<IRFunction *> worklist;
+    for (auto &function : module.functions)
+    {
+        for (auto &block : function->blocks)
+        {
+            for (auto &instr : block->instructions)
+            {
+                if (instr->op != Opcode::CALL || !(instr->spawn || instr->parallel))
+                    continue;
+                IRFunction *callee = module.getFunction(instr->text);
+                if (callee && result.insert(callee).second)
+                    worklist.push_back(callee);
+            }
+        }
+    }
+    while (!worklist.empty())
+    {
+        IRFunction *function = worklist.back();
+        worklist.pop_back();
+        for (auto callee : graph.callees(function))
+        {
+            if (result.insert(callee).second)
+                worklist.push_back(callee);
+        }
+    }
+    return result;
+}
+
+bool Memoize::runOnModule(IRModule &module)
+{
+    PurityAnalysis purity(module);
+    unordered_set<IRFunction *> concurrent = concurrentFunctions(module);
+    bool changed = false;
+
+    for (auto &function : module.functions)
+    {
+        bool requested = function->annotations.count("memo") > 0;
+        if (!requested && !automatic)
+            continue;
+
+        if (!purity.isMemoizable(function.get()))
+        {
+            if (requested)
+                cerr << "Warning: ignoring @memo on '" << function->name << "' because it is not pure" << endl;
+            continue;
+        }
+        if (concurrent.count(function.get()))
+        {
+            if (requested)
+                cerr << "Warning: ignoring @memo on '" << function->name << "' because it runs on multiple threads"
+                     << endl;
+            continue;
+        }
+
+        if (requested || selfCalls(*function) >= 2)
+        {
+            function->memoize = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,20 @@
+#ifndef MEMOIZE_H
+#define MEMOIZE_H
+
+#include "pass_manager.h"
+
+using namespace std;
+
+class Memoize : public Pass
+{
+private:
+    bool automatic;
+
+public:
+    Memoize(bool automatic) : automatic(automatic) {}
+
+    string name() const override { return "memoize"; }
+    bool runOnModule(IRModule &module) override;
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "merge_functions.h"
+#include <sstream>
+#include <unordered_map>
+
+using namespace std;
+
+string MergeFunctions::canonicalForm(const IRFunction &function)
+{
+    unordered_map<const Instruction *, int> values;
+    unordered_map<const BasicBlock *, int> blocks;
+    for (auto &param : function.params)
+    {
+        values[param.get()] = static_cast<int>(values.size());
+    }
+    for (auto &block : function.blocks)
+    {
+        blocks[block.get()] = static_cast<int>(blocks.size());
+        for (auto &instr : block->instructions)
+        {
+            values[instr.get()] = static_cast<int>(values.size());
+        }
+    }
+
+    ostringstream out;
+    out << hexfloat << function.returnType->toString() << (function.memoize ? " memo" : "") << " reduce"
+        << function.reduction;
+    for (auto &annotation : function.annotations)
+    {
+        out << " @" << annotation;
+    }
+    for (auto &param : function.params)
+    {
+        out << (param->noalias ? " noalias " : " ") << param->type->toString();
+    }
+    out << "\n";
+
+    for (auto &block : function.blocks)
+    {
+        out << "b" << blocks[block.get()] << " u" << block->unrollFactor << "\n";
+        for (auto &instr : block->instructions)
+        {
+            out << opcodeName(instr->op) << " " << instr->type->toString() << (instr->speculative ? " spec" : "")
+                << (instr->checked ? " checked" : "") << (instr->parallel ? " parallel" : "")
+                << (instr->spawn ? " spawn" : "");
+            if (instr->op == Opcode::CALL && instr->text == function.name)
+                out << " <self>";
+            else if (!instr->text.empty())
+                out << " " << instr->text.size() << ":" << instr->text;
+
+            for (auto operand : instr->operands)
+            {
+                if (operand->op == Opcode::CONST)
+                    out << " c" << operand->type->toString() << ":" << operand->intValue << ":"
+                        << operand->floatValue << ":" << operand->text.size() << ":" << operand->text;
+                else if (operand->op == Opcode::GLOBAL)
+                    out << " g" << operand->text.size() << ":" << operand->text;
+                else
+                    out << " %" << values[operand];
+            }
+            for (auto target : instr->blocks)
+            {
+                out << " b" << blocks[target];
+            }
+            out << "\n";
+        }
+    }
+    return out.str();
+}
+
+bool MergeFunctions::runOnModule(IRModule &module)
+{
+    merged.clear();
+
+    bool changed = false;
+    bool progress = true;
+    while (progress)
+    {
+        progress = false;
+        unordered_map<string, IRFunction *> canonical;
+        vector<pair<IRFunction *, IRFunction *>> duplicates;
+        for (auto &function : module.functions)
+        {
+            if (function->isMain())
+                continue;
+            auto result = canonical.insert({canonicalForm(*function), function.get()});
+            if (!result.second)
+                duplicates.push_back({function.get(), result.first->second});
+        }
+
+        for (auto &entry : duplicates)
+        {
+            IRFunction *duplicate = entry.first;
+            IRFunction *target = entry.second;
+            for (auto &function : module.functions)
+            {
+                for (auto &block : function->blocks)
+                {
+                    for (auto &instr : block->instructions)
+                    {
+                        if (instr->op == Opcode::CALL && instr->text == duplicate->name)
+                            instr->text = target->name;
+                    }
+                }
+            }
+            merged.push_back({duplicate->name, target->name});
+            module.removeFunction(duplicate);
+            progress = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void MergeFunctions::printStatistics(ostream &out) const
+{
+    for (auto &entry : merged)
+    {
+        out << "mergefunc: merged '" << entry.first << "' into '" << entry.second << "'" << endl;
+    }
+}
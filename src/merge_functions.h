@@ -0,0 +1,21 @@
+#ifndef MERGE_FUNCTIONS_H
+#define MERGE_FUNCTIONS_H
+
+#include "pass_manager.h"
+
+using namespace std;
+
+class MergeFunctions : public Pass
+{
+private:
+    vector<pair<string, string>> merged;
+
+    string canonicalForm(const IRFunction &function);
+
+public:
+    string name() const override { return "mergefunc"; }
+    bool runOnModule(IRModule &module) override;
+    void printStatistics(ostream &out) const override;
+};
+
+#endif
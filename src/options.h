@@ -0,0 +1,23 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+using namespace std;
+
+struct CompilerOptions
+{
+    int optLevel = 1;
+    bool astCodegen = false;
+    bool dumpIR = false;
+    bool verifyEach = false;
+    bool printStatistics = false;
+    bool autoMemo = false;
+    bool boundsCheck = false;
+    bool fastMath = false;
+    bool autoParallel = true;
+    int inlineThreshold = 40;
+    int inlineDepth = 3;
+    int unrollThreshold = 128;
+    int specializeBudget = 200;
+};
+
+#endif
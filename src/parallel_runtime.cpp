@@ -0,0 +1,183 @@
+#include "parallel_runtime.h"
+
+using namespace std;
+
+const char *const parallelRuntimeSource = R"(#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define NOVA_MAX_WORKERS 64
+
+typedef void (*nova_task)(int lo, int hi, void *env);
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    long long next;
+    long long end;
+} nova_range;
+
+static struct
+{
+    int workers;
+    long long grain;
+    nova_task task;
+    void *env;
+    unsigned generation;
+    int active;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    nova_range ranges[NOVA_MAX_WORKERS];
+} nova_pool = {0, 1, NULL, NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+static atomic_flag nova_pool_busy = ATOMIC_FLAG_INIT;
+static __thread int nova_in_parallel;
+static __thread int nova_worker_id;
+
+static int nova_take(int self, int *lo, int *hi)
+{
+    nova_range *range = &nova_pool.ranges[self];
+    int found = 0;
+    pthread_mutex_lock(&range->lock);
+    if (range->next < range->end)
+    {
+        long long chunk = range->end - range->next < nova_pool.grain ? range->end - range->next : nova_pool.grain;
+        *lo = (int)range->next;
+        *hi = (int)(range->next + chunk);
+        range->next += chunk;
+        found = 1;
+    }
+    pthread_mutex_unlock(&range->lock);
+    return found;
+}
+
+static int nova_steal(int self)
+{
+    for (int i = 1; i < nova_pool.workers; ++i)
+    {
+        nova_range *victim = &nova_pool.ranges[(self + i) % nova_pool.workers];
+        pthread_mutex_lock(&victim->lock);
+        long long remaining = victim->end - victim->next;
+        if (remaining > 0)
+        {
+            long long split = victim->end - (remaining + 1) / 2;
+            long long end = victim->end;
+            victim->end = split;
+            pthread_mutex_unlock(&victim->lock);
+
+            nova_range *own = &nova_pool.ranges[self];
+            pthread_mutex_lock(&own->lock);
+            own->next = split;
+            own->end = end;
+            pthread_mutex_unlock(&own->lock);
+            return 1;
+        }
+        pthread_mutex_unlock(&victim->lock);
+    }
+    return 0;
+}
+
+static void nova_work(int self)
+{
+    int lo, hi;
+    do
+    {
+        while (nova_take(self, &lo, &hi))
+            nova_pool.task(lo, hi, nova_pool.env);
+    } while (nova_steal(self));
+}
+
+static void *nova_worker(void *arg)
+{
+    int self = (int)(long)arg;
+    unsigned seen = 0;
+    nova_in_parallel = 1;
+    nova_worker_id = self;
+    pthread_mutex_lock(&nova_pool.lock);
+    for (;;)
+    {
+        while (nova_pool.generation == seen)
+            pthread_cond_wait(&nova_pool.start, &nova_pool.lock);
+        seen = nova_pool.generation;
+        pthread_mutex_unlock(&nova_pool.lock);
+        nova_work(self);
+        pthread_mutex_lock(&nova_pool.lock);
+        if (--nova_pool.active == 0)
+            pthread_cond_signal(&nova_pool.done);
+    }
+    return NULL;
+}
+
+static void nova_pool_init(void)
+{
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *requested = getenv("NOVA_THREADS");
+    if (requested && atoi(requested) > 0)
+        workers = atoi(requested);
+    nova_pool.workers = workers < 1 ? 1 : workers > NOVA_MAX_WORKERS ? NOVA_MAX_WORKERS : (int)workers;
+
+    for (int i = 0; i < nova_pool.workers; ++i)
+        pthread_mutex_init(&nova_pool.ranges[i].lock, NULL);
+    for (int i = 1; i < nova_pool.workers; ++i)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, nova_worker, (void *)(long)i) != 0)
+        {
+            nova_pool.workers = i;
+            break;
+        }
+        pthread_detach(thread);
+    }
+}
+
+static void nova_parallel_for(int lo, int hi, nova_task task, void *env)
+{
+    if (lo >= hi)
+        return;
+    // Loops started by concurrently running tasks while the pool is busy run on the calling thread.
+    if (nova_in_parallel || atomic_flag_test_and_set(&nova_pool_busy))
+    {
+        task(lo, hi, env);
+        return;
+    }
+    if (nova_pool.workers == 0)
+        nova_pool_init();
+
+    long long count = (long long)hi - lo;
+    int workers = nova_pool.workers;
+    if (workers == 1 || count == 1)
+    {
+        task(lo, hi, env);
+        atomic_flag_clear(&nova_pool_busy);
+        return;
+    }
+
+    nova_pool.grain = count / (workers * 8LL);
+    if (nova_pool.grain < 1)
+        nova_pool.grain = 1;
+    for (int i = 0; i < workers; ++i)
+    {
+        nova_pool.ranges[i].next = lo + count * i / workers;
+        nova_pool.ranges[i].end = lo + count * (i + 1) / workers;
+    }
+
+    nova_in_parallel = 1;
+    pthread_mutex_lock(&nova_pool.lock);
+    nova_pool.task = task;
+    nova_pool.env = env;
+    nova_pool.active = workers - 1;
+    nova_pool.generation++;
+    pthread_cond_broadcast(&nova_pool.start);
+    pthread_mutex_unlock(&nova_pool.lock);
+
+    nova_work(0);
+
+    pthread_mutex_lock(&nova_pool.lock);
+    while (nova_pool.active > 0)
+        pthread_cond_wait(&nova_pool.done, &nova_pool.lock);
+    pthread_mutex_unlock(&nova_pool.lock);
+    nova_in_parallel = 0;
+    atomic_flag_clear(&nova_pool_busy);
+}
+)";
@@ -0,0 +1,9 @@
+#ifndef PARALLEL_RUNTIME_H
+#define PARALLEL_RUNTIME_H
+
+using namespace std;
+
+// C source of the work-stealing thread pool behind `parallel for`, emitted into programs that use it.
+extern const char *const parallelRuntimeSource;
+
+#endif
@@ -1,5 +1,6 @@
 #include "parser.h"
 #include "error.h"
+#include "vector_runtime.h"
 #include <sstream>
 
 using namespace std;
@@ -63,14 +64,56 @@ shared_ptr<Type> Parser::parseType()
     {
         baseType = VoidType;
     }
+    else if (match(TOKEN_TASK))
+    {
+        consume(TOKEN_LESS, "Expected '<' after 'task'");
+        shared_ptr<Type> resultType = parseType();
+        consume(TOKEN_GREATER, "Expected '>'");
+        baseType = make_shared<TaskType>(resultType);
+    }
+    else if (match(TOKEN_CHANNEL))
+    {
+        consume(TOKEN_LESS, "Expected '<' after 'channel'");
+        int line = currentToken.line;
+        int column = currentToken.column;
+        shared_ptr<Type> elementType = parseType();
+        consume(TOKEN_GREATER, "Expected '>'");
+        if (elementType->kind != TypeKind::INT && elementType->kind != TypeKind::FLOAT &&
+            elementType->kind != TypeKind::BOOL && elementType->kind != TypeKind::STRING)
+        {
+            errorReporter.reportError("Channels can only carry int, float, bool or string values", line, column);
+            return ErrorType;
+        }
+        baseType = make_shared<ChannelType>(elementType);
+    }
+    else if (match(TOKEN_ATOMIC))
+    {
+        int line = currentToken.line;
+        int column = currentToken.column;
+        shared_ptr<Type> valueType = parseType();
+        if (valueType->kind != TypeKind::INT)
+        {
+            errorReporter.reportError("Only 'atomic int' is supported", line, column);
+            return ErrorType;
+        }
+        return make_shared<AtomicType>(valueType);
+    }
+    else if (check(TOKEN_VECTOR))
+    {
+        baseType = vectorType(currentToken.text);
+        advance();
+    }
     else
     {
         errorReporter.reportError("Expected type", currentToken.line, currentToken.column);
         return ErrorType;
     }
 
-    if (match(TOKEN_LBRACKET))
+    if (check(TOKEN_LBRACKET))
     {
+        int line = currentToken.line;
+        int column = currentToken.column;
+        advance();
         if (currentToken.type != TOKEN_INT_LITERAL)
         {
             errorReporter.reportError("Expected array size", currentToken.line, currentToken.column);
@@ -79,6 +122,11 @@ shared_ptr<Type> Parser::parseType()
         int size = stoi(currentToken.text);
         advance();
         consume(TOKEN_RBRACKET, "Expected ']'");
+        if (baseType->kind == TypeKind::VECTOR)
+        {
+            errorReporter.reportError("Arrays of vectors are not supported", line, column);
+            return ErrorType;
+        }
         return make_shared<ArrayType>(baseType, size);
     }
 
@@ -92,9 +140,22 @@ shared_ptr<Program> Parser::parseProgram()
     while (!check(TOKEN_EOF) && !check(TOKEN_ERROR))
     {
         shared_ptr<ASTNode> decl;
-        if (check(TOKEN_FUNCTION))
+        if (check(TOKEN_AT) || check(TOKEN_FUNCTION))
         {
-            decl = parseFunction();
+            vector<Annotation> annotations = parseAnnotations();
+            if (check(TOKEN_FOR))
+            {
+                decl = parseAnnotatedFor(annotations);
+            }
+            else
+            {
+                auto function = parseFunction();
+                if (function)
+                {
+                    function->annotations = annotations;
+                }
+                decl = function;
+            }
         }
         else
         {
@@ -115,6 +176,42 @@ shared_ptr<Program> Parser::parseProgram()
     return make_shared<Program>(declarations);
 }
 
+vector<Annotation> Parser::parseAnnotations()
+{
+    vector<Annotation> annotations;
+
+    while (match(TOKEN_AT))
+    {
+        if (currentToken.type != TOKEN_IDENT)
+        {
+            errorReporter.reportError("Expected annotation name after '@'", currentToken.line, currentToken.column);
+            return annotations;
+        }
+
+        Annotation annotation(currentToken.text, currentToken.line, currentToken.column);
+        advance();
+
+        if (match(TOKEN_LPAREN))
+        {
+            do
+            {
+                if (currentToken.type != TOKEN_INT_LITERAL)
+                {
+                    errorReporter.reportError("Expected integer annotation argument", currentToken.line, currentToken.column);
+                    return annotations;
+                }
+                annotation.args.push_back(stoi(currentToken.text));
+                advance();
+            } while (match(TOKEN_COMMA));
+            consume(TOKEN_RPAREN, "Expected ')'");
+        }
+
+        annotations.push_back(annotation);
+    }
+
+    return annotations;
+}
+
 shared_ptr<Function> Parser::parseFunction()
 {
     consume(TOKEN_FUNCTION, "Expected 'function'");
@@ -138,6 +235,7 @@ shared_ptr<Function> Parser::parseFunction()
     {
         do
         {
+            bool noalias = match(TOKEN_NOALIAS);
             shared_ptr<Type> paramType = parseType();
 
             if (currentToken.type != TOKEN_IDENT)
@@ -149,7 +247,7 @@ shared_ptr<Function> Parser::parseFunction()
             string paramName = currentToken.text;
             advance();
 
-            parameters.push_back(Parameter(paramType, paramName));
+            parameters.push_back(Parameter(paramType, paramName, noalias));
         } while (match(TOKEN_COMMA));
     }
 
@@ -163,7 +261,9 @@ shared_ptr<Function> Parser::parseFunction()
 
 shared_ptr<Statement> Parser::parseStatement()
 {
-    if (check(TOKEN_INT) || check(TOKEN_FLOAT) || check(TOKEN_STRING) || check(TOKEN_BOOL))
+    if (check(TOKEN_INT) || check(TOKEN_FLOAT) || check(TOKEN_STRING) || check(TOKEN_BOOL) ||
+        check(TOKEN_TASK) || check(TOKEN_CHANNEL) || check(TOKEN_ATOMIC) ||
+        check(TOKEN_VECTOR))
     {
         return parseVarDeclaration();
     }
@@ -188,6 +288,22 @@ shared_ptr<Statement> Parser::parseStatement()
         return parseForStatement();
     }
 
+    if (check(TOKEN_PARALLEL))
+    {
+        return parseParallelFor();
+    }
+
+    if (check(TOKEN_AT))
+    {
+        vector<Annotation> annotations = parseAnnotations();
+        if (!check(TOKEN_FOR))
+        {
+            errorReporter.reportError("Expected 'for' after loop annotation", currentToken.line, currentToken.column);
+            return nullptr;
+        }
+        return parseAnnotatedFor(annotations);
+    }
+
     if (check(TOKEN_RETURN))
     {
         return parseReturnStatement();
@@ -290,7 +406,9 @@ shared_ptr<ForStatement> Parser::parseForStatement()
     shared_ptr<Statement> init = nullptr;
     if (!check(TOKEN_SEMICOLON))
     {
-        if (check(TOKEN_INT) || check(TOKEN_FLOAT) || check(TOKEN_STRING) || check(TOKEN_BOOL))
+        if (check(TOKEN_INT) || check(TOKEN_FLOAT) || check(TOKEN_STRING) || check(TOKEN_BOOL) ||
+            check(TOKEN_TASK) || check(TOKEN_CHANNEL) || check(TOKEN_ATOMIC) ||
+            check(TOKEN_VECTOR))
         {
             init = parseVarDeclaration();
         }
@@ -325,6 +443,27 @@ shared_ptr<ForStatement> Parser::parseForStatement()
     return make_shared<ForStatement>(init, condition, update, body);
 }
 
+shared_ptr<ForStatement> Parser::parseAnnotatedFor(const vector<Annotation> &annotations)
+{
+    auto loop = parseForStatement();
+    loop->annotations = annotations;
+    return loop;
+}
+
+shared_ptr<ForStatement> Parser::parseParallelFor()
+{
+    consume(TOKEN_PARALLEL, "Expected 'parallel'");
+    if (!check(TOKEN_FOR))
+    {
+        errorReporter.reportError("Expected 'for' after 'parallel'", currentToken.line, currentToken.column);
+        return nullptr;
+    }
+
+    auto loop = parseForStatement();
+    loop->parallel = true;
+    return loop;
+}
+
 shared_ptr<ReturnStatement> Parser::parseReturnStatement()
 {
     consume(TOKEN_RETURN, "Expected 'return'");
@@ -552,6 +691,30 @@ shared_ptr<Expression> Parser::parseUnary()
         return make_shared<UnaryOp>(op, expr);
     }
 
+    if (match(TOKEN_SPAWN))
+    {
+        int line = currentToken.line;
+        int column = currentToken.column;
+        shared_ptr<Expression> expr = parsePostfix();
+        if (!expr)
+            return nullptr;
+        auto call = dynamic_pointer_cast<FunctionCall>(expr);
+        if (!call)
+        {
+            errorReporter.reportError("Expected function call after 'spawn'", line, column);
+            return nullptr;
+        }
+        return make_shared<SpawnExpression>(call);
+    }
+
+    if (match(TOKEN_AWAIT))
+    {
+        shared_ptr<Expression> task = parseUnary();
+        if (!task)
+            return nullptr;
+        return make_shared<AwaitExpression>(task);
+    }
+
     return parsePostfix();
 }
 
@@ -657,6 +820,40 @@ shared_ptr<Expression> Parser::parsePrimary()
         return expr;
     }
 
+    if (check(TOKEN_CHANNEL))
+    {
+        shared_ptr<Type> type = parseType();
+        if (type->kind != TypeKind::CHANNEL)
+        {
+            if (type->kind != TypeKind::ERROR)
+                errorReporter.reportError("Expected channel type", currentToken.line, currentToken.column);
+            return nullptr;
+        }
+        consume(TOKEN_LPAREN, "Expected '(' with the channel capacity");
+        shared_ptr<Expression> capacity = parseExpression();
+        if (!capacity)
+            return nullptr;
+        consume(TOKEN_RPAREN, "Expected ')'");
+        return make_shared<ChannelExpression>(type, capacity);
+    }
+
+    if (check(TOKEN_VECTOR))
+    {
+        shared_ptr<Type> type = vectorType(currentToken.text);
+        advance();
+        consume(TOKEN_LPAREN, "Expected '(' after '" + type->toString() + "'");
+        vector<shared_ptr<Expression>> args;
+        do
+        {
+            shared_ptr<Expression> arg = parseExpression();
+            if (!arg)
+                return nullptr;
+            args.push_back(arg);
+        } while (match(TOKEN_COMMA));
+        consume(TOKEN_RPAREN, "Expected ')'");
+        return make_shared<VectorExpression>(type, args);
+    }
+
     errorReporter.reportError("Expected expression", currentToken.line, currentToken.column);
     advance();
     return nullptr;
@@ -21,6 +21,7 @@ private:
 
     shared_ptr<Type> parseType();
     shared_ptr<Program> parseProgram();
+    vector<Annotation> parseAnnotations();
     shared_ptr<Function> parseFunction();
     shared_ptr<Statement> parseStatement();
     shared_ptr<VarDeclaration> parseVarDeclaration();
@@ -28,6 +29,8 @@ private:
     shared_ptr<IfStatement> parseIfStatement();
     shared_ptr<WhileStatement> parseWhileStatement();
     shared_ptr<ForStatement> parseForStatement();
+    shared_ptr<ForStatement> parseAnnotatedFor(const vector<Annotation> &annotations);
+    shared_ptr<ForStatement> parseParallelFor();
     shared_ptr<ReturnStatement> parseReturnStatement();
     shared_ptr<PrintStatement> parsePrintStatement();
     shared_ptr<Statement> parseExpressionStatement();
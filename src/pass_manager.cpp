@@ -0,0 +1,115 @@
+#include "pass_manager.h"
+#include "bounds_check.h"
+#include "dce.h"
+#include "function_attrs.h"
+#include "gvn.h"
+#include "inliner.h"
+#include "ir_verifier.h"
+#include "licm.h"
+#include "loop_fusion.h"
+#include "loop_unroll.h"
+#include "memoize.h"
+#include "merge_functions.h"
+#include "scalar_replacement.h"
+#include "sccp.h"
+#include "simplify_cfg.h"
+#include "specialization.h"
+#include "strength_reduction.h"
+#include "tail_recursion.h"
+
+using namespace std;
+
+bool FunctionPass::runOnModule(IRModule &module)
+{
+    bool changed = false;
+    for (auto &function : module.functions)
+    {
+        changed = runOnFunction(*function) || changed;
+    }
+    return changed;
+}
+
+PassManager::PassManager(bool verifyEach, bool printStatistics)
+    : verifyEach(verifyEach), printStatistics(printStatistics) {}
+
+void PassManager::add(unique_ptr<Pass> pass)
+{
+    passes.push_back(move(pass));
+}
+
+bool PassManager::run(IRModule &module)
+{
+    for (auto &pass : passes)
+    {
+        pass->runOnModule(module);
+        if (printStatistics)
+            pass->printStatistics(cerr);
+
+        if (verifyEach)
+        {
+            IRVerifier verifier;
+            if (!verifier.verify(module))
+            {
+                cerr << "Internal error: invalid IR after pass '" << pass->name() << "'" << endl;
+                for (const auto &error : verifier.getErrors())
+                {
+                    cerr << "  " << error << endl;
+                }
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void buildPipeline(PassManager &manager, const CompilerOptions &options)
+{
+    manager.add(make_unique<Memoize>(options.autoMemo));
+
+    if (options.optLevel == 0)
+        return;
+
+    manager.add(make_unique<GlobalDCE>());
+    manager.add(make_unique<SimplifyCFG>());
+    manager.add(make_unique<SCCP>());
+    manager.add(make_unique<SimplifyCFG>());
+    manager.add(make_unique<TailRecursionElimination>());
+
+    if (options.specializeBudget > 0)
+    {
+        manager.add(make_unique<FunctionSpecialization>(options.specializeBudget));
+        manager.add(make_unique<SCCP>());
+        manager.add(make_unique<SimplifyCFG>());
+    }
+
+    if (options.inlineThreshold > 0 && options.inlineDepth > 0)
+    {
+        manager.add(make_unique<Inliner>(options.inlineThreshold, options.inlineDepth));
+        manager.add(make_unique<SCCP>());
+        manager.add(make_unique<SimplifyCFG>());
+    }
+
+    if (options.boundsCheck)
+        manager.add(make_unique<BoundsCheckElimination>());
+
+    manager.add(make_unique<LoopFusion>());
+    manager.add(make_unique<GVN>());
+    manager.add(make_unique<LICM>());
+    manager.add(make_unique<ScalarReplacement>());
+    manager.add(make_unique<StrengthReduction>());
+
+    if (options.unrollThreshold > 0)
+    {
+        manager.add(make_unique<LoopUnroll>(options.unrollThreshold));
+        manager.add(make_unique<SimplifyCFG>());
+        manager.add(make_unique<GVN>());
+        manager.add(make_unique<SCCP>());
+        manager.add(make_unique<SimplifyCFG>());
+    }
+
+    manager.add(make_unique<DeadCodeElimination>());
+    manager.add(make_unique<SimplifyCFG>());
+    manager.add(make_unique<MergeFunctions>());
+    manager.add(make_unique<GlobalDCE>());
+    manager.add(make_unique<FunctionAttrs>());
+}
@@ -0,0 +1,44 @@
+#ifndef PASS_MANAGER_H
+#define PASS_MANAGER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "ir.h"
+#include "options.h"
+
+using namespace std;
+
+class Pass
+{
+public:
+    virtual ~Pass() = default;
+    virtual string name() const = 0;
+    virtual bool runOnModule(IRModule &module) = 0;
+    virtual void printStatistics(ostream &) const {}
+};
+
+class FunctionPass : public Pass
+{
+public:
+    virtual bool runOnFunction(IRFunction &function) = 0;
+    bool runOnModule(IRModule &module) override;
+};
+
+class PassManager
+{
+private:
+    vector<unique_ptr<Pass>> passes;
+    bool verifyEach;
+    bool printStatistics;
+
+public:
+    PassManager(bool verifyEach = false, bool printStatistics = false);
+
+    void add(unique_ptr<Pass> pass);
+    bool run(IRModule &module);
+};
+
+void buildPipeline(PassManager &manager, const CompilerOptions &options);
+
+#endif
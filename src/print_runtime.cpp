@@ -0,0 +1,147 @@
+#include "print_runtime.h"
+
+using namespace std;
+
+// Lines from all threads go to one buffer in the order they were printed, so output that happens before an
+// await or a channel operation still comes out first. The buffer is written when full, at exit, and after
+// every line when stdout is a terminal.
+const char *const printRuntimeSource = R"nova(#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define NOVA_OUT_CAPACITY (1 << 16)
+
+static struct
+{
+    pthread_mutex_t lock;
+    int interactive;
+    size_t length;
+    char data[NOVA_OUT_CAPACITY];
+} nova_out = {PTHREAD_MUTEX_INITIALIZER, 0, 0, {0}};
+
+static void nova_out_write(const char *data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t written = write(1, data, length);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return;
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+static void nova_out_flush(void)
+{
+    pthread_mutex_lock(&nova_out.lock);
+    nova_out_write(nova_out.data, nova_out.length);
+    nova_out.length = 0;
+    pthread_mutex_unlock(&nova_out.lock);
+}
+
+// Runs before every unprioritized constructor, so the flush is registered first and runs after every other exit
+// handler, including the one that waits for spawned tasks.
+__attribute__((constructor(101))) static void nova_out_init(void)
+{
+    nova_out.interactive = isatty(1);
+    atexit(nova_out_flush);
+}
+
+static void nova_out_line(const char *text, size_t length)
+{
+    pthread_mutex_lock(&nova_out.lock);
+    if (nova_out.length + length + 1 > NOVA_OUT_CAPACITY)
+    {
+        nova_out_write(nova_out.data, nova_out.length);
+        nova_out.length = 0;
+    }
+    if (length + 1 > NOVA_OUT_CAPACITY)
+    {
+        nova_out_write(text, length);
+        nova_out_write("\n", 1);
+    }
+    else
+    {
+        memcpy(nova_out.data + nova_out.length, text, length);
+        nova_out.data[nova_out.length + length] = '\n';
+        nova_out.length += length + 1;
+        if (nova_out.interactive)
+        {
+            nova_out_write(nova_out.data, nova_out.length);
+            nova_out.length = 0;
+        }
+    }
+    pthread_mutex_unlock(&nova_out.lock);
+}
+
+static char *nova_format_digits(char *end, unsigned long long value, int digits)
+{
+    do
+    {
+        *--end = (char)('0' + value % 10);
+        value /= 10;
+    } while (--digits > 0 || value > 0);
+    return end;
+}
+
+static void nova_print_int(int value)
+{
+    char buffer[16];
+    char *end = buffer + sizeof(buffer);
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    char *start = nova_format_digits(end, magnitude, 1);
+    if (value < 0)
+        *--start = '-';
+    nova_out_line(start, (size_t)(end - start));
+}
+
+// A float times 10^6 is exact in a double, so rounding it once to an integer, ties to even, gives the same
+// six decimals as printf's correctly rounded %f. The rounding is done by hand because programs are not
+// linked with libm.
+static void nova_print_float(float value)
+{
+    char buffer[64];
+    double scaled = __builtin_signbit(value) ? (double)value * -1e6 : (double)value * 1e6;
+    if (!(scaled < 9e18))
+    {
+        int length = snprintf(buffer, sizeof(buffer), "%f", value);
+        nova_out_line(buffer, (size_t)length);
+        return;
+    }
+    unsigned long long magnitude = (unsigned long long)scaled;
+    double rest = scaled - (double)magnitude;
+    if (rest > 0.5 || (rest == 0.5 && (magnitude & 1)))
+        magnitude++;
+    char *end = buffer + sizeof(buffer);
+    char *start = nova_format_digits(end, magnitude % 1000000, 6);
+    *--start = '.';
+    start = nova_format_digits(start, magnitude / 1000000, 1);
+    if (__builtin_signbit(value))
+        *--start = '-';
+    nova_out_line(start, (size_t)(end - start));
+}
+
+static void nova_print_string(const char *value)
+{
+    if (!value)
+        value = "(null)";
+    nova_out_line(value, strlen(value));
+}
+)nova";
+
+string printCall(const shared_ptr<Type> &type, const string &value)
+{
+    switch (type->kind)
+    {
+    case TypeKind::INT:
+        return "nova_print_int(" + value + ")";
+    case TypeKind::FLOAT:
+        return "nova_print_float(" + value + ")";
+    case TypeKind::BOOL:
+        return "nova_print_string(" + value + " ? \"true\" : \"false\")";
+    default:
+        return "nova_print_string(" + value + ")";
+    }
+}
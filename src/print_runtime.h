@@ -0,0 +1,16 @@
+#ifndef PRINT_RUNTIME_H
+#define PRINT_RUNTIME_H
+
+#include <string>
+#include "types.h"
+
+using namespace std;
+
+// C source of the buffered stdout writer behind `print`, emitted into programs that print.
+extern const char *const printRuntimeSource;
+
+// C call printing the C expression `value` of the given type on a line of its own, formatted as printf's
+// %d, %f or %s would.
+string printCall(const shared_ptr<Type> &type, const string &value);
+
+#endif
@@ -0,0 +1,126 @@
+#include "purity.h"
+
+using namespace std;
+
+bool isLocalArray(const Instruction *base)
+{
+    return base->op == Opcode::ARRAY;
+}
+
+static bool isScalar(shared_ptr<Type> type)
+{
+    return type->kind == TypeKind::INT || type->kind == TypeKind::FLOAT || type->kind == TypeKind::BOOL;
+}
+
+FunctionEffects PurityAnalysis::localEffects(const IRFunction &function)
+{
+    FunctionEffects result;
+    for (auto &block : function.blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            switch (instr->op)
+            {
+            case Opcode::LOAD:
+                result.readsMemory = result.readsMemory || !isLocalArray(instr->operands[0]);
+                break;
+            case Opcode::STORE:
+                result.writesMemory = result.writesMemory || !isLocalArray(instr->operands[0]);
+                break;
+            case Opcode::LOAD_GLOBAL:
+                result.readsMemory = true;
+                break;
+            case Opcode::STORE_GLOBAL:
+                result.writesMemory = true;
+                break;
+            case Opcode::PRINT:
+                result.performsIO = true;
+                break;
+            case Opcode::CALL:
+                if (!function.module->getFunction(instr->text))
+                {
+                    result.readsMemory = result.writesMemory = result.performsIO = true;
+                }
+                break;
+            case Opcode::AWAIT:
+                // The handle may come from anywhere, so its task's effects are unknown.
+                result.readsMemory = result.writesMemory = result.performsIO = true;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+PurityAnalysis::PurityAnalysis(const IRModule &module)
+{
+    for (auto &function : module.functions)
+    {
+        effects[function.get()] = localEffects(*function);
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto &function : module.functions)
+        {
+            FunctionEffects current = effects[function.get()];
+            FunctionEffects merged = current;
+            for (auto &block : function->blocks)
+            {
+                for (auto &instr : block->instructions)
+                {
+                    if (instr->op != Opcode::CALL)
+                        continue;
+                    IRFunction *callee = module.getFunction(instr->text);
+                    if (!callee)
+                        continue;
+
+                    const FunctionEffects &other = effects[callee];
+                    merged.readsMemory = merged.readsMemory || other.readsMemory;
+                    merged.writesMemory = merged.writesMemory || other.writesMemory;
+                    merged.performsIO = merged.performsIO || other.performsIO;
+                }
+            }
+            if (!(merged == current))
+            {
+                effects[function.get()] = merged;
+                changed = true;
+            }
+        }
+    }
+}
+
+FunctionEffects PurityAnalysis::effectsOf(const IRFunction *function) const
+{
+    auto it = effects.find(function);
+    if (it == effects.end())
+    {
+        FunctionEffects unknown;
+        unknown.readsMemory = unknown.writesMemory = unknown.performsIO = true;
+        return unknown;
+    }
+    return it->second;
+}
+
+bool PurityAnalysis::isPure(const IRFunction *function) const
+{
+    FunctionEffects result = effectsOf(function);
+    return !result.readsMemory && !result.writesMemory && !result.performsIO;
+}
+
+bool PurityAnalysis::isMemoizable(const IRFunction *function) const
+{
+    if (function->isMain() || !isScalar(function->returnType) || !isPure(function))
+        return false;
+
+    for (auto &param : function->params)
+    {
+        if (!isScalar(param->type))
+            return false;
+    }
+    return true;
+}
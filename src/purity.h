@@ -0,0 +1,39 @@
+#ifndef PURITY_H
+#define PURITY_H
+
+#include <unordered_map>
+#include "ir.h"
+
+using namespace std;
+
+struct FunctionEffects
+{
+    bool readsMemory = false;
+    bool writesMemory = false;
+    bool performsIO = false;
+
+    bool operator==(const FunctionEffects &other) const
+    {
+        return readsMemory == other.readsMemory && writesMemory == other.writesMemory &&
+               performsIO == other.performsIO;
+    }
+};
+
+class PurityAnalysis
+{
+private:
+    unordered_map<const IRFunction *, FunctionEffects> effects;
+
+    FunctionEffects localEffects(const IRFunction &function);
+
+public:
+    PurityAnalysis(const IRModule &module);
+
+    FunctionEffects effectsOf(const IRFunction *function) const;
+    bool isPure(const IRFunction *function) const;
+    bool isMemoizable(const IRFunction *function) const;
+};
+
+bool isLocalArray(const Instruction *base);
+
+#endif
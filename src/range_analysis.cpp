@@ -0,0 +1,205 @@
+#include "range_analysis.h"
+#include <algorithm>
+
+using namespace std;
+
+static ValueRange rangeFrom(long long lo, long long hi)
+{
+    if (lo < INT_MIN || hi > INT_MAX)
+        return ValueRange();
+    return {lo, hi};
+}
+
+ValueRange RangeAnalysis::rangeOf(Instruction *value)
+{
+    if (value->type->kind != TypeKind::INT)
+        return ValueRange();
+    if (value->isConstant())
+        return {value->intValue, value->intValue};
+
+    auto it = cache.find(value);
+    if (it != cache.end())
+        return it->second;
+    if (!active.insert(value).second)
+        return ValueRange();
+
+    ValueRange range = compute(value);
+    active.erase(value);
+    cache[value] = range;
+    return range;
+}
+
+ValueRange RangeAnalysis::rangeAt(Instruction *value, BasicBlock *block)
+{
+    return refine(value, block, rangeOf(value), 0);
+}
+
+ValueRange RangeAnalysis::refine(Instruction *value, BasicBlock *block, ValueRange range, int depth)
+{
+    for (BasicBlock *current = block; current;)
+    {
+        BasicBlock *dominator = dominators.immediateDominator(current);
+        if (!dominator)
+            break;
+
+        Instruction *term = dominator->terminator();
+        if (term && term->op == Opcode::CONDBR && term->blocks[0] != term->blocks[1] && current->preds.size() == 1)
+            range = assume(value, term->operands[0], current == term->blocks[0], range, depth);
+        current = dominator;
+    }
+    return range;
+}
+
+ValueRange RangeAnalysis::assume(Instruction *value, Instruction *cond, bool holds, ValueRange range, int depth)
+{
+    if (cond->isComparison())
+    {
+        Opcode predicate = holds ? cond->op : invertPredicate(cond->op);
+        if (cond->operands[0] == value)
+            return constrain(range, predicate, rangeOf(cond->operands[1]));
+        if (cond->operands[1] == value)
+            return constrain(range, swapPredicate(predicate), rangeOf(cond->operands[0]));
+        return range;
+    }
+    if (cond->op == Opcode::NOT)
+        return assume(value, cond->operands[0], !holds, range, depth);
+    if (cond->op != Opcode::PHI || depth >= 4)
+        return range;
+
+    // Short-circuit '&&' and '||' merge a constant with the second test; only one incoming edge can produce the outcome.
+    int source = -1;
+    for (size_t i = 0; i < cond->operands.size(); ++i)
+    {
+        Instruction *incoming = cond->operands[i];
+        if (incoming->isConstant() && (incoming->intValue != 0) != holds)
+            continue;
+        if (source >= 0)
+            return range;
+        source = static_cast<int>(i);
+    }
+    if (source < 0)
+        return range;
+
+    range = assume(value, cond->operands[source], holds, range, depth + 1);
+    return refine(value, cond->blocks[source], range, depth + 1);
+}
+
+ValueRange RangeAnalysis::constrain(ValueRange range, Opcode predicate, const ValueRange &bound)
+{
+    switch (predicate)
+    {
+    case Opcode::LT:
+        range.hi = min(range.hi, bound.hi - 1);
+        break;
+    case Opcode::LE:
+        range.hi = min(range.hi, bound.hi);
+        break;
+    case Opcode::GT:
+        range.lo = max(range.lo, bound.lo + 1);
+        break;
+    case Opcode::GE:
+        range.lo = max(range.lo, bound.lo);
+        break;
+    case Opcode::EQ:
+        range.lo = max(range.lo, bound.lo);
+        range.hi = min(range.hi, bound.hi);
+        break;
+    default:
+        break;
+    }
+    return range;
+}
+
+ValueRange RangeAnalysis::inductionRange(Instruction *phi)
+{
+    Loop *loop = loops.loopFor(phi->parent);
+    if (!loop || loop->header != phi->parent || !loop->preheader())
+        return ValueRange();
+
+    auto &analysis = inductions[loop];
+    if (!analysis)
+        analysis = make_unique<InductionAnalysis>(loop);
+
+    ExitCondition condition = analysis->exitCondition();
+    const InductionVariable *variable = condition.variable;
+    if (!variable || variable->phi != phi || !loop->isInvariant(condition.bound))
+        return ValueRange();
+
+    BasicBlock *preheader = loop->preheader();
+    ValueRange start = rangeAt(variable->start, preheader);
+    ValueRange bound = rangeAt(condition.bound, preheader);
+    long long step = variable->step;
+
+    // The latch only runs after the header test passed, so the next value overshoots the bound by at most one step.
+    if (step > 0 && (condition.predicate == Opcode::LT || condition.predicate == Opcode::LE))
+    {
+        long long last = condition.predicate == Opcode::LT ? bound.hi - 1 : bound.hi;
+        return rangeFrom(start.lo, max(start.hi, last + step));
+    }
+    if (step < 0 && (condition.predicate == Opcode::GT || condition.predicate == Opcode::GE))
+    {
+        long long last = condition.predicate == Opcode::GT ? bound.lo + 1 : bound.lo;
+        return rangeFrom(min(start.lo, last + step), start.hi);
+    }
+    return ValueRange();
+}
+
+ValueRange RangeAnalysis::compute(Instruction *value)
+{
+    BasicBlock *block = value->parent;
+    if (!block)
+        return ValueRange();
+
+    if (value->op == Opcode::PHI)
+    {
+        ValueRange induction = inductionRange(value);
+        if (induction.lo != INT_MIN || induction.hi != INT_MAX)
+            return induction;
+
+        ValueRange range{INT_MAX, INT_MIN};
+        for (size_t i = 0; i < value->operands.size(); ++i)
+        {
+            ValueRange incoming = rangeAt(value->operands[i], value->blocks[i]);
+            range.lo = min(range.lo, incoming.lo);
+            range.hi = max(range.hi, incoming.hi);
+        }
+        return value->operands.empty() ? ValueRange() : range;
+    }
+
+    if (value->operands.empty() || value->operands.size() > 2)
+        return ValueRange();
+    ValueRange a = rangeAt(value->operands[0], block);
+    ValueRange b = value->operands.size() == 2 ? rangeAt(value->operands[1], block) : ValueRange();
+
+    switch (value->op)
+    {
+    case Opcode::ADD:
+        return rangeFrom(a.lo + b.lo, a.hi + b.hi);
+    case Opcode::SUB:
+        return rangeFrom(a.lo - b.hi, a.hi - b.lo);
+    case Opcode::MUL:
+    {
+        long long products[] = {a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi};
+        return rangeFrom(*min_element(products, products + 4), *max_element(products, products + 4));
+    }
+    case Opcode::DIV:
+        if (b.lo > 0)
+            return rangeFrom(min(a.lo / b.lo, a.lo / b.hi), max(a.hi / b.lo, a.hi / b.hi));
+        return ValueRange();
+    case Opcode::REM:
+    {
+        if (b.lo <= 0)
+            return ValueRange();
+        long long limit = b.hi - 1;
+        if (a.lo >= 0)
+            return {0, min(a.hi, limit)};
+        if (a.hi <= 0)
+            return {max(a.lo, -limit), 0};
+        return {-limit, limit};
+    }
+    case Opcode::NEG:
+        return rangeFrom(-a.hi, -a.lo);
+    default:
+        return ValueRange();
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef RANGE_ANALYSIS_H
+#define RANGE_ANALYSIS_H
+
+#include <climits>
+#include <unordered_map>
+#include <unordered_set>
+#include "induction.h"
+
+using namespace std;
+
+struct ValueRange
+{
+    long long lo = INT_MIN;
+    long long hi = INT_MAX;
+
+    bool within(long long low, long long high) const { return low <= lo && hi <= high; }
+};
+
+class RangeAnalysis
+{
+private:
+    const DominatorTree &dominators;
+    const LoopInfo &loops;
+    unordered_map<Loop *, unique_ptr<InductionAnalysis>> inductions;
+    unordered_map<const Instruction *, ValueRange> cache;
+    unordered_set<const Instruction *> active;
+
+    ValueRange compute(Instruction *value);
+    ValueRange inductionRange(Instruction *phi);
+    ValueRange refine(Instruction *value, BasicBlock *block, ValueRange range, int depth);
+    ValueRange assume(Instruction *value, Instruction *cond, bool holds, ValueRange range, int depth);
+    ValueRange constrain(ValueRange range, Opcode predicate, const ValueRange &bound);
+
+public:
+    RangeAnalysis(const DominatorTree &dominators, const LoopInfo &loops)
+        : dominators(dominators), loops(loops) {}
+
+    ValueRange rangeOf(Instruction *value);
+    ValueRange rangeAt(Instruction *value, BasicBlock *block);
+};
+
+#endif
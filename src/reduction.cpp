@@ -0,0 +1,423 @@
+#include "reduction.h"
+
+using namespace std;
+
+static bool isVariableNamed(Expression *expr, const string &name)
+{
+    auto variable = dynamic_cast<Variable *>(expr);
+    return variable && variable->name == name;
+}
+
+static bool mentions(Expression *expr, const string &name)
+{
+    if (auto variable = dynamic_cast<Variable *>(expr))
+        return variable->name == name;
+    if (auto access = dynamic_cast<ArrayAccess *>(expr))
+        return mentions(access->array.get(), name) || mentions(access->index.get(), name);
+    if (auto binary = dynamic_cast<BinaryOp *>(expr))
+        return mentions(binary->left.get(), name) || mentions(binary->right.get(), name);
+    if (auto unary = dynamic_cast<UnaryOp *>(expr))
+        return mentions(unary->expr.get(), name);
+    if (auto call = dynamic_cast<FunctionCall *>(expr))
+    {
+        for (auto &arg : call->args)
+        {
+            if (mentions(arg.get(), name))
+                return true;
+        }
+    }
+    if (auto vector = dynamic_cast<VectorExpression *>(expr))
+    {
+        for (auto &arg : vector->args)
+        {
+            if (mentions(arg.get(), name))
+                return true;
+        }
+    }
+    if (auto spawn = dynamic_cast<SpawnExpression *>(expr))
+        return mentions(spawn->call.get(), name);
+    if (auto await = dynamic_cast<AwaitExpression *>(expr))
+        return mentions(await->task.get(), name);
+    if (auto channel = dynamic_cast<ChannelExpression *>(expr))
+        return mentions(channel->capacity.get(), name);
+    return false;
+}
+
+static bool sameExpression(Expression *a, Expression *b)
+{
+    if (auto x = dynamic_cast<IntLiteral *>(a))
+    {
+        auto y = dynamic_cast<IntLiteral *>(b);
+        return y && x->value == y->value;
+    }
+    if (auto x = dynamic_cast<FloatLiteral *>(a))
+    {
+        auto y = dynamic_cast<FloatLiteral *>(b);
+        return y && x->value == y->value;
+    }
+    if (auto x = dynamic_cast<Variable *>(a))
+        return isVariableNamed(b, x->name);
+    if (auto x = dynamic_cast<ArrayAccess *>(a))
+    {
+        auto y = dynamic_cast<ArrayAccess *>(b);
+        return y && sameExpression(x->array.get(), y->array.get()) && sameExpression(x->index.get(), y->index.get());
+    }
+    if (auto x = dynamic_cast<BinaryOp *>(a))
+    {
+        auto y = dynamic_cast<BinaryOp *>(b);
+        return y && x->op == y->op && x->op != "=" && sameExpression(x->left.get(), y->left.get()) &&
+               sameExpression(x->right.get(), y->right.get());
+    }
+    if (auto x = dynamic_cast<UnaryOp *>(a))
+    {
+        auto y = dynamic_cast<UnaryOp *>(b);
+        return y && x->op == y->op && sameExpression(x->expr.get(), y->expr.get());
+    }
+    return false;
+}
+
+bool isCanonicalLoop(ForStatement *loop)
+{
+    auto init = dynamic_cast<VarDeclaration *>(loop->init.get());
+    auto condition = dynamic_cast<BinaryOp *>(loop->condition.get());
+    auto update = dynamic_cast<ExpressionStatement *>(loop->update.get());
+    auto assignment = update ? dynamic_cast<BinaryOp *>(update->expr.get()) : nullptr;
+    auto increment = assignment ? dynamic_cast<BinaryOp *>(assignment->right.get()) : nullptr;
+    auto step = increment ? dynamic_cast<IntLiteral *>(increment->right.get()) : nullptr;
+
+    return init && init->type->kind == TypeKind::INT && init->initializer &&
+           condition && condition->op == "<" && isVariableNamed(condition->left.get(), init->name) &&
+           condition->right->type && condition->right->type->kind == TypeKind::INT &&
+           assignment && assignment->op == "=" && isVariableNamed(assignment->left.get(), init->name) &&
+           increment && increment->op == "+" && isVariableNamed(increment->left.get(), init->name) &&
+           step && step->value == 1;
+}
+
+static bool isIndependent(Expression *expr, const string &induction)
+{
+    if (auto access = dynamic_cast<ArrayAccess *>(expr))
+    {
+        if (access->array->type->kind == TypeKind::ARRAY && !isVariableNamed(access->index.get(), induction))
+            return false;
+        return isIndependent(access->array.get(), induction) && isIndependent(access->index.get(), induction);
+    }
+    if (auto binary = dynamic_cast<BinaryOp *>(expr))
+    {
+        if (binary->op == "=" && isVariableNamed(binary->left.get(), induction))
+            return false;
+        return isIndependent(binary->left.get(), induction) && isIndependent(binary->right.get(), induction);
+    }
+    if (auto unary = dynamic_cast<UnaryOp *>(expr))
+        return isIndependent(unary->expr.get(), induction);
+    if (auto vector = dynamic_cast<VectorExpression *>(expr))
+    {
+        // Loading a whole vector reads past element i.
+        if (vector->args.size() == 2 && vector->args[0]->type->kind == TypeKind::ARRAY)
+            return false;
+        for (auto &arg : vector->args)
+        {
+            if (!isIndependent(arg.get(), induction))
+                return false;
+        }
+        return true;
+    }
+    return dynamic_cast<Variable *>(expr) || dynamic_cast<IntLiteral *>(expr) ||
+           dynamic_cast<FloatLiteral *>(expr) || dynamic_cast<BoolLiteral *>(expr);
+}
+
+static bool isIndependent(Statement *stmt, const string &induction)
+{
+    if (auto block = dynamic_cast<Block *>(stmt))
+    {
+        for (auto &child : block->statements)
+        {
+            if (!isIndependent(child.get(), induction))
+                return false;
+        }
+        return true;
+    }
+    if (auto decl = dynamic_cast<VarDeclaration *>(stmt))
+        return decl->name != induction && decl->type->kind != TypeKind::ARRAY &&
+               (!decl->initializer || isIndependent(decl->initializer.get(), induction));
+    if (auto assignment = dynamic_cast<Assignment *>(stmt))
+        return !isVariableNamed(assignment->target.get(), induction) &&
+               isIndependent(assignment->target.get(), induction) && isIndependent(assignment->value.get(), induction);
+    if (auto expr = dynamic_cast<ExpressionStatement *>(stmt))
+        return isIndependent(expr->expr.get(), induction);
+    if (auto branch = dynamic_cast<IfStatement *>(stmt))
+        return isIndependent(branch->condition.get(), induction) &&
+               isIndependent(branch->thenBranch.get(), induction) &&
+               (!branch->elseBranch || isIndependent(branch->elseBranch.get(), induction));
+    return false;
+}
+
+bool hasIndependentIterations(ForStatement *loop)
+{
+    return isCanonicalLoop(loop) &&
+           isIndependent(loop->body.get(), static_cast<VarDeclaration *>(loop->init.get())->name);
+}
+
+ReductionAnalysis::ReductionAnalysis(ForStatement *loop)
+    : sideEffects(false), nestedLoops(false)
+{
+    auto init = static_cast<VarDeclaration *>(loop->init.get());
+    visitExpression(init->initializer.get());
+
+    induction = init->name;
+    locals.push_back({induction});
+    visitExpression(loop->condition.get());
+    visitScoped(loop->body.get());
+}
+
+int ReductionAnalysis::scopeOf(const string &name) const
+{
+    for (size_t i = locals.size(); i-- > 0;)
+    {
+        if (locals[i].count(name))
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void ReductionAnalysis::update(const string &name, const string &op)
+{
+    auto result = updates.insert({name, op});
+    if (result.first->second != op)
+        conflicts.insert(name);
+}
+
+void ReductionAnalysis::visitScoped(Statement *stmt)
+{
+    locals.push_back({});
+    visitStatement(stmt);
+    locals.pop_back();
+}
+
+void ReductionAnalysis::visitStatement(Statement *stmt)
+{
+    if (auto block = dynamic_cast<Block *>(stmt))
+    {
+        locals.push_back({});
+        for (auto &child : block->statements)
+        {
+            visitStatement(child.get());
+        }
+        locals.pop_back();
+    }
+    else if (auto decl = dynamic_cast<VarDeclaration *>(stmt))
+    {
+        if (decl->initializer)
+            visitExpression(decl->initializer.get());
+        locals.back().insert(decl->name);
+    }
+    else if (auto assignment = dynamic_cast<Assignment *>(stmt))
+    {
+        visitAssignment(assignment->target.get(), assignment->value.get());
+    }
+    else if (auto expr = dynamic_cast<ExpressionStatement *>(stmt))
+    {
+        visitExpression(expr->expr.get());
+    }
+    else if (auto branch = dynamic_cast<IfStatement *>(stmt))
+    {
+        if (visitMinMax(branch))
+            return;
+        visitExpression(branch->condition.get());
+        visitScoped(branch->thenBranch.get());
+        if (branch->elseBranch)
+            visitScoped(branch->elseBranch.get());
+    }
+    else if (auto loop = dynamic_cast<WhileStatement *>(stmt))
+    {
+        nestedLoops = true;
+        visitExpression(loop->condition.get());
+        visitScoped(loop->body.get());
+    }
+    else if (auto loop = dynamic_cast<ForStatement *>(stmt))
+    {
+        nestedLoops = true;
+        sideEffects = sideEffects || loop->parallel;
+        locals.push_back({});
+        if (loop->init)
+            visitStatement(loop->init.get());
+        if (loop->condition)
+            visitExpression(loop->condition.get());
+        if (loop->update)
+            visitStatement(loop->update.get());
+        visitScoped(loop->body.get());
+        locals.pop_back();
+    }
+    else if (auto ret = dynamic_cast<ReturnStatement *>(stmt))
+    {
+        sideEffects = true;
+        if (ret->value)
+            visitExpression(ret->value.get());
+    }
+    else if (auto print = dynamic_cast<PrintStatement *>(stmt))
+    {
+        sideEffects = true;
+        visitExpression(print->expr.get());
+    }
+}
+
+void ReductionAnalysis::visitExpression(Expression *expr)
+{
+    if (auto variable = dynamic_cast<Variable *>(expr))
+    {
+        if (scopeOf(variable->name) < 0)
+            reads.insert(variable->name);
+    }
+    else if (auto access = dynamic_cast<ArrayAccess *>(expr))
+    {
+        visitExpression(access->array.get());
+        visitExpression(access->index.get());
+    }
+    else if (auto binary = dynamic_cast<BinaryOp *>(expr))
+    {
+        if (binary->op == "=")
+        {
+            visitAssignment(binary->left.get(), binary->right.get());
+            return;
+        }
+        visitExpression(binary->left.get());
+        visitExpression(binary->right.get());
+    }
+    else if (auto unary = dynamic_cast<UnaryOp *>(expr))
+    {
+        visitExpression(unary->expr.get());
+    }
+    else if (auto call = dynamic_cast<FunctionCall *>(expr))
+    {
+        sideEffects = true;
+        for (auto &arg : call->args)
+        {
+            visitExpression(arg.get());
+        }
+    }
+    else if (auto spawn = dynamic_cast<SpawnExpression *>(expr))
+    {
+        visitExpression(spawn->call.get());
+    }
+    else if (auto await = dynamic_cast<AwaitExpression *>(expr))
+    {
+        sideEffects = true;
+        visitExpression(await->task.get());
+    }
+    else if (auto channel = dynamic_cast<ChannelExpression *>(expr))
+    {
+        sideEffects = true;
+        visitExpression(channel->capacity.get());
+    }
+    else if (auto vector = dynamic_cast<VectorExpression *>(expr))
+    {
+        for (auto &arg : vector->args)
+        {
+            visitExpression(arg.get());
+        }
+    }
+}
+
+void ReductionAnalysis::visitAssignment(Expression *target, Expression *value)
+{
+    auto variable = dynamic_cast<Variable *>(target);
+    if (!variable)
+    {
+        sideEffects = true;
+        visitExpression(target);
+        visitExpression(value);
+        return;
+    }
+
+    const string &name = variable->name;
+    int scope = scopeOf(name);
+    if (scope > 0)
+    {
+        visitExpression(value);
+        return;
+    }
+    if (scope == 0)
+    {
+        conflicts.insert(name);
+        visitExpression(value);
+        return;
+    }
+
+    auto binary = dynamic_cast<BinaryOp *>(value);
+    string op = binary && (binary->op == "+" || binary->op == "-") ? "+" : binary && binary->op == "*" ? "*" : "";
+    if (!op.empty() && isVariableNamed(binary->left.get(), name) && !mentions(binary->right.get(), name))
+    {
+        update(name, op);
+        visitExpression(binary->right.get());
+    }
+    else if (!op.empty() && binary->op != "-" && isVariableNamed(binary->right.get(), name) &&
+             !mentions(binary->left.get(), name))
+    {
+        update(name, op);
+        visitExpression(binary->left.get());
+    }
+    else
+    {
+        conflicts.insert(name);
+        visitExpression(value);
+    }
+}
+
+bool ReductionAnalysis::visitMinMax(IfStatement *node)
+{
+    auto condition = dynamic_cast<BinaryOp *>(node->condition.get());
+    if (node->elseBranch || !condition ||
+        (condition->op != "<" && condition->op != "<=" && condition->op != ">" && condition->op != ">="))
+        return false;
+
+    Statement *then = node->thenBranch.get();
+    auto block = dynamic_cast<Block *>(then);
+    if (block && block->statements.size() == 1)
+        then = block->statements[0].get();
+    auto statement = dynamic_cast<ExpressionStatement *>(then);
+    auto assignment = statement ? dynamic_cast<BinaryOp *>(statement->expr.get()) : nullptr;
+    auto target = assignment && assignment->op == "=" ? dynamic_cast<Variable *>(assignment->left.get()) : nullptr;
+    if (!target || scopeOf(target->name) >= 0)
+        return false;
+
+    // `if (e < x) x = e` keeps the minimum, as does `if (x > e) x = e`.
+    bool less = condition->op[0] == '<';
+    Expression *candidate;
+    if (isVariableNamed(condition->right.get(), target->name))
+        candidate = condition->left.get();
+    else if (isVariableNamed(condition->left.get(), target->name))
+    {
+        candidate = condition->right.get();
+        less = !less;
+    }
+    else
+        return false;
+
+    if (mentions(candidate, target->name) || !sameExpression(candidate, assignment->right.get()))
+        return false;
+
+    update(target->name, less ? "min" : "max");
+    visitExpression(candidate);
+    return true;
+}
+
+vector<Reduction> ReductionAnalysis::reductions() const
+{
+    vector<Reduction> result;
+    for (auto &entry : updates)
+    {
+        if (!conflicts.count(entry.first) && !reads.count(entry.first))
+            result.push_back({entry.first, entry.second});
+    }
+    return result;
+}
+
+set<string> ReductionAnalysis::sharedWrites() const
+{
+    set<string> result = conflicts;
+    for (auto &entry : updates)
+    {
+        if (reads.count(entry.first))
+            result.insert(entry.first);
+    }
+    return result;
+}
@@ -0,0 +1,55 @@
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include <map>
+#include <set>
+#include "ast.h"
+
+using namespace std;
+
+struct Reduction
+{
+    string variable;
+    string op;
+};
+
+// Classifies how a counted loop uses the variables declared outside of it. A variable that the body
+// only updates as `x = x + e`, `x = x - e`, `x = x * e`, `if (e < x) x = e` or `if (e > x) x = e`
+// is a reduction with op "+", "*", "min" or "max"; iterations can accumulate it privately.
+class ReductionAnalysis
+{
+private:
+    string induction;
+    vector<set<string>> locals;
+    map<string, string> updates;
+    set<string> reads;
+    set<string> conflicts;
+    bool sideEffects;
+    bool nestedLoops;
+
+    int scopeOf(const string &name) const;
+    void update(const string &name, const string &op);
+    void visitStatement(Statement *stmt);
+    void visitScoped(Statement *stmt);
+    void visitExpression(Expression *expr);
+    void visitAssignment(Expression *target, Expression *value);
+    bool visitMinMax(IfStatement *node);
+
+public:
+    explicit ReductionAnalysis(ForStatement *loop);
+
+    vector<Reduction> reductions() const;
+    // Outer variables the body writes in some other way than as a reduction.
+    set<string> sharedWrites() const;
+    bool hasSideEffects() const { return sideEffects; }
+    bool hasNestedLoops() const { return nestedLoops; }
+};
+
+// True for `for (int i = start; i < end; i = i + 1)` with an int `end`.
+bool isCanonicalLoop(ForStatement *loop);
+
+// True for canonical loops without calls or inner loops whose body leaves `i` alone and only indexes arrays
+// with `i`, so that no iteration reads memory another one writes.
+bool hasIndependentIterations(ForStatement *loop);
+
+#endif
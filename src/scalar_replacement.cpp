@@ -0,0 +1,189 @@
+#include "scalar_replacement.h"
+#include <algorithm>
+#include <map>
+#include "alias_analysis.h"
+#include "constant_folding.h"
+
+using namespace std;
+
+bool ScalarReplacement::isOnlyWriter(Loop *loop, Instruction *base, const vector<OffsetAccess> &accesses)
+{
+    Instruction *load = nullptr;
+    for (auto &access : accesses)
+    {
+        if (!access.isStore)
+            load = access.instr;
+    }
+    if (!load)
+        return false;
+
+    for (auto block : loop->blocks)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (instr->op == Opcode::STORE)
+            {
+                bool known = find_if(accesses.begin(), accesses.end(), [&](const OffsetAccess &access)
+                                     { return access.instr == instr.get(); }) != accesses.end();
+                if (!known && aliasArrays(instr->operands[0], base) != AliasResult::NO_ALIAS)
+                    return false;
+            }
+            else if ((instr->op == Opcode::CALL || instr->op == Opcode::AWAIT) && mayClobber(instr.get(), load, *purity))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool ScalarReplacement::replaceLoads(Loop *loop, const InductionAnalysis &analysis,
+                                     const InductionVariable *variable, const vector<OffsetAccess> &accesses)
+{
+    BasicBlock *preheader = loop->preheader();
+    BasicBlock *latch = loop->latches[0];
+    IRFunction &function = *preheader->parent;
+    TripCount trip = analysis.tripCount();
+    bool executes = trip.known && trip.count > 0;
+
+    map<Instruction *, Instruction *> replaced;
+    auto resolve = [&](Instruction *value)
+    {
+        auto it = replaced.find(value);
+        return it == replaced.end() ? value : it->second;
+    };
+
+    bool changed = false;
+    for (size_t i = 0; i < accesses.size(); ++i)
+    {
+        if (accesses[i].isStore)
+            continue;
+
+        Instruction *load = accesses[i].instr;
+        int offset = accesses[i].offset;
+        int source = offset + variable->step;
+        if (load->checked && !executes)
+            continue;
+
+        bool blocked = false;
+        Instruction *value = nullptr;
+        for (size_t j = 0; j < accesses.size(); ++j)
+        {
+            if (accesses[j].isStore && accesses[j].offset == offset && j < i)
+                blocked = true;
+            if (accesses[j].isStore && accesses[j].offset == source)
+                value = accesses[j].instr->operands[2];
+        }
+        for (size_t j = 0; j < accesses.size() && !value; ++j)
+        {
+            if (!accesses[j].isStore && accesses[j].offset == source)
+                value = resolve(accesses[j].instr);
+        }
+        if (blocked || !value)
+            continue;
+
+        Instruction *base = load->operands[0];
+        Instruction *index = foldConstant(function, Opcode::ADD, IntType, {variable->start, function.constInt(offset)});
+        if (!index)
+            index = offset == 0 ? variable->start
+                                : preheader->insertBefore(preheader->terminator(), Opcode::ADD, IntType,
+                                                          {variable->start, function.constInt(offset)});
+
+        auto arrayType = static_pointer_cast<ArrayType>(base->type);
+        Instruction *initial = preheader->insertBefore(preheader->terminator(), Opcode::LOAD, load->type, {base, index});
+        initial->speculative = !executes && !(index->isConstant() && index->intValue >= 0 &&
+                                              index->intValue < arrayType->size);
+        initial->checked = load->checked;
+
+        Instruction *phi = loop->header->addPhi(load->type);
+        phi->addIncoming(initial, preheader);
+        phi->addIncoming(value, latch);
+
+        load->replaceAllUsesWith(phi);
+        load->parent->erase(load);
+        replaced[load] = phi;
+        changed = true;
+    }
+    return changed;
+}
+
+bool ScalarReplacement::runOnLoop(Loop *loop, const DominatorTree &dominators)
+{
+    vector<BasicBlock *> exiting = loop->exitingBlocks();
+    if (!loop->preheader() || loop->latches.size() != 1 || exiting.size() != 1 || exiting[0] != loop->header)
+        return false;
+
+    InductionAnalysis analysis(loop);
+    if (analysis.inductionVariables().empty())
+        return false;
+
+    bool changed = false;
+    for (auto block : loop->blocks)
+    {
+        if (!dominators.dominates(block, loop->latches[0]))
+            continue;
+
+        vector<Instruction *> bases;
+        map<Instruction *, vector<OffsetAccess>> groups;
+        map<Instruction *, const InductionVariable *> variables;
+        set<Instruction *> rejected;
+
+        for (auto &instr : block->instructions)
+        {
+            if (instr->op != Opcode::LOAD && instr->op != Opcode::STORE)
+                continue;
+
+            Instruction *base = instr->operands[0];
+            bool isStore = instr->op == Opcode::STORE;
+            int offset;
+            const InductionVariable *variable = analysis.affineOffset(instr->operands[1], offset);
+            if (!variable || (variables.count(base) && variables[base] != variable))
+            {
+                if (isStore)
+                    rejected.insert(base);
+                continue;
+            }
+
+            if (!groups.count(base))
+                bases.push_back(base);
+            variables[base] = variable;
+            groups[base].push_back({instr.get(), offset, isStore});
+        }
+
+        for (auto base : bases)
+        {
+            if (rejected.count(base) || !loop->isInvariant(base) || !isOnlyWriter(loop, base, groups[base]))
+                continue;
+            changed = replaceLoads(loop, analysis, variables[base], groups[base]) || changed;
+        }
+    }
+    return changed;
+}
+
+bool ScalarReplacement::runOnFunction(IRFunction &function)
+{
+    bool changed = insertPreheaders(function);
+
+    DominatorTree dominators(function);
+    LoopInfo loops(dominators);
+    for (auto loop : loops.innermostFirst())
+    {
+        changed = runOnLoop(loop, dominators) || changed;
+    }
+    return changed;
+}
+
+bool ScalarReplacement::runOnModule(IRModule &module)
+{
+    PurityAnalysis analysis(module);
+    purity = &analysis;
+
+    bool changed = false;
+    for (auto &function : module.functions)
+    {
+        changed = runOnFunction(*function) || changed;
+    }
+
+    purity = nullptr;
+    return changed;
+}
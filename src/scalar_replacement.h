@@ -0,0 +1,35 @@
+#ifndef SCALAR_REPLACEMENT_H
+#define SCALAR_REPLACEMENT_H
+
+#include "induction.h"
+#include "pass_manager.h"
+#include "purity.h"
+
+using namespace std;
+
+struct OffsetAccess
+{
+    Instruction *instr;
+    int offset;
+    bool isStore;
+};
+
+class ScalarReplacement : public Pass
+{
+private:
+    PurityAnalysis *purity;
+
+    bool isOnlyWriter(Loop *loop, Instruction *base, const vector<OffsetAccess> &accesses);
+    bool replaceLoads(Loop *loop, const InductionAnalysis &analysis, const InductionVariable *variable,
+                      const vector<OffsetAccess> &accesses);
+    bool runOnLoop(Loop *loop, const DominatorTree &dominators);
+    bool runOnFunction(IRFunction &function);
+
+public:
+    ScalarReplacement() : purity(nullptr) {}
+
+    string name() const override { return "scalar-replace"; }
+    bool runOnModule(IRModule &module) override;
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include "sccp.h"
+#include "constant_folding.h"
+#include "simplify_cfg.h"
+
+using namespace std;
+
+LatticeValue SCCP::valueOf(Instruction *instr)
+{
+    if (instr->isConstant())
+        return {LatticeKind::CONSTANT, instr};
+    if (!instr->parent)
+        return {LatticeKind::OVERDEFINED, nullptr};
+    return values[instr];
+}
+
+void SCCP::update(Instruction *instr, LatticeValue value)
+{
+    LatticeValue &old = values[instr];
+    if (old.kind == value.kind && old.constant == value.constant)
+        return;
+    if (old.kind == LatticeKind::OVERDEFINED)
+        return;
+
+    old = value;
+    for (auto user : instr->users)
+    {
+        valueWorklist.push_back(user);
+    }
+}
+
+void SCCP::markEdge(BasicBlock *from, BasicBlock *to)
+{
+    if (!executableEdges.insert({from, to}).second)
+        return;
+    edgeWorklist.push_back({from, to});
+}
+
+void SCCP::visitPhi(Instruction *phi)
+{
+    LatticeValue result;
+    for (size_t i = 0; i < phi->operands.size(); ++i)
+    {
+        if (!executableEdges.count({phi->blocks[i], phi->parent}))
+            continue;
+
+        LatticeValue incoming = valueOf(phi->operands[i]);
+        if (incoming.kind == LatticeKind::UNDEFINED)
+            continue;
+        if (incoming.kind == LatticeKind::OVERDEFINED ||
+            (result.kind == LatticeKind::CONSTANT && result.constant != incoming.constant))
+        {
+            result = {LatticeKind::OVERDEFINED, nullptr};
+            break;
+        }
+        result = incoming;
+    }
+    update(phi, result);
+}
+
+void SCCP::visitBranch(Instruction *term)
+{
+    if (term->op == Opcode::BR)
+    {
+        markEdge(term->parent, term->blocks[0]);
+        return;
+    }
+
+    LatticeValue cond = valueOf(term->operands[0]);
+    if (cond.kind == LatticeKind::CONSTANT)
+    {
+        markEdge(term->parent, cond.constant->intValue ? term->blocks[0] : term->blocks[1]);
+    }
+    else if (cond.kind == LatticeKind::OVERDEFINED)
+    {
+        markEdge(term->parent, term->blocks[0]);
+        markEdge(term->parent, term->blocks[1]);
+    }
+}
+
+void SCCP::visit(Instruction *instr)
+{
+    if (!executableBlocks.count(instr->parent))
+        return;
+
+    switch (instr->op)
+    {
+    case Opcode::PHI:
+        visitPhi(instr);
+        return;
+    case Opcode::BR:
+    case Opcode::CONDBR:
+        visitBranch(instr);
+        return;
+    case Opcode::NEG:
+    case Opcode::NOT:
+    case Opcode::ITOF:
+        break;
+    default:
+        if (!instr->isBinary())
+        {
+            if (instr->type->kind != TypeKind::VOID)
+                update(instr, {LatticeKind::OVERDEFINED, nullptr});
+            return;
+        }
+    }
+
+    vector<Instruction *> constants;
+    for (auto operand : instr->operands)
+    {
+        LatticeValue value = valueOf(operand);
+        if (value.kind == LatticeKind::UNDEFINED)
+            return;
+        if (value.kind == LatticeKind::OVERDEFINED)
+        {
+            update(instr, {LatticeKind::OVERDEFINED, nullptr});
+            return;
+        }
+        constants.push_back(value.constant);
+    }
+
+    Instruction *folded = foldConstant(*function, instr->op, instr->type, constants);
+    if (folded)
+        update(instr, {LatticeKind::CONSTANT, folded});
+    else
+        update(instr, {LatticeKind::OVERDEFINED, nullptr});
+}
+
+bool SCCP::rewrite()
+{
+    bool changed = false;
+
+    for (auto &block : function->blocks)
+    {
+        if (!executableBlocks.count(block.get()))
+            continue;
+
+        vector<Instruction *> instrs;
+        for (auto &instr : block->instructions)
+        {
+            instrs.push_back(instr.get());
+        }
+
+        for (auto instr : instrs)
+        {
+            if (instr->op == Opcode::CONDBR)
+            {
+                BasicBlock *ifTrue = instr->blocks[0];
+                BasicBlock *ifFalse = instr->blocks[1];
+                bool trueLive = executableEdges.count({block.get(), ifTrue}) > 0;
+                bool falseLive = executableEdges.count({block.get(), ifFalse}) > 0;
+                if (trueLive != falseLive)
+                {
+                    replaceWithBranch(block.get(), trueLive ? ifTrue : ifFalse);
+                    changed = true;
+                }
+                continue;
+            }
+
+            auto it = values.find(instr);
+            if (it == values.end() || it->second.kind != LatticeKind::CONSTANT)
+                continue;
+
+            instr->replaceAllUsesWith(it->second.constant);
+            if (!instr->hasSideEffects())
+            {
+                block->erase(instr);
+            }
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        removeUnreachableBlocks(*function);
+        removeTrivialPhis(*function);
+    }
+    return changed;
+}
+
+bool SCCP::runOnFunction(IRFunction &target)
+{
+    function = &target;
+    values.clear();
+    executableEdges.clear();
+    executableBlocks.clear();
+    edgeWorklist.clear();
+    valueWorklist.clear();
+
+    function->recomputePredecessors();
+    edgeWorklist.push_back({nullptr, function->entry()});
+
+    while (!edgeWorklist.empty() || !valueWorklist.empty())
+    {
+        while (!valueWorklist.empty())
+        {
+            Instruction *instr = valueWorklist.front();
+            valueWorklist.pop_front();
+            if (instr->parent)
+                visit(instr);
+        }
+
+        while (!edgeWorklist.empty())
+        {
+            auto edge = edgeWorklist.front();
+            edgeWorklist.pop_front();
+            BasicBlock *target = edge.second;
+
+            if (!executableBlocks.insert(target).second)
+            {
+                for (auto phi : target->phis())
+                {
+                    visitPhi(phi);
+                }
+                continue;
+            }
+
+            for (auto &instr : target->instructions)
+            {
+                visit(instr.get());
+            }
+        }
+    }
+
+    return rewrite();
+}
@@ -0,0 +1,48 @@
+#ifndef SCCP_H
+#define SCCP_H
+
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include "pass_manager.h"
+
+using namespace std;
+
+enum class LatticeKind
+{
+    UNDEFINED,
+    CONSTANT,
+    OVERDEFINED
+};
+
+struct LatticeValue
+{
+    LatticeKind kind = LatticeKind::UNDEFINED;
+    Instruction *constant = nullptr;
+};
+
+class SCCP : public FunctionPass
+{
+private:
+    IRFunction *function;
+    unordered_map<Instruction *, LatticeValue> values;
+    set<pair<BasicBlock *, BasicBlock *>> executableEdges;
+    unordered_set<BasicBlock *> executableBlocks;
+    deque<pair<BasicBlock *, BasicBlock *>> edgeWorklist;
+    deque<Instruction *> valueWorklist;
+
+    LatticeValue valueOf(Instruction *instr);
+    void update(Instruction *instr, LatticeValue value);
+    void markEdge(BasicBlock *from, BasicBlock *to);
+    void visit(Instruction *instr);
+    void visitPhi(Instruction *phi);
+    void visitBranch(Instruction *term);
+    bool rewrite();
+
+public:
+    string name() const override { return "sccp"; }
+    bool runOnFunction(IRFunction &function) override;
+};
+
+#endif
@@ -1,9 +1,16 @@
 #include "semantic.h"
+#include "atomic_runtime.h"
+#include "channel_runtime.h"
 #include "error.h"
+#include "input_runtime.h"
+#include "map_runtime.h"
+#include "reduction.h"
+#include "vector_runtime.h"
 
 using namespace std;
 
-SemanticAnalyzer::SemanticAnalyzer() : currentFunctionReturnType(nullptr) {}
+SemanticAnalyzer::SemanticAnalyzer(bool fastMath)
+    : currentFunctionReturnType(nullptr), fastMath(fastMath), globalScope(symbolTable.current()) {}
 
 void SemanticAnalyzer::analyze(shared_ptr<Program> program)
 {
@@ -36,6 +43,11 @@ shared_ptr<Type> SemanticAnalyzer::checkBinaryOp(const string &op,
 {
     if (op == "=")
     {
+        if (left->kind == TypeKind::ATOMIC)
+        {
+            errorReporter.reportError("Atomic variables can only be changed with atomic operations");
+            return ErrorType;
+        }
         if (!isAssignable(left, right))
         {
             errorReporter.reportError("Type mismatch in assignment");
@@ -44,6 +56,11 @@ shared_ptr<Type> SemanticAnalyzer::checkBinaryOp(const string &op,
         return left;
     }
 
+    if (left->kind == TypeKind::VECTOR || right->kind == TypeKind::VECTOR)
+    {
+        return checkVectorOp(op, left, right);
+    }
+
     if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%")
     {
         if (!isNumericType(left) || !isNumericType(right))
@@ -61,6 +78,21 @@ shared_ptr<Type> SemanticAnalyzer::checkBinaryOp(const string &op,
 
     if (op == "==" || op == "!=" || op == "<" || op == "<=" || op == ">" || op == ">=")
     {
+        if (left->kind == TypeKind::TASK || right->kind == TypeKind::TASK)
+        {
+            errorReporter.reportError("Tasks cannot be compared");
+            return ErrorType;
+        }
+        if (left->kind == TypeKind::CHANNEL || right->kind == TypeKind::CHANNEL)
+        {
+            errorReporter.reportError("Channels cannot be compared");
+            return ErrorType;
+        }
+        if (left->kind == TypeKind::ATOMIC || right->kind == TypeKind::ATOMIC)
+        {
+            errorReporter.reportError("Atomics cannot be compared; use 'atomic_load' to read them");
+            return ErrorType;
+        }
         if (!isNumericType(left) || !isNumericType(right))
         {
             if (!left->equals(right.get()))
@@ -86,11 +118,43 @@ shared_ptr<Type> SemanticAnalyzer::checkBinaryOp(const string &op,
     return ErrorType;
 }
 
+// Vector operands are combined lane by lane; a scalar operand stands for a vector with it in every lane.
+shared_ptr<Type> SemanticAnalyzer::checkVectorOp(const string &op, shared_ptr<Type> left, shared_ptr<Type> right)
+{
+    auto vector = static_pointer_cast<VectorType>(left->kind == TypeKind::VECTOR ? left : right);
+    auto other = left->kind == TypeKind::VECTOR ? right : left;
+    if (op == "&&" || op == "||")
+    {
+        errorReporter.reportError("Boolean operands required for " + op);
+        return ErrorType;
+    }
+    if (!vector->equals(other.get()) && !isAssignable(vector->elementType, other))
+    {
+        errorReporter.reportError("Operands of " + op + " must be " + vector->toString() + " or " +
+                                  vector->elementType->toString());
+        return ErrorType;
+    }
+    if (op == "%" && vector->elementType->kind != TypeKind::INT)
+    {
+        errorReporter.reportError("Operator % requires int vectors");
+        return ErrorType;
+    }
+    if (op == "==" || op == "!=" || op == "<" || op == "<=" || op == ">" || op == ">=")
+    {
+        return vector->maskType();
+    }
+    return vector;
+}
+
 shared_ptr<Type> SemanticAnalyzer::checkUnaryOp(const string &op,
                                                      shared_ptr<Type> operand)
 {
     if (op == "-")
     {
+        if (operand->kind == TypeKind::VECTOR)
+        {
+            return operand;
+        }
         if (!isNumericType(operand))
         {
             errorReporter.reportError("Numeric operand required for unary -");
@@ -121,6 +185,118 @@ void SemanticAnalyzer::visitProgram(Program *node)
     }
 }
 
+bool SemanticAnalyzer::isScalarType(shared_ptr<Type> type)
+{
+    return type->kind == TypeKind::INT || type->kind == TypeKind::FLOAT || type->kind == TypeKind::BOOL;
+}
+
+void SemanticAnalyzer::checkFunctionAnnotations(Function *node)
+{
+    for (const auto &annotation : node->annotations)
+    {
+        if (annotation.name != "memo")
+        {
+            errorReporter.reportError("Unknown annotation '@" + annotation.name + "' on function '" + node->name + "'",
+                                      annotation.line, annotation.column);
+            continue;
+        }
+
+        if (!annotation.args.empty())
+        {
+            errorReporter.reportError("'@memo' takes no arguments", annotation.line, annotation.column);
+        }
+
+        bool scalar = isScalarType(node->returnType);
+        for (const auto &param : node->parameters)
+        {
+            scalar = scalar && isScalarType(param.type);
+        }
+        if (!scalar)
+        {
+            errorReporter.reportError("'@memo' function '" + node->name + "' must take and return int, float or bool values",
+                                      annotation.line, annotation.column);
+        }
+    }
+}
+
+void SemanticAnalyzer::checkLoopAnnotations(ForStatement *node)
+{
+    for (const auto &annotation : node->annotations)
+    {
+        if (annotation.name != "unroll")
+        {
+            errorReporter.reportError("Unknown annotation '@" + annotation.name + "' on 'for' loop",
+                                      annotation.line, annotation.column);
+            continue;
+        }
+
+        if (annotation.args.size() != 1 || annotation.args[0] < 1 || annotation.args[0] > 64)
+        {
+            errorReporter.reportError("'@unroll' takes one factor between 1 and 64", annotation.line, annotation.column);
+        }
+    }
+}
+
+void SemanticAnalyzer::checkParallelLoop(ForStatement *node)
+{
+    if (parallelScope)
+    {
+        errorReporter.reportError("Nested 'parallel for' is not supported");
+        return;
+    }
+
+    if (!isCanonicalLoop(node))
+    {
+        errorReporter.reportError("'parallel for' must have the form 'for (int i = start; i < end; i = i + 1)'");
+        return;
+    }
+
+    vector<Reduction> reductions = ReductionAnalysis(node).reductions();
+    if (reductions.size() > 1)
+    {
+        errorReporter.reportError("'parallel for' supports at most one reduction variable");
+        return;
+    }
+
+    for (auto &reduction : reductions)
+    {
+        auto symbol = symbolTable.resolve(reduction.variable);
+        if (!symbol || !isNumericType(symbol->type))
+            continue;
+        if (symbol->type->kind == TypeKind::FLOAT && !fastMath)
+        {
+            errorReporter.reportError("Floating-point reduction of '" + reduction.variable +
+                                      "' in 'parallel for' requires --fast-math");
+        }
+        parallelReduction = reduction.variable;
+    }
+}
+
+// Global variables assigned by each function, directly or through the functions it calls.
+void SemanticAnalyzer::recordGlobalWrite(Expression *target)
+{
+    auto variable = dynamic_cast<Variable *>(target);
+    if (!variable || currentFunction.empty())
+        return;
+    auto global = globalScope->symbols.find(variable->name);
+    if (global != globalScope->symbols.end() && global->second == symbolTable.resolve(variable->name))
+        globalWrites[currentFunction].insert(variable->name);
+}
+
+// Runs once the current function is complete, so that a recursive call sees all of its writes.
+void SemanticAnalyzer::checkParallelCallees()
+{
+    for (auto &callee : parallelCallees)
+    {
+        for (auto &name : globalWrites[callee])
+        {
+            errorReporter.reportError("Function '" + callee + "' assigns global variable '" + name +
+                                      "' and cannot be called in the body of 'parallel for'");
+        }
+    }
+    parallelCallees.clear();
+}
+
 void SemanticAnalyzer::visitFunction(Function *node)
 {
     if (symbolTable.isDefinedInCurrentScope(node->name))
@@ -137,19 +313,34 @@ void SemanticAnalyzer::visitFunction(Function *node)
 
     auto funcType = make_shared<FunctionType>(node->returnType, paramTypes);
     symbolTable.define(node->name, funcType, true);
+    functions[node->name] = node;
+
+    if (node->returnType->kind == TypeKind::ATOMIC)
+    {
+        errorReporter.reportError("Function '" + node->name + "' cannot return an atomic");
+    }
+
+    checkFunctionAnnotations(node);
 
     symbolTable.enterScope();
 
     currentFunctionReturnType = node->returnType;
+    currentFunction = node->name;
 
     for (const auto &param : node->parameters)
     {
+        if (param.noalias && param.type->kind != TypeKind::ARRAY)
+        {
+            errorReporter.reportError("'noalias' only applies to array parameters, not '" + param.name + "'");
+        }
         symbolTable.define(param.name, param.type);
     }
 
     node->body->accept(this);
+    checkParallelCallees();
 
     currentFunctionReturnType = nullptr;
+    currentFunction.clear();
 
     symbolTable.exitScope();
 }
@@ -162,11 +353,23 @@ void SemanticAnalyzer::visitVarDeclaration(VarDeclaration *node)
         return;
     }
 
+    auto map = dynamic_cast<FunctionCall *>(node->initializer.get());
+    if (map && isMapBuiltin(map->name) && !symbolTable.resolve(map->name))
+    {
+        checkMapBuiltin(map, node);
+        symbolTable.define(node->name, node->type);
+        if (map->name == "map_file")
+            readOnlyArrays.insert(symbolTable.resolve(node->name));
+        return;
+    }
+
     if (node->initializer)
     {
         node->initializer->accept(this);
 
-        if (!isAssignable(node->type, node->initializer->type))
+        auto type = node->type->kind == TypeKind::ATOMIC ? static_pointer_cast<AtomicType>(node->type)->valueType
+                                                          : node->type;
+        if (!isAssignable(type, node->initializer->type))
         {
             errorReporter.reportError("Type mismatch in variable initialization");
         }
@@ -180,7 +383,15 @@ void SemanticAnalyzer::visitAssignment(Assignment *node)
     node->target->accept(this);
     node->value->accept(this);
 
-    if (!isAssignable(node->target->type, node->value->type))
+    checkLaneAssignment(node->target.get());
+    recordGlobalWrite(node->target.get());
+    if (auto access = dynamic_cast<ArrayAccess *>(node->target.get()))
+        checkWritableArray(access->array.get());
+    if (node->target->type->kind == TypeKind::ATOMIC)
+    {
+        errorReporter.reportError("Atomic variables can only be changed with atomic operations");
+    }
+    else if (!isAssignable(node->target->type, node->value->type))
     {
         errorReporter.reportError("Type mismatch in assignment");
     }
@@ -229,6 +440,7 @@ void SemanticAnalyzer::visitWhileStatement(WhileStatement *node)
 
 void SemanticAnalyzer::visitForStatement(ForStatement *node)
 {
+    checkLoopAnnotations(node);
     symbolTable.enterScope();
 
     if (node->init)
@@ -251,7 +463,24 @@ void SemanticAnalyzer::visitForStatement(ForStatement *node)
         node->update->accept(this);
     }
 
-    node->body->accept(this);
+    if (node->parallel)
+    {
+        checkParallelLoop(node);
+    }
+
+    if (node->parallel && !parallelScope)
+    {
+        symbolTable.enterScope();
+        parallelScope = symbolTable.current();
+        node->body->accept(this);
+        parallelScope = nullptr;
+        parallelReduction.clear();
+        symbolTable.exitScope();
+    }
+    else
+    {
+        node->body->accept(this);
+    }
 
     symbolTable.exitScope();
 }
@@ -264,6 +493,11 @@ void SemanticAnalyzer::visitReturnStatement(ReturnStatement *node)
         return;
     }
 
+    if (parallelScope)
+    {
+        errorReporter.reportError("Return statement inside 'parallel for'");
+    }
+
     if (node->value)
     {
         node->value->accept(this);
@@ -285,6 +519,23 @@ void SemanticAnalyzer::visitReturnStatement(ReturnStatement *node)
 void SemanticAnalyzer::visitPrintStatement(PrintStatement *node)
 {
     node->expr->accept(this);
+
+    if (node->expr->type->kind == TypeKind::TASK)
+    {
+        errorReporter.reportError("Cannot print a task; use 'await' to get its result");
+    }
+    else if (node->expr->type->kind == TypeKind::CHANNEL)
+    {
+        errorReporter.reportError("Cannot print a channel; use 'receive' to get its values");
+    }
+    else if (node->expr->type->kind == TypeKind::ATOMIC)
+    {
+        errorReporter.reportError("Cannot print an atomic; use 'atomic_load' to read it");
+    }
+    else if (node->expr->type->kind == TypeKind::VECTOR)
+    {
+        errorReporter.reportError("Cannot print a vector; print its lanes or a reduction such as 'hsum'");
+    }
 }
 
 void SemanticAnalyzer::visitExpressionStatement(ExpressionStatement *node)
@@ -330,6 +581,16 @@ void SemanticAnalyzer::visitArrayAccess(ArrayAccess *node)
     node->array->accept(this);
     node->index->accept(this);
 
+    if (node->array->type->kind == TypeKind::VECTOR)
+    {
+        if (node->index->type->kind != TypeKind::INT)
+        {
+            errorReporter.reportError("Lane index must be integer");
+        }
+        node->type = static_pointer_cast<VectorType>(node->array->type)->elementType;
+        return;
+    }
+
     if (node->array->type->kind != TypeKind::ARRAY)
     {
         errorReporter.reportError("Array access on non-array type");
@@ -351,6 +612,21 @@ void SemanticAnalyzer::visitBinaryOp(BinaryOp *node)
     node->left->accept(this);
     node->right->accept(this);
 
+    auto target = dynamic_cast<Variable *>(node->left.get());
+    if (node->op == "=" && target && parallelScope && target->name != parallelReduction &&
+        !symbolTable.isDefinedWithin(target->name, parallelScope))
+    {
+        errorReporter.reportError("Variable '" + target->name + "' is shared across iterations of 'parallel for' "
+                                  "and cannot be assigned in its body");
+    }
+    if (node->op == "=")
+    {
+        checkLaneAssignment(node->left.get());
+        recordGlobalWrite(node->left.get());
+        if (auto access = dynamic_cast<ArrayAccess *>(node->left.get()))
+            checkWritableArray(access->array.get());
+    }
+
     node->type = checkBinaryOp(node->op, node->left->type, node->right->type);
 }
 
@@ -364,6 +640,31 @@ void SemanticAnalyzer::visitUnaryOp(UnaryOp *node)
 void SemanticAnalyzer::visitFunctionCall(FunctionCall *node)
 {
     auto symbol = symbolTable.resolve(node->name);
+    if (!symbol && isChannelBuiltin(node->name))
+    {
+        checkChannelBuiltin(node);
+        return;
+    }
+    if (!symbol && isAtomicBuiltin(node->name))
+    {
+        checkAtomicBuiltin(node);
+        return;
+    }
+    if (!symbol && isVectorBuiltin(node->name))
+    {
+        checkVectorBuiltin(node);
+        return;
+    }
+    if (!symbol && isInputBuiltin(node->name))
+    {
+        checkInputBuiltin(node);
+        return;
+    }
+    if (!symbol && isMapBuiltin(node->name))
+    {
+        checkMapBuiltin(node, nullptr);
+        return;
+    }
     if (!symbol)
     {
         errorReporter.reportError("Undefined function: " + node->name);
@@ -396,6 +697,409 @@ void SemanticAnalyzer::visitFunctionCall(FunctionCall *node)
             errorReporter.reportError("Argument type mismatch");
         }
     }
+    checkNoaliasArguments(node, functions[node->name]);
+    if (!currentFunction.empty() && node->name != currentFunction)
+    {
+        auto &callees = globalWrites[node->name];
+        globalWrites[currentFunction].insert(callees.begin(), callees.end());
+    }
+    if (parallelScope)
+        parallelCallees.insert(node->name);
 
     node->type = funcType->returnType;
-}
\ No newline at end of file
+}
+
+void SemanticAnalyzer::visitSpawnExpression(SpawnExpression *node)
+{
+    node->call->accept(this);
+
+    if (node->call->builtin)
+    {
+        errorReporter.reportError("Cannot spawn builtin '" + node->call->name + "'");
+        node->type = ErrorType;
+        return;
+    }
+    if (node->call->type->kind == TypeKind::VECTOR)
+    {
+        errorReporter.reportError("Tasks cannot return vectors");
+        node->type = ErrorType;
+        return;
+    }
+    if (node->call->type->kind == TypeKind::ERROR)
+    {
+        node->type = ErrorType;
+        return;
+    }
+    node->type = make_shared<TaskType>(node->call->type);
+}
+
+void SemanticAnalyzer::visitAwaitExpression(AwaitExpression *node)
+{
+    node->task->accept(this);
+
+    if (node->task->type->kind != TypeKind::TASK)
+    {
+        if (node->task->type->kind != TypeKind::ERROR)
+            errorReporter.reportError("'await' requires a task");
+        node->type = ErrorType;
+        return;
+    }
+
+    auto handle = dynamic_cast<Variable *>(node->task.get());
+    if (handle && parallelScope && !symbolTable.isDefinedWithin(handle->name, parallelScope))
+    {
+        errorReporter.reportError("Task '" + handle->name + "' is shared across iterations of 'parallel for' "
+                                  "and cannot be awaited in its body");
+    }
+    node->type = static_pointer_cast<TaskType>(node->task->type)->resultType;
+}
+
+void SemanticAnalyzer::checkChannelBuiltin(FunctionCall *node)
+{
+    node->builtin = true;
+    node->type = ErrorType;
+    for (auto &arg : node->args)
+    {
+        arg->accept(this);
+    }
+
+    const string &name = node->name;
+    size_t arity = name == "receive" || name == "close" ? 1 : name == "send" || name == "try_send" ? 2 : 3;
+    if (node->args.size() != arity)
+    {
+        errorReporter.reportError("'" + name + "' expects " + to_string(arity) + " argument" +
+                                  (arity > 1 ? "s" : ""));
+        return;
+    }
+
+    auto channel = node->args[0]->type;
+    if (channel->kind != TypeKind::CHANNEL)
+    {
+        if (channel->kind != TypeKind::ERROR)
+            errorReporter.reportError("'" + name + "' requires a channel");
+        return;
+    }
+
+    auto element = static_pointer_cast<ChannelType>(channel)->elementType;
+    if (arity == 2 && !isAssignable(element, node->args[1]->type))
+    {
+        errorReporter.reportError("Cannot send " + node->args[1]->type->toString() + " on " + channel->toString());
+        return;
+    }
+    if (arity == 3)
+    {
+        auto buffer = node->args[1]->type;
+        if (buffer->kind != TypeKind::ARRAY ||
+            !static_pointer_cast<ArrayType>(buffer)->elementType->equals(element.get()))
+        {
+            errorReporter.reportError("'" + name + "' requires an array of " + element->toString());
+            return;
+        }
+        if (name == "receive_batch")
+            checkWritableArray(node->args[1].get());
+        if (node->args[2]->type->kind != TypeKind::INT)
+        {
+            errorReporter.reportError("Batch size must be an integer");
+            return;
+        }
+    }
+
+    if (name == "receive")
+        node->type = element;
+    else if (name == "try_send")
+        node->type = BoolType;
+    else if (name == "try_receive" || name == "receive_batch")
+        node->type = IntType;
+    else
+        node->type = VoidType;
+}
+
+void SemanticAnalyzer::checkAtomicBuiltin(FunctionCall *node)
+{
+    node->builtin = true;
+    node->type = ErrorType;
+
+    const string &name = node->name;
+    size_t arity = name == "atomic_load" ? 1 : name == "compare_exchange" ? 3 : 2;
+    if (node->args.size() == arity + 1)
+    {
+        auto order = dynamic_cast<Variable *>(node->args.back().get());
+        if (!order || !isMemoryOrder(order->name) || symbolTable.resolve(order->name))
+        {
+            errorReporter.reportError("The last argument of '" + name +
+                                      "' must be a memory order: relaxed, acquire, release, acq_rel or seq_cst");
+            return;
+        }
+        node->memoryOrder = order->name;
+        node->args.pop_back();
+    }
+
+    for (auto &arg : node->args)
+    {
+        arg->accept(this);
+    }
+    if (node->args.size() != arity)
+    {
+        errorReporter.reportError("'" + name + "' expects " + to_string(arity) +
+                                  " arguments and an optional memory order");
+        return;
+    }
+
+    if (node->args[0]->type->kind != TypeKind::ATOMIC)
+    {
+        if (node->args[0]->type->kind != TypeKind::ERROR)
+            errorReporter.reportError("'" + name + "' requires an atomic int");
+        return;
+    }
+    for (size_t i = 1; i < node->args.size(); ++i)
+    {
+        if (node->args[i]->type->kind != TypeKind::INT)
+        {
+            errorReporter.reportError("'" + name + "' requires int values");
+            return;
+        }
+    }
+
+    const string &order = node->memoryOrder;
+    if ((name == "atomic_load" && (order == "release" || order == "acq_rel")) ||
+        (name == "atomic_store" && (order == "acquire" || order == "acq_rel")))
+    {
+        errorReporter.reportError("Memory order '" + order + "' is not valid for '" + name + "'");
+        return;
+    }
+
+    if (name == "atomic_store")
+        node->type = VoidType;
+    else if (name == "compare_exchange")
+        node->type = BoolType;
+    else
+        node->type = IntType;
+}
+
+void SemanticAnalyzer::visitChannelExpression(ChannelExpression *node)
+{
+    node->capacity->accept(this);
+
+    if (node->capacity->type->kind != TypeKind::INT && node->capacity->type->kind != TypeKind::ERROR)
+    {
+        errorReporter.reportError("Channel capacity must be an integer");
+    }
+}
+
+void SemanticAnalyzer::checkLaneAssignment(Expression *target)
+{
+    auto access = dynamic_cast<ArrayAccess *>(target);
+    if (access && access->array->type->kind == TypeKind::VECTOR)
+    {
+        errorReporter.reportError("Vector lanes cannot be assigned; build a new vector instead");
+    }
+}
+
+void SemanticAnalyzer::checkInputBuiltin(FunctionCall *node)
+{
+    node->builtin = true;
+    node->type = ErrorType;
+    for (auto &arg : node->args)
+    {
+        arg->accept(this);
+    }
+
+    const string &name = node->name;
+    if (name != "read_ints")
+    {
+        if (!node->args.empty())
+            errorReporter.reportError("'" + name + "' expects no arguments");
+        else
+            node->type = name == "read_int" ? IntType : name == "read_float" ? FloatType : StringType;
+        return;
+    }
+
+    if (node->args.size() != 2)
+    {
+        errorReporter.reportError("'read_ints' expects 2 arguments");
+        return;
+    }
+    auto array = node->args[0]->type;
+    if (array->kind != TypeKind::ARRAY || !static_pointer_cast<ArrayType>(array)->elementType->equals(IntType.get()))
+    {
+        if (array->kind != TypeKind::ERROR)
+            errorReporter.reportError("'read_ints' requires an array of int");
+        return;
+    }
+    checkWritableArray(node->args[0].get());
+    if (node->args[1]->type->kind != TypeKind::INT)
+    {
+        if (node->args[1]->type->kind != TypeKind::ERROR)
+            errorReporter.reportError("Count must be an integer");
+        return;
+    }
+    node->type = IntType;
+}
+
+void SemanticAnalyzer::checkMapBuiltin(FunctionCall *node, VarDeclaration *declaration)
+{
+    node->builtin = true;
+    node->type = ErrorType;
+    for (auto &arg : node->args)
+    {
+        arg->accept(this);
+    }
+
+    const string &name = node->name;
+    if (!declaration || !currentFunctionReturnType)
+    {
+        errorReporter.reportError("'" + name + "' can only initialize a local array");
+        return;
+    }
+    auto array = declaration->type;
+    auto element = array->kind == TypeKind::ARRAY ? static_pointer_cast<ArrayType>(array)->elementType : nullptr;
+    if (!element || (element->kind != TypeKind::INT && element->kind != TypeKind::FLOAT))
+    {
+        errorReporter.reportError("'" + name + "' maps arrays of int or float, not " + array->toString());
+        return;
+    }
+    if (node->args.empty() || node->args.size() > 2)
+    {
+        errorReporter.reportError("'" + name + "' expects a file path and an optional byte offset");
+        return;
+    }
+    if (node->args[0]->type->kind != TypeKind::STRING)
+    {
+        if (node->args[0]->type->kind != TypeKind::ERROR)
+            errorReporter.reportError("File path must be a string");
+        return;
+    }
+    if (node->args.size() == 2 && node->args[1]->type->kind != TypeKind::INT)
+    {
+        if (node->args[1]->type->kind != TypeKind::ERROR)
+            errorReporter.reportError("File offset must be an integer");
+        return;
+    }
+    node->type = array;
+}
+
+// Stores into an array mapped with map_file would fault, so they are rejected where the array is named.
+void SemanticAnalyzer::checkWritableArray(Expression *array)
+{
+    auto variable = dynamic_cast<Variable *>(array);
+    if (variable && readOnlyArrays.count(symbolTable.resolve(variable->name)))
+    {
+        errorReporter.reportError("Array '" + variable->name + "' is mapped read-only; use 'map_file_cow' to "
+                                  "change it");
+    }
+}
+
+void SemanticAnalyzer::checkVectorBuiltin(FunctionCall *node)
+{
+    node->builtin = true;
+    node->type = ErrorType;
+    for (auto &arg : node->args)
+    {
+        arg->accept(this);
+    }
+
+    const string &name = node->name;
+    size_t arity = name == "store" || name == "select" ? 3 : 1;
+    if (node->args.size() != arity)
+    {
+        errorReporter.reportError("'" + name + "' expects " + to_string(arity) + " argument" +
+                                  (arity > 1 ? "s" : ""));
+        return;
+    }
+
+    auto vector = node->args[name == "select" ? 1 : 0]->type;
+    if (vector->kind != TypeKind::VECTOR)
+    {
+        if (vector->kind != TypeKind::ERROR)
+            errorReporter.reportError("'" + name + "' requires a vector");
+        return;
+    }
+    auto vectorType = static_pointer_cast<VectorType>(vector);
+
+    if (name == "store")
+    {
+        auto array = node->args[1]->type;
+        if (array->kind != TypeKind::ARRAY ||
+            !static_pointer_cast<ArrayType>(array)->elementType->equals(vectorType->elementType.get()) ||
+            node->args[2]->type->kind != TypeKind::INT)
+        {
+            errorReporter.reportError("'store' requires an array of " + vectorType->elementType->toString() +
+                                      " and an int index");
+            return;
+        }
+        checkWritableArray(node->args[1].get());
+        node->type = VoidType;
+    }
+    else if (name == "select")
+    {
+        if (!node->args[2]->type->equals(vector.get()) || !node->args[0]->type->equals(vectorType->maskType().get()))
+        {
+            errorReporter.reportError("'select' requires a " + vectorType->maskType()->toString() + " mask and two " +
+                                      vector->toString() + " values");
+            return;
+        }
+        node->type = vector;
+    }
+    else
+    {
+        node->type = vectorType->elementType;
+    }
+}
+
+void SemanticAnalyzer::visitVectorExpression(VectorExpression *node)
+{
+    for (auto &arg : node->args)
+    {
+        arg->accept(this);
+    }
+
+    auto vector = static_pointer_cast<VectorType>(node->type);
+    auto element = vector->elementType;
+    string name = vector->toString();
+    if (node->args.size() == 2 && node->args[0]->type->kind == TypeKind::ARRAY)
+    {
+        auto array = node->args[0]->type;
+        if (!static_pointer_cast<ArrayType>(array)->elementType->equals(element.get()) ||
+            node->args[1]->type->kind != TypeKind::INT)
+        {
+            errorReporter.reportError("'" + name + "' loads from an array of " + element->toString() +
+                                      " at an int index");
+        }
+        return;
+    }
+
+    if (node->args.size() != 1 && node->args.size() != static_cast<size_t>(vector->lanes))
+    {
+        errorReporter.reportError("'" + name + "' takes one value, " + to_string(vector->lanes) +
+                                  " values, or an array and an index");
+        return;
+    }
+    for (auto &arg : node->args)
+    {
+        if (!isAssignable(element, arg->type))
+        {
+            errorReporter.reportError("'" + name + "' lanes must be " + element->toString());
+            return;
+        }
+    }
+}
+
+void SemanticAnalyzer::checkNoaliasArguments(FunctionCall *node, const Function *callee)
+{
+    for (size_t i = 0; i < node->args.size(); ++i)
+    {
+        auto array = dynamic_cast<Variable *>(node->args[i].get());
+        if (!array || !callee->parameters[i].noalias)
+            continue;
+        for (size_t j = 0; j < node->args.size(); ++j)
+        {
+            auto other = dynamic_cast<Variable *>(node->args[j].get());
+            if (j != i && other && other->name == array->name)
+            {
+                errorReporter.reportError("Array '" + array->name + "' is passed to '" + node->name +
+                                          "' twice, but parameter '" + callee->parameters[i].name + "' is noalias");
+                return;
+            }
+        }
+    }
+}
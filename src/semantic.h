@@ -1,6 +1,8 @@
 #ifndef SEMANTIC_H
 #define SEMANTIC_H
 
+#include <map>
+#include <set>
 #include "ast.h"
 #include "symbol_table.h"
 
@@ -11,6 +13,15 @@ class SemanticAnalyzer : public ASTVisitor
 private:
     SymbolTable symbolTable;
     shared_ptr<Type> currentFunctionReturnType;
+    bool fastMath;
+    shared_ptr<Scope> globalScope;
+    shared_ptr<Scope> parallelScope;
+    map<string, Function *> functions;
+    string currentFunction;
+    map<string, set<string>> globalWrites;
+    set<string> parallelCallees;
+    set<shared_ptr<Symbol>> readOnlyArrays;
+    string parallelReduction;
 
     shared_ptr<Type> checkBinaryOp(const string &op,
                                         shared_ptr<Type> left,
@@ -19,9 +30,24 @@ private:
                                        shared_ptr<Type> operand);
     bool isNumericType(shared_ptr<Type> type);
     bool isAssignable(shared_ptr<Type> target, shared_ptr<Type> value);
+    bool isScalarType(shared_ptr<Type> type);
+    shared_ptr<Type> checkVectorOp(const string &op, shared_ptr<Type> left, shared_ptr<Type> right);
+    void checkLaneAssignment(Expression *target);
+    void checkFunctionAnnotations(Function *node);
+    void checkLoopAnnotations(ForStatement *node);
+    void checkParallelLoop(ForStatement *node);
+    void checkParallelCallees();
+    void recordGlobalWrite(Expression *target);
+    void checkChannelBuiltin(FunctionCall *node);
+    void checkAtomicBuiltin(FunctionCall *node);
+    void checkVectorBuiltin(FunctionCall *node);
+    void checkInputBuiltin(FunctionCall *node);
+    void checkMapBuiltin(FunctionCall *node, VarDeclaration *declaration);
+    void checkWritableArray(Expression *array);
+    void checkNoaliasArguments(FunctionCall *node, const Function *callee);
 
 public:
-    SemanticAnalyzer();
+    SemanticAnalyzer(bool fastMath = false);
 
     void analyze(shared_ptr<Program> program);
 
@@ -45,6 +71,10 @@ public:
     void visitBinaryOp(BinaryOp *node) override;
     void visitUnaryOp(UnaryOp *node) override;
     void visitFunctionCall(FunctionCall *node) override;
+    void visitSpawnExpression(SpawnExpression *node) override;
+    void visitAwaitExpression(AwaitExpression *node) override;
+    void visitChannelExpression(ChannelExpression *node) override;
+    void visitVectorExpression(VectorExpression *node) override;
 };
 
 #endif 
\ No newline at end of file
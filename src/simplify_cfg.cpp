@@ -0,0 +1,272 @@
+#include "simplify_cfg.h"
+#include <algorithm>
+#include "cfg.h"
+
+using namespace std;
+
+static void removeOneIncoming(Instruction *phi, BasicBlock *pred)
+{
+    for (size_t i = 0; i < phi->blocks.size(); ++i)
+    {
+        if (phi->blocks[i] == pred)
+        {
+            phi->removeOperand(i);
+            phi->blocks.erase(phi->blocks.begin() + i);
+            return;
+        }
+    }
+}
+
+static void removeOnePred(BasicBlock *block, BasicBlock *pred)
+{
+    auto it = find(block->preds.begin(), block->preds.end(), pred);
+    if (it != block->preds.end())
+    {
+        block->preds.erase(it);
+    }
+    for (auto phi : block->phis())
+    {
+        removeOneIncoming(phi, pred);
+    }
+}
+
+void replaceWithBranch(BasicBlock *block, BasicBlock *target)
+{
+    Instruction *term = block->terminator();
+    bool kept = false;
+    for (auto succ : term->blocks)
+    {
+        if (succ == target && !kept)
+        {
+            kept = true;
+            continue;
+        }
+        removeOnePred(succ, block);
+    }
+
+    block->erase(term);
+    Instruction *br = block->append(Opcode::BR, VoidType);
+    br->blocks.push_back(target);
+    if (!kept)
+    {
+        target->preds.push_back(block);
+    }
+}
+
+bool removeUnreachableBlocks(IRFunction &function)
+{
+    unordered_set<BasicBlock *> reachable = reachableBlocks(function);
+    vector<BasicBlock *> dead;
+    for (auto &block : function.blocks)
+    {
+        if (!reachable.count(block.get()))
+            dead.push_back(block.get());
+    }
+
+    // Drop edges between dead blocks first so removing one never visits another that is already gone.
+    for (auto block : dead)
+    {
+        for (auto &instr : block->instructions)
+        {
+            if (!instr->isTerminator())
+                continue;
+            auto &targets = instr->blocks;
+            targets.erase(remove_if(targets.begin(), targets.end(),
+                                    [&](BasicBlock *target) { return !reachable.count(target); }),
+                          targets.end());
+        }
+    }
+    for (auto block : dead)
+    {
+        function.removeBlock(block);
+    }
+    if (!dead.empty())
+    {
+        function.recomputePredecessors();
+    }
+    return !dead.empty();
+}
+
+bool removeTrivialPhis(IRFunction &function)
+{
+    bool changed = false;
+    bool progress = true;
+    while (progress)
+    {
+        progress = false;
+        for (auto &block : function.blocks)
+        {
+            for (auto phi : block->phis())
+            {
+                Instruction *same = nullptr;
+                bool trivial = true;
+                for (auto operand : phi->operands)
+                {
+                    if (operand == same || operand == phi)
+                        continue;
+                    if (same)
+                    {
+                        trivial = false;
+                        break;
+                    }
+                    same = operand;
+                }
+                if (!trivial)
+                    continue;
+
+                phi->replaceAllUsesWith(same ? same : function.zeroValue(phi->type));
+                block->erase(phi);
+                progress = changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+bool SimplifyCFG::foldConstantBranch(BasicBlock *block)
+{
+    Instruction *term = block->terminator();
+    if (!term || term->op != Opcode::CONDBR)
+        return false;
+
+    if (term->blocks[0] == term->blocks[1])
+    {
+        replaceWithBranch(block, term->blocks[0]);
+        return true;
+    }
+
+    Instruction *cond = term->operands[0];
+    if (!cond->isConstant())
+        return false;
+
+    replaceWithBranch(block, cond->intValue ? term->blocks[0] : term->blocks[1]);
+    return true;
+}
+
+bool SimplifyCFG::mergeIntoPredecessor(IRFunction &function, BasicBlock *block)
+{
+    if (block == function.entry() || block->preds.size() != 1)
+        return false;
+
+    BasicBlock *pred = block->preds[0];
+    Instruction *predTerm = pred->terminator();
+    if (pred == block || predTerm->op != Opcode::BR)
+        return false;
+
+    for (auto phi : block->phis())
+    {
+        phi->replaceAllUsesWith(phi->operands[0]);
+        block->erase(phi);
+    }
+
+    pred->erase(predTerm);
+    while (!block->instructions.empty())
+    {
+        Instruction *instr = block->instructions.front().get();
+        pred->insertBefore(nullptr, block->detach(instr));
+    }
+
+    for (auto succ : pred->successors())
+    {
+        replace(succ->preds.begin(), succ->preds.end(), block, pred);
+        for (auto phi : succ->phis())
+        {
+            replace(phi->blocks.begin(), phi->blocks.end(), block, pred);
+        }
+    }
+
+    block->preds.clear();
+    function.removeBlock(block);
+    return true;
+}
+
+bool SimplifyCFG::forwardEmptyBlock(IRFunction &function, BasicBlock *block)
+{
+    if (block == function.entry() || block->instructions.size() != 1)
+        return false;
+
+    Instruction *term = block->terminator();
+    if (term->op != Opcode::BR || term->blocks[0] == block)
+        return false;
+
+    BasicBlock *target = term->blocks[0];
+    vector<Instruction *> targetPhis = target->phis();
+
+    for (auto pred : block->preds)
+    {
+        if (find(target->preds.begin(), target->preds.end(), pred) == target->preds.end())
+            continue;
+        for (auto phi : targetPhis)
+        {
+            if (phi->incomingFor(pred) != phi->incomingFor(block))
+                return false;
+        }
+    }
+
+    vector<BasicBlock *> preds = block->preds;
+    for (auto pred : preds)
+    {
+        bool alreadyPred = find(target->preds.begin(), target->preds.end(), pred) != target->preds.end();
+        pred->replaceSuccessor(block, target);
+        target->preds.push_back(pred);
+        if (!alreadyPred)
+        {
+            for (auto phi : targetPhis)
+            {
+                phi->addIncoming(phi->incomingFor(block), pred);
+            }
+        }
+        else
+        {
+            for (auto phi : targetPhis)
+            {
+                phi->addIncoming(phi->incomingFor(pred), pred);
+            }
+        }
+    }
+
+    removeOnePred(target, block);
+    block->preds.clear();
+    function.removeBlock(block);
+    return true;
+}
+
+bool SimplifyCFG::runOnFunction(IRFunction &function)
+{
+    function.recomputePredecessors();
+    bool changed = removeUnreachableBlocks(function);
+
+    bool progress = true;
+    while (progress)
+    {
+        progress = false;
+
+        vector<BasicBlock *> order = reversePostOrder(function);
+        for (auto block : order)
+        {
+            progress = foldConstantBranch(block) || progress;
+        }
+        if (progress)
+        {
+            removeUnreachableBlocks(function);
+        }
+
+        order = reversePostOrder(function);
+        unordered_set<BasicBlock *> removed;
+        for (auto block : order)
+        {
+            if (removed.count(block))
+                continue;
+            if (mergeIntoPredecessor(function, block) || forwardEmptyBlock(function, block))
+            {
+                removed.insert(block);
+                progress = true;
+            }
+        }
+
+        progress = removeTrivialPhis(function) || progress;
+        changed = changed || progress;
+    }
+
+    return changed;
+}
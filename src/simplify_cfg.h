@@ -0,0 +1,24 @@
+#ifndef SIMPLIFY_CFG_H
+#define SIMPLIFY_CFG_H
+
+#include "pass_manager.h"
+
+using namespace std;
+
+class SimplifyCFG : public FunctionPass
+{
+private:
+    bool foldConstantBranch(BasicBlock *block);
+    bool mergeIntoPredecessor(IRFunction &function, BasicBlock *block);
+    bool forwardEmptyBlock(IRFunction &function, BasicBlock *block);
+
+public:
+    string name() const override { return "simplify-cfg"; }
+    bool runOnFunction(IRFunction &function) override;
+};
+
+bool removeUnreachableBlocks(IRFunction &function);
+bool removeTrivialPhis(IRFunction &function);
+void replaceWithBranch(BasicBlock *block, BasicBlock *target);
+
+#endif
@@ -0,0 +1,355 @@
+#include "spawn_runtime.h"
+
+using namespace std;
+
+const char *const spawnRuntimeSource = R"(#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define NOVA_TASK_WORKERS 64
+#define NOVA_DEQUE_SIZE 1024
+
+typedef struct nova_job nova_job;
+typedef nova_job *nova_handle;
+
+struct nova_job
+{
+    void (*run)(nova_job *job);
+    atomic_int done;
+    atomic_int owners;
+    nova_job *next;
+    union
+    {
+        int i;
+        float f;
+        char *s;
+        void *p;
+    } result;
+};
+
+typedef struct
+{
+    atomic_long top;
+    atomic_long bottom;
+    _Atomic(nova_job *) slots[NOVA_DEQUE_SIZE];
+} nova_deque;
+
+static struct
+{
+    atomic_int workers;
+    atomic_long pending;
+    atomic_int sleepers;
+    unsigned epoch;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    nova_deque deques[NOVA_TASK_WORKERS];
+} nova_tasks = {0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+static __thread int nova_task_worker = -1;
+static __thread int nova_task_depth;
+
+static int nova_deque_push(nova_deque *deque, nova_job *job)
+{
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top >= NOVA_DEQUE_SIZE)
+        return 0;
+    atomic_store_explicit(&deque->slots[bottom % NOVA_DEQUE_SIZE], job, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+    return 1;
+}
+
+static nova_job *nova_deque_pop(nova_deque *deque)
+{
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    if (top > bottom)
+    {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    nova_job *job = atomic_load_explicit(&deque->slots[bottom % NOVA_DEQUE_SIZE], memory_order_relaxed);
+    if (top == bottom)
+    {
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst,
+                                                     memory_order_relaxed))
+            job = NULL;
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+static nova_job *nova_deque_steal(nova_deque *deque)
+{
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom)
+        return NULL;
+
+    nova_job *job = atomic_load_explicit(&deque->slots[top % NOVA_DEQUE_SIZE], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed))
+        return NULL;
+    return job;
+}
+
+static int nova_task_workers(void)
+{
+    return atomic_load_explicit(&nova_tasks.workers, memory_order_relaxed);
+}
+
+static nova_job *nova_find_job(int self)
+{
+    int workers = nova_task_workers();
+    nova_job *job = nova_deque_pop(&nova_tasks.deques[self]);
+    for (int i = 1; !job && i < workers; ++i)
+        job = nova_deque_steal(&nova_tasks.deques[(self + i) % workers]);
+    return job;
+}
+
+// A job is owned by the scheduler until it has run and by its handle until the handle's last await, and is
+// freed by whichever lets go last.
+static void nova_job_release(nova_job *job)
+{
+    if (atomic_fetch_sub_explicit(&job->owners, 1, memory_order_acq_rel) == 1)
+        free(job);
+}
+
+static void nova_run(nova_job *job)
+{
+    nova_task_depth++;
+    job->run(job);
+    nova_task_depth--;
+    atomic_fetch_sub(&nova_tasks.pending, 1);
+    atomic_store_explicit(&job->done, 1, memory_order_release);
+    nova_job_release(job);
+}
+
+static void *nova_task_main(void *arg)
+{
+    int self = (int)(long)arg;
+    nova_task_worker = self;
+    for (;;)
+    {
+        nova_job *job = nova_find_job(self);
+        for (int spin = 0; !job && spin < 64; ++spin)
+        {
+            sched_yield();
+            job = nova_find_job(self);
+        }
+        if (!job)
+        {
+            pthread_mutex_lock(&nova_tasks.lock);
+            unsigned epoch = nova_tasks.epoch;
+            atomic_fetch_add(&nova_tasks.sleepers, 1);
+            pthread_mutex_unlock(&nova_tasks.lock);
+
+            job = nova_find_job(self);
+            pthread_mutex_lock(&nova_tasks.lock);
+            while (!job && nova_tasks.epoch == epoch)
+                pthread_cond_wait(&nova_tasks.wake, &nova_tasks.lock);
+            pthread_mutex_unlock(&nova_tasks.lock);
+            atomic_fetch_sub(&nova_tasks.sleepers, 1);
+        }
+        if (job)
+            nova_run(job);
+    }
+    return NULL;
+}
+
+static void nova_tasks_start(void)
+{
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *requested = getenv("NOVA_THREADS");
+    if (requested && atoi(requested) > 0)
+        workers = atoi(requested);
+    workers = workers < 1 ? 1 : workers > NOVA_TASK_WORKERS ? NOVA_TASK_WORKERS : workers;
+    atomic_store_explicit(&nova_tasks.workers, (int)workers, memory_order_relaxed);
+
+    // A worker that fails to start just leaves its deque empty.
+    for (int i = 1; i < workers; ++i)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, nova_task_main, (void *)(long)i) == 0)
+            pthread_detach(thread);
+    }
+}
+
+static void nova_wake(void)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&nova_tasks.sleepers, memory_order_relaxed) == 0)
+        return;
+    pthread_mutex_lock(&nova_tasks.lock);
+    nova_tasks.epoch++;
+    pthread_cond_signal(&nova_tasks.wake);
+    pthread_mutex_unlock(&nova_tasks.lock);
+}
+
+// Called by a scheduler thread that stays blocked (on a channel) while no worker is idle: if tasks are
+// still queued, they may be the ones it waits for, so another worker is started to run them.
+static void nova_tasks_compensate(void)
+{
+    int workers = nova_task_workers();
+    if (nova_task_worker < 0 || workers == 0 || atomic_load(&nova_tasks.sleepers) > 0)
+        return;
+    int queued = 0;
+    for (int i = 0; !queued && i < workers; ++i)
+        queued = atomic_load(&nova_tasks.deques[i].bottom) > atomic_load(&nova_tasks.deques[i].top);
+    if (!queued)
+        return;
+
+    pthread_mutex_lock(&nova_tasks.lock);
+    workers = nova_task_workers();
+    pthread_t thread;
+    if (workers < NOVA_TASK_WORKERS && pthread_create(&thread, NULL, nova_task_main, (void *)(long)workers) == 0)
+    {
+        pthread_detach(thread);
+        atomic_store_explicit(&nova_tasks.workers, workers + 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&nova_tasks.lock);
+}
+
+static void *nova_job_alloc(size_t size)
+{
+    void *job = malloc(size);
+    if (!job)
+    {
+        fprintf(stderr, "Runtime error: out of memory\n");
+        exit(1);
+    }
+    return job;
+}
+
+// Threads outside the scheduler (such as `parallel for` workers) run their tasks immediately.
+static nova_job *nova_spawn(nova_job *job)
+{
+    int self = nova_task_worker;
+    atomic_init(&job->done, 0);
+    atomic_init(&job->owners, 2);
+    atomic_fetch_add(&nova_tasks.pending, 1);
+    if (self == 0 && nova_task_workers() == 0)
+        nova_tasks_start();
+    if (self < 0 || !nova_deque_push(&nova_tasks.deques[self], job))
+        nova_run(job);
+    else
+        nova_wake();
+    return job;
+}
+
+// Instead of blocking, a waiting thread runs other queued tasks until the job completes.
+static void nova_wait(nova_job *job)
+{
+    int self = nova_task_worker;
+    while (!atomic_load_explicit(&job->done, memory_order_acquire))
+    {
+        nova_job *other = self >= 0 ? nova_find_job(self) : NULL;
+        if (other)
+            nova_run(other);
+        else
+            sched_yield();
+    }
+}
+
+// A task given a local array or atomic points into its caller's frame, so the frame keeps the job on a list and
+// joins all of them before it returns or unmaps an array.
+static nova_job *nova_job_borrow(nova_job **borrowed, nova_job *job)
+{
+    atomic_fetch_add_explicit(&job->owners, 1, memory_order_relaxed);
+    job->next = *borrowed;
+    *borrowed = job;
+    return job;
+}
+
+static void nova_job_join(nova_job **borrowed)
+{
+    while (*borrowed)
+    {
+        nova_job *job = *borrowed;
+        *borrowed = job->next;
+        nova_wait(job);
+        nova_job_release(job);
+    }
+}
+
+// A handle can be awaited any number of times. The compiler passes release only to an await that is known to
+// be the handle's last.
+static int nova_await_int(nova_job *job, int release)
+{
+    if (!job)
+        return 0;
+    nova_wait(job);
+    int result = job->result.i;
+    if (release)
+        nova_job_release(job);
+    return result;
+}
+
+static float nova_await_float(nova_job *job, int release)
+{
+    if (!job)
+        return 0.0f;
+    nova_wait(job);
+    float result = job->result.f;
+    if (release)
+        nova_job_release(job);
+    return result;
+}
+
+static char *nova_await_string(nova_job *job, int release)
+{
+    if (!job)
+        return NULL;
+    nova_wait(job);
+    char *result = job->result.s;
+    if (release)
+        nova_job_release(job);
+    return result;
+}
+
+static void *nova_await_ptr(nova_job *job, int release)
+{
+    if (!job)
+        return NULL;
+    nova_wait(job);
+    void *result = job->result.p;
+    if (release)
+        nova_job_release(job);
+    return result;
+}
+
+static void nova_await_void(nova_job *job, int release)
+{
+    if (!job)
+        return;
+    nova_wait(job);
+    if (release)
+        nova_job_release(job);
+}
+
+// Tasks that are never awaited still run before the program exits normally.
+static void nova_tasks_finish(void)
+{
+    if (nova_task_worker != 0 || nova_task_depth > 0)
+        return;
+    while (atomic_load(&nova_tasks.pending) > 0)
+    {
+        nova_job *job = nova_task_workers() > 0 ? nova_find_job(0) : NULL;
+        if (job)
+            nova_run(job);
+        else
+            sched_yield();
+    }
+}
+
+__attribute__((constructor)) static void nova_tasks_init(void)
+{
+    nova_task_worker = 0;
+    atexit(nova_tasks_finish);
+}
+)";
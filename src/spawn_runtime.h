@@ -0,0 +1,9 @@
+#ifndef SPAWN_RUNTIME_H
+#define SPAWN_RUNTIME_H
+
+using namespace std;
+
+// C source of the task scheduler behind `spawn` and `await`, emitted into programs that use tasks.
+extern const char *const spawnRuntimeSource;
+
+#endif
@@ -0,0 +1,263 @@
+#include "specialization.h"
+#include <cstring>
+#include "cloning.h"
+#include "inliner.h"
+
+using namespace std;
+
+static const pair<int, long long> NOT_CONSTANT(-1, 0);
+
+static bool isScalarConstant(const Instruction *value)
+{
+    if (!value->isConstant())
+        return false;
+    TypeKind kind = value->type->kind;
+    return kind == TypeKind::INT || kind == TypeKind::FLOAT || kind == TypeKind::BOOL;
+}
+
+static pair<int, long long> constantKey(const Instruction *constant)
+{
+    if (constant->type->kind != TypeKind::FLOAT)
+        return {static_cast<int>(constant->type->kind), constant->intValue};
+
+    uint32_t bits;
+    memcpy(&bits, &constant->floatValue, sizeof(bits));
+    return {static_cast<int>(TypeKind::FLOAT), bits};
+}
+
+static bool canSpecialize(const IRFunction *function)
+{
+    return function && !function->isMain() && !function->memoize;
+}
+
+void FunctionSpecialization::collectCallSites(IRModule &module)
+{
+    sites.clear();
+    for (auto &function : module.functions)
+    {
+        for (auto &block : function->blocks)
+        {
+            for (auto &instr : block->instructions)
+            {
+                if (instr->op != Opcode::CALL)
+                    continue;
+                if (IRFunction *callee = module.getFunction(instr->text))
+                    sites[callee].push_back(instr.get());
+            }
+        }
+    }
+}
+
+bool FunctionSpecialization::propagateArguments(IRFunction *function)
+{
+    const vector<Instruction *> &calls = sites[function];
+    if (calls.empty())
+        return false;
+
+    // The runtime invokes parallel loop bodies with its own sub-ranges and partial accumulators, so
+    // those arguments are never constant.
+    size_t perTask = 0;
+    for (auto call : calls)
+    {
+        if (call->parallel)
+            perTask = function->reduction.empty() ? 2 : 3;
+    }
+
+    int propagated = 0;
+    for (size_t i = 0; i < function->params.size(); ++i)
+    {
+        Instruction *param = function->params[i].get();
+        Instruction *first = calls[0]->operands[i];
+        if (param->users.empty() || !isScalarConstant(first) || i < perTask)
+            continue;
+
+        bool same = true;
+        for (auto call : calls)
+        {
+            Instruction *arg = call->operands[i];
+            same = same && isScalarConstant(arg) && constantKey(arg) == constantKey(first);
+        }
+        if (!same)
+            continue;
+
+        param->replaceAllUsesWith(mapConstant(*function, first));
+        ++propagated;
+    }
+
+    if (propagated > 0)
+        statistics.push_back("specialize: " + function->name + ": " + to_string(propagated) +
+                             " constant argument" + (propagated == 1 ? "" : "s") + " propagated");
+    return propagated > 0;
+}
+
+bool FunctionSpecialization::propagateReturn(IRFunction *function)
+{
+    if (function->returnType->kind == TypeKind::VOID)
+        return false;
+
+    Instruction *result = nullptr;
+    for (auto &block : function->blocks)
+    {
+        Instruction *term = block->terminator();
+        if (!term || term->op != Opcode::RET)
+            continue;
+        Instruction *value = term->operands[0];
+        if (!isScalarConstant(value) || (result && constantKey(value) != constantKey(result)))
+            return false;
+        result = value;
+    }
+    if (!result)
+        return false;
+
+    bool changed = false;
+    for (auto call : sites[function])
+    {
+        if (call->users.empty() || call->spawn)
+            continue;
+        call->replaceAllUsesWith(mapConstant(*call->function, result));
+        changed = true;
+    }
+    return changed;
+}
+
+bool FunctionSpecialization::signatureFor(const Instruction *call, IRFunction *callee, ConstantSignature &signature)
+{
+    bool useful = false;
+    signature.clear();
+    for (size_t i = 0; i < call->operands.size(); ++i)
+    {
+        Instruction *arg = call->operands[i];
+        if (isScalarConstant(arg) && !callee->params[i]->users.empty())
+        {
+            signature.push_back(constantKey(arg));
+            useful = true;
+        }
+        else
+        {
+            signature.push_back(NOT_CONSTANT);
+        }
+    }
+    return useful;
+}
+
+IRFunction *FunctionSpecialization::cloneFor(IRModule &module, IRFunction *callee, const Instruction *call,
+                                             const ConstantSignature &signature)
+{
+    string name;
+    int suffix = 1;
+    do
+    {
+        name = callee->name + "__spec" + to_string(suffix++);
+    } while (module.getFunction(name));
+
+    IRFunction *clone = module.createFunction(name, callee->returnType);
+    clone->annotations = callee->annotations;
+
+    ValueMap values;
+    BlockMap blockMap;
+    for (size_t i = 0; i < callee->params.size(); ++i)
+    {
+        Instruction *param = callee->params[i].get();
+        if (signature[i] != NOT_CONSTANT)
+            values[param] = mapConstant(*clone, call->operands[i]);
+        else
+        {
+            values[param] = clone->addParam(param->type, param->name);
+            values[param]->noalias = param->noalias;
+        }
+    }
+    cloneBlocks(*callee, *clone, values, blockMap);
+    clone->recomputePredecessors();
+    return clone;
+}
+
+void FunctionSpecialization::redirect(Instruction *call, IRFunction *clone, const ConstantSignature &signature)
+{
+    for (size_t i = signature.size(); i-- > 0;)
+    {
+        if (signature[i] != NOT_CONSTANT)
+            call->removeOperand(i);
+    }
+    call->text = clone->name;
+}
+
+bool FunctionSpecialization::runOnModule(IRModule &module)
+{
+    clones.clear();
+    statistics.clear();
+    bool changed = false;
+
+    collectCallSites(module);
+    for (auto &function : module.functions)
+    {
+        if (!canSpecialize(function.get()))
+            continue;
+        changed = propagateArguments(function.get()) || changed;
+        changed = propagateReturn(function.get()) || changed;
+    }
+
+    vector<Instruction *> worklist;
+    for (auto &function : module.functions)
+    {
+        for (auto &block : function->blocks)
+        {
+            for (auto &instr : block->instructions)
+            {
+                if (instr->op == Opcode::CALL)
+                    worklist.push_back(instr.get());
+            }
+        }
+    }
+
+    int remaining = budget;
+    map<string, int> cloneCounts;
+    for (size_t next = 0; next < worklist.size(); ++next)
+    {
+        Instruction *call = worklist[next];
+        IRFunction *callee = module.getFunction(call->text);
+        ConstantSignature signature;
+        if (call->parallel || !canSpecialize(callee) || !signatureFor(call, callee, signature))
+            continue;
+
+        auto key = make_pair(callee, signature);
+        auto existing = clones.find(key);
+        IRFunction *clone = existing != clones.end() ? existing->second : nullptr;
+        if (!clone)
+        {
+            int cost = functionSize(*callee);
+            if (cost > remaining)
+                continue;
+            remaining -= cost;
+
+            clone = cloneFor(module, callee, call, signature);
+            clones[key] = clone;
+            ++cloneCounts[callee->name];
+            for (auto &block : clone->blocks)
+            {
+                for (auto &instr : block->instructions)
+                {
+                    if (instr->op == Opcode::CALL)
+                        worklist.push_back(instr.get());
+                }
+            }
+        }
+
+        redirect(call, clone, signature);
+        changed = true;
+    }
+
+    for (auto &entry : cloneCounts)
+    {
+        statistics.push_back("specialize: " + entry.first + ": " + to_string(entry.second) +
+                             " specialized clone" + (entry.second == 1 ? "" : "s"));
+    }
+    return changed;
+}
+
+void FunctionSpecialization::printStatistics(ostream &out) const
+{
+    for (auto &line : statistics)
+    {
+        out << line << endl;
+    }
+}
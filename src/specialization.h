@@ -0,0 +1,36 @@
+#ifndef SPECIALIZATION_H
+#define SPECIALIZATION_H
+
+#include <map>
+#include <unordered_map>
+#include "pass_manager.h"
+
+using namespace std;
+
+typedef vector<pair<int, long long>> ConstantSignature;
+
+class FunctionSpecialization : public Pass
+{
+private:
+    int budget;
+    map<pair<IRFunction *, ConstantSignature>, IRFunction *> clones;
+    unordered_map<IRFunction *, vector<Instruction *>> sites;
+    vector<string> statistics;
+
+    void collectCallSites(IRModule &module);
+    bool propagateArguments(IRFunction *function);
+    bool propagateReturn(IRFunction *function);
+    bool signatureFor(const Instruction *call, IRFunction *callee, ConstantSignature &signature);
+    IRFunction *cloneFor(IRModule &module, IRFunction *callee, const Instruction *call,
+                         const ConstantSignature &signature);
+    void redirect(Instruction *call, IRFunction *clone, const ConstantSignature &signature);
+
+public:
+    FunctionSpecialization(int budget) : budget(budget) {}
+
+    string name() const override { return "specialize"; }
+    bool runOnModule(IRModule &module) override;
+    void printStatistics(ostream &out) const override;
+};
+
+#endif
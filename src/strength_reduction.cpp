@@ -0,0 +1,80 @@
+#include "strength_reduction.h"
+#include <algorithm>
+#include "constant_folding.h"
+
+using namespace std;
+
+Instruction *StrengthReduction::stepFor(BasicBlock *preheader, const InductionVariable &variable,
+                                        Instruction *factor)
+{
+    IRFunction &function = *preheader->parent;
+    Instruction *step = function.constInt(variable.step);
+    if (Instruction *folded = foldConstant(function, Opcode::MUL, IntType, {step, factor}))
+        return folded;
+    if (factor->isConstant())
+        return nullptr;
+    if (variable.step == 1)
+        return factor;
+    return preheader->insertBefore(preheader->terminator(), Opcode::MUL, IntType, {step, factor});
+}
+
+bool StrengthReduction::reduce(IRFunction &function, Loop *loop)
+{
+    InductionAnalysis analysis(loop);
+    BasicBlock *preheader = loop->preheader();
+    if (analysis.inductionVariables().empty())
+        return false;
+
+    bool changed = false;
+    for (auto &variable : analysis.inductionVariables())
+    {
+        vector<Instruction *> products;
+        for (auto user : variable.phi->users)
+        {
+            if (user->op == Opcode::MUL && loop->contains(user) &&
+                find(products.begin(), products.end(), user) == products.end())
+                products.push_back(user);
+        }
+
+        for (auto product : products)
+        {
+            Instruction *factor = product->operands[0] == variable.phi ? product->operands[1] : product->operands[0];
+            if (factor == variable.phi || !loop->isInvariant(factor))
+                continue;
+
+            Instruction *step = stepFor(preheader, variable, factor);
+            if (!step)
+                continue;
+
+            Instruction *init = foldConstant(function, Opcode::MUL, IntType, {variable.start, factor});
+            if (variable.start->isConstant() && variable.start->intValue == 0)
+                init = function.constInt(0);
+            if (!init)
+                init = preheader->insertBefore(preheader->terminator(), Opcode::MUL, IntType, {variable.start, factor});
+
+            BasicBlock *latch = loop->latches[0];
+            Instruction *phi = loop->header->addPhi(IntType);
+            Instruction *next = latch->insertBefore(latch->terminator(), Opcode::ADD, IntType, {phi, step});
+            phi->addIncoming(init, preheader);
+            phi->addIncoming(next, latch);
+
+            product->replaceAllUsesWith(phi);
+            product->parent->erase(product);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool StrengthReduction::runOnFunction(IRFunction &function)
+{
+    bool changed = insertPreheaders(function);
+
+    DominatorTree dominators(function);
+    LoopInfo loops(dominators);
+    for (auto loop : loops.innermostFirst())
+    {
+        changed = reduce(function, loop) || changed;
+    }
+    return changed;
+}
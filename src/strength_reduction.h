@@ -0,0 +1,20 @@
+#ifndef STRENGTH_REDUCTION_H
+#define STRENGTH_REDUCTION_H
+
+#include "induction.h"
+#include "pass_manager.h"
+
+using namespace std;
+
+class StrengthReduction : public FunctionPass
+{
+private:
+    Instruction *stepFor(BasicBlock *preheader, const InductionVariable &variable, Instruction *factor);
+    bool reduce(IRFunction &function, Loop *loop);
+
+public:
+    string name() const override { return "strength-reduce"; }
+    bool runOnFunction(IRFunction &function) override;
+};
+
+#endif
@@ -63,4 +63,16 @@ bool SymbolTable::isDefinedInCurrentScope(const string &name)
 {
     auto it = currentScope->symbols.find(name);
     return it != currentScope->symbols.end();
-}
\ No newline at end of file
+}
+
+bool SymbolTable::isDefinedWithin(const string &name, shared_ptr<Scope> scope)
+{
+    for (auto s = currentScope; s; s = s->parent)
+    {
+        if (s->symbols.count(name))
+            return true;
+        if (s == scope)
+            return false;
+    }
+    return false;
+}
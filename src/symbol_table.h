@@ -47,6 +47,8 @@ public:
     shared_ptr<Symbol> resolve(const string &name);
     bool isDefined(const string &name);
     bool isDefinedInCurrentScope(const string &name);
+    bool isDefinedWithin(const string &name, shared_ptr<Scope> scope);
+    shared_ptr<Scope> current() const { return currentScope; }
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "tail_recursion.h"
+#include "simplify_cfg.h"
+
+using namespace std;
+
+bool TailRecursionElimination::findSite(IRFunction &function, BasicBlock *block, TailSite &site)
+{
+    Instruction *ret = block->terminator();
+    if (!ret || ret->op != Opcode::RET)
+        return false;
+
+    Instruction *call = nullptr;
+    for (auto it = next(block->instructions.rbegin()); it != block->instructions.rend(); ++it)
+    {
+        Instruction *instr = it->get();
+        if (instr->op == Opcode::CALL && !instr->spawn && instr->text == function.name)
+        {
+            call = instr;
+            break;
+        }
+        if (instr->mayTrap() || instr->readsMemory() || instr->op == Opcode::PHI)
+            return false;
+    }
+    if (!call)
+        return false;
+
+    for (auto arg : call->operands)
+    {
+        if (arg->op == Opcode::ARRAY)
+            return false;
+    }
+
+    site = {block, call, nullptr};
+    if (ret->operands.empty())
+        return call->users.empty();
+
+    Instruction *value = ret->operands[0];
+    if (value == call)
+        return call->users.size() == 1;
+
+    if ((value->op != Opcode::ADD && value->op != Opcode::MUL) || value->type->kind != TypeKind::INT)
+        return false;
+    if (call->users.size() != 1 || call->users[0] != value || value->users.size() != 1)
+        return false;
+
+    site.accumulate = value;
+    return true;
+}
+
+bool TailRecursionElimination::runOnFunction(IRFunction &function)
+{
+    if (function.isMain() || function.memoize)
+        return false;
+
+    vector<TailSite> sites;
+    vector<Instruction *> returns;
+    Opcode accumulateOp = Opcode::ADD;
+    bool accumulating = false;
+
+    for (auto &block : function.blocks)
+    {
+        TailSite site;
+        if (findSite(function, block.get(), site))
+        {
+            if (site.accumulate)
+            {
+                if (accumulating && site.accumulate->op != accumulateOp)
+                    return false;
+                accumulateOp = site.accumulate->op;
+                accumulating = true;
+            }
+            sites.push_back(site);
+        }
+        else if (block->terminator() && block->terminator()->op == Opcode::RET)
+        {
+            returns.push_back(block->terminator());
+        }
+    }
+
+    if (sites.empty())
+        return false;
+
+    BasicBlock *header = function.entry();
+    BasicBlock *start = function.createBlock();
+    function.blocks.splice(function.blocks.begin(), function.blocks, prev(function.blocks.end()));
+
+    vector<Instruction *> arrays;
+    for (auto &instr : header->instructions)
+    {
+        if (instr->op == Opcode::ARRAY)
+            arrays.push_back(instr.get());
+    }
+    for (auto array : arrays)
+    {
+        start->insertBefore(nullptr, header->detach(array));
+    }
+    start->append(Opcode::BR, VoidType)->blocks.push_back(header);
+
+    vector<Instruction *> paramPhis;
+    for (auto &param : function.params)
+    {
+        Instruction *phi = header->addPhi(param->type);
+        phi->name = param->name;
+        param->replaceAllUsesWith(phi);
+        phi->addIncoming(param.get(), start);
+        paramPhis.push_back(phi);
+    }
+
+    Instruction *acc = nullptr;
+    if (accumulating)
+    {
+        acc = header->addPhi(IntType);
+        acc->name = "acc";
+        acc->addIncoming(function.constInt(accumulateOp == Opcode::MUL ? 1 : 0), start);
+
+        for (auto ret : returns)
+        {
+            if (ret->operands.empty())
+                continue;
+            Instruction *result = ret->parent->insertBefore(ret, accumulateOp, IntType, {acc, ret->operands[0]});
+            ret->setOperand(0, result);
+        }
+    }
+
+    for (auto &site : sites)
+    {
+        Instruction *ret = site.block->terminator();
+        for (size_t i = 0; i < paramPhis.size(); ++i)
+        {
+            paramPhis[i]->addIncoming(site.call->operands[i], site.block);
+        }
+        if (acc)
+        {
+            Instruction *next = acc;
+            if (site.accumulate)
+            {
+                Instruction *operand = site.accumulate->operands[site.accumulate->operands[0] == site.call ? 1 : 0];
+                next = site.block->insertBefore(ret, accumulateOp, IntType, {acc, operand});
+            }
+            acc->addIncoming(next, site.block);
+        }
+
+        site.block->erase(ret);
+        if (site.accumulate)
+            site.block->erase(site.accumulate);
+        site.block->erase(site.call);
+        site.block->append(Opcode::BR, VoidType)->blocks.push_back(header);
+    }
+
+    function.recomputePredecessors();
+    removeTrivialPhis(function);
+    return true;
+}
@@ -0,0 +1,25 @@
+#ifndef TAIL_RECURSION_H
+#define TAIL_RECURSION_H
+
+#include "pass_manager.h"
+
+using namespace std;
+
+struct TailSite
+{
+    BasicBlock *block;
+    Instruction *call;
+    Instruction *accumulate;
+};
+
+class TailRecursionElimination : public FunctionPass
+{
+private:
+    bool findSite(IRFunction &function, BasicBlock *block, TailSite &site);
+
+public:
+    string name() const override { return "tail-recursion"; }
+    bool runOnFunction(IRFunction &function) override;
+};
+
+#endif
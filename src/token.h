@@ -27,6 +27,14 @@ enum TokenType {
     TOKEN_ELSE,
     TOKEN_WHILE,
     TOKEN_FOR,
+    TOKEN_PARALLEL,
+    TOKEN_SPAWN,
+    TOKEN_AWAIT,
+    TOKEN_TASK,
+    TOKEN_CHANNEL,
+    TOKEN_ATOMIC,
+    TOKEN_VECTOR,
+    TOKEN_NOALIAS,
     TOKEN_PRINT,
     TOKEN_VOID,
     
@@ -56,7 +64,8 @@ enum TokenType {
     TOKEN_RBRACKET,
     TOKEN_SEMICOLON,
     TOKEN_COMMA,
-    TOKEN_DOT
+    TOKEN_DOT,
+    TOKEN_AT
 };
 
 struct Token {
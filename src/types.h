@@ -16,6 +16,10 @@ enum class TypeKind
     VOID,
     ARRAY,
     FUNCTION,
+    TASK,
+    CHANNEL,
+    ATOMIC,
+    VECTOR,
     ERROR
 };
 
@@ -124,6 +128,94 @@ public:
     }
 };
 
+// Handle to a spawned call; awaiting it yields a value of resultType.
+class TaskType : public Type
+{
+public:
+    shared_ptr<Type> resultType;
+
+    TaskType(shared_ptr<Type> resultType) : Type(TypeKind::TASK), resultType(resultType) {}
+
+    string toString() const override
+    {
+        return "task<" + resultType->toString() + ">";
+    }
+
+    bool equals(const Type *other) const override
+    {
+        return other && other->kind == TypeKind::TASK &&
+               resultType->equals(static_cast<const TaskType *>(other)->resultType.get());
+    }
+};
+
+// Handle to a bounded queue of elementType values shared between tasks.
+class ChannelType : public Type
+{
+public:
+    shared_ptr<Type> elementType;
+
+    ChannelType(shared_ptr<Type> elementType) : Type(TypeKind::CHANNEL), elementType(elementType) {}
+
+    string toString() const override
+    {
+        return "channel<" + elementType->toString() + ">";
+    }
+
+    bool equals(const Type *other) const override
+    {
+        return other && other->kind == TypeKind::CHANNEL &&
+               elementType->equals(static_cast<const ChannelType *>(other)->elementType.get());
+    }
+};
+
+// A shared cell updated only through atomic operations; variables of this type refer to the cell.
+class AtomicType : public Type
+{
+public:
+    shared_ptr<Type> valueType;
+
+    AtomicType(shared_ptr<Type> valueType) : Type(TypeKind::ATOMIC), valueType(valueType) {}
+
+    string toString() const override
+    {
+        return "atomic " + valueType->toString();
+    }
+
+    bool equals(const Type *other) const override
+    {
+        return other && other->kind == TypeKind::ATOMIC &&
+               valueType->equals(static_cast<const AtomicType *>(other)->valueType.get());
+    }
+};
+
+// A fixed number of int or float lanes operated on element-wise, such as vec4f.
+class VectorType : public Type
+{
+public:
+    shared_ptr<Type> elementType;
+    int lanes;
+
+    VectorType(shared_ptr<Type> elementType, int lanes)
+        : Type(TypeKind::VECTOR), elementType(elementType), lanes(lanes) {}
+
+    string toString() const override
+    {
+        return "vec" + to_string(lanes) + (elementType->kind == TypeKind::FLOAT ? "f" : "i");
+    }
+
+    bool equals(const Type *other) const override
+    {
+        return other && other->kind == TypeKind::VECTOR && lanes == static_cast<const VectorType *>(other)->lanes &&
+               elementType->equals(static_cast<const VectorType *>(other)->elementType.get());
+    }
+
+    // Comparisons produce an int vector with -1 in the lanes where they hold and 0 elsewhere.
+    shared_ptr<Type> maskType() const
+    {
+        return make_shared<VectorType>(make_shared<PrimitiveType>(TypeKind::INT), lanes);
+    }
+};
+
 extern shared_ptr<Type> IntType;
 extern shared_ptr<Type> FloatType;
 extern shared_ptr<Type> StringType;
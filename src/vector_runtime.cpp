@@ -0,0 +1,112 @@
+#include "vector_runtime.h"
+
+using namespace std;
+
+// Loads and stores go through memcpy because they may start at any element, not just at a multiple of the
+// lane count. Horizontal reductions combine lanes in order, so float results do not depend on the target's
+// shuffles. The helpers are static inline, so GCC's notes about the vector calling convention do not apply to
+// them.
+const char *const vectorRuntimeSource = R"(#pragma GCC diagnostic ignored "-Wpsabi"
+
+typedef float vec4f __attribute__((vector_size(16)));
+typedef float vec8f __attribute__((vector_size(32)));
+typedef int vec4i __attribute__((vector_size(16)));
+typedef int vec8i __attribute__((vector_size(32)));
+
+#define NOVA_VECTOR(V, T, N, M)                                         \
+    static inline V nova_splat_##V(T x)                                 \
+    {                                                                   \
+        V v;                                                            \
+        for (int i = 0; i < N; ++i)                                     \
+            v[i] = x;                                                   \
+        return v;                                                       \
+    }                                                                   \
+    static inline V nova_load_##V(const T *p)                           \
+    {                                                                   \
+        V v;                                                            \
+        memcpy(&v, p, sizeof(v));                                       \
+        return v;                                                       \
+    }                                                                   \
+    static inline void nova_store_##V(T *p, V v)                        \
+    {                                                                   \
+        memcpy(p, &v, sizeof(v));                                       \
+    }                                                                   \
+    static inline T nova_hsum_##V(V v)                                  \
+    {                                                                   \
+        T result = v[0];                                                \
+        for (int i = 1; i < N; ++i)                                     \
+            result += v[i];                                             \
+        return result;                                                  \
+    }                                                                   \
+    static inline T nova_hmin_##V(V v)                                  \
+    {                                                                   \
+        T result = v[0];                                                \
+        for (int i = 1; i < N; ++i)                                     \
+            result = v[i] < result ? v[i] : result;                     \
+        return result;                                                  \
+    }                                                                   \
+    static inline T nova_hmax_##V(V v)                                  \
+    {                                                                   \
+        T result = v[0];                                                \
+        for (int i = 1; i < N; ++i)                                     \
+            result = v[i] > result ? v[i] : result;                     \
+        return result;                                                  \
+    }                                                                   \
+    static inline V nova_select_##V(M mask, V a, V b)                   \
+    {                                                                   \
+        return (V)(((M)a & mask) | ((M)b & ~mask));                     \
+    }
+
+static inline int nova_vector_check(int index, int size, int lanes)
+{
+    if (index < 0 || index > size - lanes)
+    {
+        fprintf(stderr, "Runtime error: %d-lane access at index %d out of bounds for size %d\n", lanes, index, size);
+        exit(1);
+    }
+    return index;
+}
+
+NOVA_VECTOR(vec4f, float, 4, vec4i)
+NOVA_VECTOR(vec8f, float, 8, vec8i)
+NOVA_VECTOR(vec4i, int, 4, vec4i)
+NOVA_VECTOR(vec8i, int, 8, vec8i)
+)";
+
+shared_ptr<Type> vectorType(const string &name)
+{
+    if (name == "vec4f" || name == "vec8f")
+        return make_shared<VectorType>(FloatType, name[3] - '0');
+    if (name == "vec4i" || name == "vec8i")
+        return make_shared<VectorType>(IntType, name[3] - '0');
+    return nullptr;
+}
+
+bool isVectorBuiltin(const string &name)
+{
+    return name == "store" || name == "hsum" || name == "hmin" || name == "hmax" || name == "select";
+}
+
+string vectorCall(const string &name, const vector<string> &args, const shared_ptr<Type> &vector)
+{
+    string type = vector->toString();
+    if (name == "nova_lane")
+        return args[0] + "[" + args[1] + "]";
+    if (name == "store")
+        return "nova_store_" + type + "(&" + args[1] + "[" + args[2] + "], " + args[0] + ")";
+    if (name == "select")
+        return "nova_select_" + type + "(" + args[0] + ", " + args[1] + ", " + args[2] + ")";
+    if (name != type)
+        return "nova_" + name + "_" + type + "(" + args[0] + ")";
+
+    if (args.size() == 1)
+        return "nova_splat_" + type + "(" + args[0] + ")";
+    if (args.size() == 2)
+        return "nova_load_" + type + "(&" + args[0] + "[" + args[1] + "])";
+    string lanes;
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        lanes += (i > 0 ? ", " : "") + args[i];
+    }
+    return "(" + type + "){" + lanes + "}";
+}
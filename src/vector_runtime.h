@@ -0,0 +1,24 @@
+#ifndef VECTOR_RUNTIME_H
+#define VECTOR_RUNTIME_H
+
+#include <string>
+#include <vector>
+#include "types.h"
+
+using namespace std;
+
+// C source of the GCC vector typedefs and helpers, emitted into programs that use vector types.
+extern const char *const vectorRuntimeSource;
+
+// The type named vec4f, vec8f, vec4i or vec8i, or null for any other name.
+shared_ptr<Type> vectorType(const string &name);
+
+// store, hsum, hmin, hmax and select.
+bool isVectorBuiltin(const string &name);
+
+// C expression for the vector operation `name` on the C expressions `args`. Besides the builtins, `name`
+// is a vector type for construction (one value to splat, one per lane, or an array and index to load)
+// or "nova_lane" to read one lane. `vector` is the type of the vector involved.
+string vectorCall(const string &name, const vector<string> &args, const shared_ptr<Type> &vector);
+
+#endif